@@ -8,14 +8,159 @@ static const char *tag = "data_storage";
 
 static sqlite3 *db = NULL;
 char* fp_table = "flightPlan";
+static int storage_sync = 0;    ///< Current transaction is synced at commit
+
+/**
+ * Prepared statements. Each table has its own set of statements, prepared the
+ * first time they are used (or when the table is created) and then reused
+ * with reset, bind and step. Values are always bound as parameters.
+ */
+typedef enum storage_stmt_e {
+    STORAGE_STMT_GET_IDX = 0,   ///< Value by index
+    STORAGE_STMT_GET_STR,       ///< Value by name
+    STORAGE_STMT_GET_ALL,       ///< All the values below an index
+    STORAGE_STMT_UPDATE_IDX,    ///< Update a value by index
+    STORAGE_STMT_INSERT_IDX,    ///< Insert a new value by index
+    STORAGE_STMT_UPDATE_STR,    ///< Update a value by name
+    STORAGE_STMT_INSERT_STR,    ///< Insert a new value by name
+    STORAGE_STMT_FP_SET,        ///< Insert or replace a flight plan entry
+    STORAGE_STMT_FP_GET,        ///< Flight plan entry by time
+    STORAGE_STMT_FP_ERASE,      ///< Delete a flight plan entry by time
+    STORAGE_STMT_FP_NEXT,       ///< First flight plan entry after a time
+    STORAGE_STMT_LAST
+} storage_stmt_t;
+
+static const char *storage_stmt_sql[STORAGE_STMT_LAST] = {
+    "SELECT value FROM %s WHERE idx=?1;",
+    "SELECT value FROM %s WHERE name=?1;",
+    "SELECT idx, value FROM %s WHERE idx>=0 AND idx<?1;",
+    "UPDATE %s SET value=?2 WHERE idx=?1;",
+    "INSERT INTO %s (idx, value) VALUES (?1, ?2);",
+    "UPDATE %s SET value=?2 WHERE name=?1;",
+    "INSERT INTO %s (name, value) VALUES (?1, ?2);",
+    "INSERT OR REPLACE INTO %s (time, command, args, executions, periodical) VALUES (?1, ?2, ?3, ?4, ?5);",
+    "SELECT command, args, executions, periodical FROM %s WHERE time=?1;",
+    "DELETE FROM %s WHERE time=?1;",
+    "SELECT MIN(time) FROM %s WHERE time>=?1;"
+};
+
+#define STORAGE_MAX_TABLES 4    ///< Max. number of tables with prepared statements
+#define STORAGE_TABLE_LEN 32    ///< Max. length of a table name
+
+typedef struct storage_stmt_cache_s {
+    char table[STORAGE_TABLE_LEN];          ///< Table name, empty if unused
+    sqlite3_stmt *stmt[STORAGE_STMT_LAST];  ///< Statements, NULL if not prepared
+} storage_stmt_cache_t;
+
+static storage_stmt_cache_t storage_stmts[STORAGE_MAX_TABLES];
+
+/**
+ * Returns the prepared statement @kind for @table, ready to bind the
+ * parameters. Prepares the statement if it is the first time it is used.
+ *
+ * @return sqlite3_stmt *. The statement or NULL in case of errors
+ */
+static sqlite3_stmt *storage_get_stmt(storage_stmt_t kind, const char *table)
+{
+    storage_stmt_cache_t *cache = NULL;
+    int i;
 
-static int dummy_callback(void *data, int argc, char **argv, char **names);
+    for(i=0; i<STORAGE_MAX_TABLES; i++)
+    {
+        if(strcmp(storage_stmts[i].table, table) == 0)
+        {
+            cache = &storage_stmts[i];
+            break;
+        }
+        if(cache == NULL && storage_stmts[i].table[0] == '\0')
+            cache = &storage_stmts[i];
+    }
+
+    if(cache == NULL || strlen(table) >= STORAGE_TABLE_LEN)
+    {
+        LOGE(tag, "No room to prepare statements of table %s", table);
+        return NULL;
+    }
+
+    if(cache->stmt[kind] == NULL)
+    {
+        char *sql = sqlite3_mprintf(storage_stmt_sql[kind], table);
+        int rc = sqlite3_prepare_v2(db, sql, -1, &cache->stmt[kind], 0);
+        sqlite3_free(sql);
+        if(rc != SQLITE_OK)
+        {
+            LOGE(tag, "Failed to prepare statement %d of table %s (rc=%d): %s", kind, table, rc, sqlite3_errmsg(db));
+            cache->stmt[kind] = NULL;
+            return NULL;
+        }
+        strcpy(cache->table, table);
+    }
+
+    return cache->stmt[kind];
+}
+
+/**
+ * Finalizes the prepared statements of @table, or all of them if @table is
+ * NULL. Must be called before closing the database.
+ */
+static void storage_finalize_stmts(const char *table)
+{
+    int i, j;
+    for(i=0; i<STORAGE_MAX_TABLES; i++)
+    {
+        if(storage_stmts[i].table[0] == '\0')
+            continue;
+        if(table != NULL && strcmp(storage_stmts[i].table, table) != 0)
+            continue;
+
+        for(j=0; j<STORAGE_STMT_LAST; j++)
+        {
+            sqlite3_finalize(storage_stmts[i].stmt[j]);
+            storage_stmts[i].stmt[j] = NULL;
+        }
+        storage_stmts[i].table[0] = '\0';
+    }
+}
+
+/**
+ * Resets the prepared statements of @table, so none of them is active when
+ * the table is dropped. They are prepared again by SQLite on the next step.
+ */
+static void storage_reset_stmts(const char *table)
+{
+    int i, j;
+    for(i=0; i<STORAGE_MAX_TABLES; i++)
+    {
+        if(strcmp(storage_stmts[i].table, table) != 0)
+            continue;
+
+        for(j=0; j<STORAGE_STMT_LAST; j++)
+        {
+            if(storage_stmts[i].stmt[j] != NULL)
+                sqlite3_reset(storage_stmts[i].stmt[j]);
+        }
+    }
+}
+
+/**
+ * Runs a statement that does not return rows (insert, update, delete) and
+ * resets it
+ *
+ * @return Int. SQLITE_DONE if OK, or the SQLite error code
+ */
+static int storage_step_done(sqlite3_stmt *stmt)
+{
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    return rc;
+}
 
 int storage_init(const char *file)
 {
     if(db != NULL)
     {
         LOGW(tag, "Database already open, closing it");
+        storage_finalize_stmts(NULL);
         sqlite3_close(db);
     }
 
@@ -28,6 +173,14 @@ int storage_init(const char *file)
     else
     {
         LOGD(tag, "Opened database successfully");
+        // Write ahead log, commits only sync the log when requested
+        // (storage_transaction_begin) or when it is checkpointed
+        char *err_msg;
+        if(sqlite3_exec(db, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL;", 0, 0, &err_msg) != SQLITE_OK)
+        {
+            LOGW(tag, "Unable to set the write ahead log: %s", err_msg);
+            sqlite3_free(err_msg);
+        }
         return 0;
     }
 }
@@ -41,6 +194,7 @@ int storage_table_repo_init(char* table, int drop)
     /* Drop table if selected */
     if(drop)
     {
+        storage_reset_stmts(table);
         sql = sqlite3_mprintf("DROP TABLE %s", table);
         rc = sqlite3_exec(db, sql, 0, 0, &err_msg);
 
@@ -77,6 +231,11 @@ int storage_table_repo_init(char* table, int drop)
     {
         LOGD(tag, "Table %s created successfully", table);
         sqlite3_free(sql);
+        // Prepare the statements of the table at once
+        storage_get_stmt(STORAGE_STMT_GET_IDX, table);
+        storage_get_stmt(STORAGE_STMT_GET_ALL, table);
+        storage_get_stmt(STORAGE_STMT_UPDATE_IDX, table);
+        storage_get_stmt(STORAGE_STMT_INSERT_IDX, table);
         return 0;
     }
 }
@@ -91,6 +250,7 @@ int storage_table_flight_plan_init(int drop)
     /* Drop table if selected */
     if (drop)
     {
+        storage_reset_stmts(fp_table);
         sql = sqlite3_mprintf("DROP TABLE IF EXISTS %s", fp_table);
         rc = sqlite3_exec(db, sql, 0, 0, &err_msg);
 
@@ -128,207 +288,306 @@ int storage_table_flight_plan_init(int drop)
     {
         LOGD(tag, "Table %s created successfully", fp_table);
         sqlite3_free(sql);
+        // Prepare the statements of the table at once
+        storage_get_stmt(STORAGE_STMT_FP_SET, fp_table);
+        storage_get_stmt(STORAGE_STMT_FP_GET, fp_table);
+        storage_get_stmt(STORAGE_STMT_FP_ERASE, fp_table);
+        storage_get_stmt(STORAGE_STMT_FP_NEXT, fp_table);
         return 0;
     }
 }
 
-int storage_repo_get_value_idx(int index, char *table)
+/**
+ * Reads an INT value with a prepared SELECT statement, its first parameter
+ * must be already bound
+ */
+static int storage_get_value(sqlite3_stmt *stmt)
 {
-    sqlite3_stmt* stmt = NULL;
-    char *sql = sqlite3_mprintf("SELECT value FROM %s WHERE idx=\"%d\";", table, index);
-
-    // execute statement
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, 0);
-    if(rc != SQLITE_OK)
-    {
-        LOGE(tag, "Selecting data from DB Failed (rc=%d)", rc);
-        return -1;
-    }
-
     // fetch only one row's status
-    rc = sqlite3_step(stmt);
+    int rc = sqlite3_step(stmt);
     int value = -1;
     if(rc == SQLITE_ROW)
         value = sqlite3_column_int(stmt, 0);
     else
         LOGE(tag, "Some error encountered (rc=%d)", rc);
 
-    sqlite3_finalize(stmt);
-    sqlite3_free(sql);
+    sqlite3_reset(stmt);
     return value;
 }
 
-int storage_repo_get_value_str(char *name, char *table)
+int storage_repo_get_value_idx(int index, char *table)
 {
-    sqlite3_stmt* stmt = NULL;
-    char *sql = sqlite3_mprintf("SELECT value FROM %s WHERE name=\"%s\";", table, name);
+    sqlite3_stmt* stmt = storage_get_stmt(STORAGE_STMT_GET_IDX, table);
+    if(stmt == NULL)
+    {
+        LOGE(tag, "Selecting data from DB Failed");
+        return -1;
+    }
 
-    // execute statement
-    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, 0);
-    if(rc != 0)
+    sqlite3_bind_int(stmt, 1, index);
+    return storage_get_value(stmt);
+}
+
+int storage_repo_get_values(int *values, int n, char *table)
+{
+    int i;
+    int rc;
+    int count = 0;
+
+    for(i=0; i<n; i++)
+        values[i] = -1;
+
+    sqlite3_stmt* stmt = storage_get_stmt(STORAGE_STMT_GET_ALL, table);
+    if(stmt == NULL)
     {
-        LOGE(tag, "Selecting data from DB Failed (rc=%d)", rc);
+        LOGE(tag, "Selecting data from DB Failed");
         return -1;
     }
 
-    // fetch only one row's status
-    rc = sqlite3_step(stmt);
-    int value = -1;
-    if(rc == SQLITE_ROW)
-        value = sqlite3_column_int(stmt, 0);
-    else
+    // One row per index
+    sqlite3_bind_int(stmt, 1, n);
+    while((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+    {
+        values[sqlite3_column_int(stmt, 0)] = sqlite3_column_int(stmt, 1);
+        count++;
+    }
+    sqlite3_reset(stmt);
+
+    if(rc != SQLITE_DONE)
+    {
         LOGE(tag, "Some error encountered (rc=%d)", rc);
+        return -1;
+    }
+    return count;
+}
 
-    sqlite3_finalize(stmt);
-    sqlite3_free(sql);
-    return value;
+int storage_repo_get_value_str(char *name, char *table)
+{
+    sqlite3_stmt* stmt = storage_get_stmt(STORAGE_STMT_GET_STR, table);
+    if(stmt == NULL)
+    {
+        LOGE(tag, "Selecting data from DB Failed");
+        return -1;
+    }
+
+    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+    return storage_get_value(stmt);
 }
 
 int storage_repo_set_value_idx(int index, int value, char *table)
 {
-    char *err_msg;
-    char *sql = sqlite3_mprintf("INSERT OR REPLACE INTO %s (idx, name, value) "
-                                        "VALUES ("
-                                        "%d, "
-                                        "(SELECT name FROM %s WHERE idx = \"%d\"), "
-                                        "%d);",
-                                table, index, table, index, value);
+    // Update the existing row, insert it only the first time
+    sqlite3_stmt *stmt = storage_get_stmt(STORAGE_STMT_UPDATE_IDX, table);
+    int rc = SQLITE_ERROR;
+    if(stmt != NULL)
+    {
+        sqlite3_bind_int(stmt, 1, index);
+        sqlite3_bind_int(stmt, 2, value);
+        rc = storage_step_done(stmt);
+    }
 
-    /* Execute SQL statement */
-    int rc = sqlite3_exec(db, sql, dummy_callback, 0, &err_msg);
+    if(rc == SQLITE_DONE && sqlite3_changes(db) == 0)
+    {
+        stmt = storage_get_stmt(STORAGE_STMT_INSERT_IDX, table);
+        rc = SQLITE_ERROR;
+        if(stmt != NULL)
+        {
+            sqlite3_bind_int(stmt, 1, index);
+            sqlite3_bind_int(stmt, 2, value);
+            rc = storage_step_done(stmt);
+        }
+    }
 
-    if( rc != SQLITE_OK )
+    if(rc != SQLITE_DONE)
     {
-        LOGE(tag, "SQL error: %s", err_msg);
-        sqlite3_free(err_msg);
-        sqlite3_free(sql);
+        LOGE(tag, "SQL error: %s", sqlite3_errmsg(db));
         return -1;
     }
     else
     {
         LOGV(tag, "Inserted %d to %d in %s", value, index, table);
-        sqlite3_free(err_msg);
-        sqlite3_free(sql);
         return 0;
     }
 }
 
 int storage_repo_set_value_str(char *name, int value, char *table)
 {
-    char *err_msg;
-    char *sql = sqlite3_mprintf("INSERT OR REPLACE INTO %s (idx, name, value) "
-                                        "VALUES ("
-                                            "(SELECT idx FROM %s WHERE name = \"%s\"), "
-                                            "%s, "
-                                            "%d);",
-                                table, table, name, name, value);
+    // Update the existing row, insert it only the first time
+    sqlite3_stmt *stmt = storage_get_stmt(STORAGE_STMT_UPDATE_STR, table);
+    int rc = SQLITE_ERROR;
+    if(stmt != NULL)
+    {
+        sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+        sqlite3_bind_int(stmt, 2, value);
+        rc = storage_step_done(stmt);
+    }
 
-    /* Execute SQL statement */
-    int rc = sqlite3_exec(db, sql, dummy_callback, 0, &err_msg);
+    if(rc == SQLITE_DONE && sqlite3_changes(db) == 0)
+    {
+        stmt = storage_get_stmt(STORAGE_STMT_INSERT_STR, table);
+        rc = SQLITE_ERROR;
+        if(stmt != NULL)
+        {
+            sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+            sqlite3_bind_int(stmt, 2, value);
+            rc = storage_step_done(stmt);
+        }
+    }
 
-    if( rc != SQLITE_OK )
+    if(rc != SQLITE_DONE)
     {
-        LOGE(tag, "SQL error: %s", err_msg);
-        sqlite3_free(err_msg);
-        sqlite3_free(sql);
+        LOGE(tag, "SQL error: %s", sqlite3_errmsg(db));
         return -1;
     }
     else
     {
         LOGV(tag, "Inserted %d to %s in %s", value, name, table);
-        sqlite3_free(err_msg);
-        sqlite3_free(sql);
         return 0;
     }
 }
 
-int storage_flight_plan_set(int timetodo, char* command, char* args, int executions, int periodical)
+int storage_transaction_begin(int sync)
 {
     char *err_msg;
-    char *sql = sqlite3_mprintf(
-            "INSERT OR REPLACE INTO %s (time, command, args, executions, periodical)\n VALUES (%d, \"%s\", \"%s\", %d, %d);",
-            fp_table, timetodo, command, args, executions, periodical);
+    int rc;
 
-    /* Execute SQL statement */
-    int rc = sqlite3_exec(db, sql, dummy_callback, 0, &err_msg);
+    // The synchronous setting can only change outside transactions
+    storage_sync = sync;
+    if(storage_sync)
+        sqlite3_exec(db, "PRAGMA synchronous=FULL;", 0, 0, NULL);
 
-    if (rc != SQLITE_OK)
+    rc = sqlite3_exec(db, "BEGIN;", 0, 0, &err_msg);
+    if(rc != SQLITE_OK)
     {
-        LOGE(tag, "SQL error: %s", err_msg);
+        LOGE(tag, "Failed to begin transaction. Error: %s", err_msg);
         sqlite3_free(err_msg);
-        sqlite3_free(sql);
+        return -1;
+    }
+    return 0;
+}
+
+int storage_transaction_commit(void)
+{
+    char *err_msg;
+    int rc = sqlite3_exec(db, "COMMIT;", 0, 0, &err_msg);
+    if(storage_sync)
+    {
+        sqlite3_exec(db, "PRAGMA synchronous=NORMAL;", 0, 0, NULL);
+        storage_sync = 0;
+    }
+
+    if(rc != SQLITE_OK)
+    {
+        LOGE(tag, "Failed to commit transaction. Error: %s", err_msg);
+        sqlite3_free(err_msg);
+        return -1;
+    }
+    return 0;
+}
+
+int storage_flight_plan_set(int timetodo, char* command, char* args, int executions, int periodical)
+{
+    sqlite3_stmt *stmt = storage_get_stmt(STORAGE_STMT_FP_SET, fp_table);
+    if(stmt == NULL)
+        return -1;
+
+    sqlite3_bind_int(stmt, 1, timetodo);
+    sqlite3_bind_text(stmt, 2, command, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, args, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 4, executions);
+    sqlite3_bind_int(stmt, 5, periodical);
+
+    /* Execute SQL statement */
+    int rc = storage_step_done(stmt);
+
+    if (rc != SQLITE_DONE)
+    {
+        LOGE(tag, "SQL error: %s", sqlite3_errmsg(db));
         return -1;
     }
     else
     {
         LOGV(tag, "Inserted (%d, %s, %s, %d, %d) in %s", timetodo, command, args, executions, periodical, fp_table);
-        sqlite3_free(err_msg);
-        sqlite3_free(sql);
         return 0;
     }
 }
 
 int storage_flight_plan_get(int timetodo, char* command, char* args, int* executions, int* periodical)
 {
-    char **results;
-    char *err_msg;
-    int row;
-    int col;
-
-    char* sql = sqlite3_mprintf("SELECT * FROM %s WHERE time = %d", fp_table, timetodo);
+    sqlite3_stmt *stmt = storage_get_stmt(STORAGE_STMT_FP_GET, fp_table);
+    if(stmt == NULL)
+        return -1;
 
-    sqlite3_get_table(db, sql, &results,&row,&col,&err_msg);
+    sqlite3_bind_int(stmt, 1, timetodo);
+    int rc = sqlite3_step(stmt);
 
-    if(row==0 || col==0)
+    if(rc != SQLITE_ROW)
     {
-        sqlite3_free(sql);
-        LOGV(tag, "SQL error: %s", err_msg);
-        sqlite3_free(err_msg);
-        sqlite3_free_table(results);
+        LOGV(tag, "SQL error: %s", rc == SQLITE_DONE ? "no rows" : sqlite3_errmsg(db));
+        sqlite3_reset(stmt);
         return -1;
     }
     else
     {
-        strcpy(command, results[6]);
-        strcpy(args,results[7]);
-        *executions = atoi(results[8]);
-        *periodical = atoi(results[9]);
+        // Copy the row before resetting the statement
+        strncpy(command, (const char *)sqlite3_column_text(stmt, 0), SCH_CMD_MAX_STR_PARAMS-1);
+        command[SCH_CMD_MAX_STR_PARAMS-1] = '\0';
+        strncpy(args, (const char *)sqlite3_column_text(stmt, 1), SCH_CMD_MAX_STR_PARAMS-1);
+        args[SCH_CMD_MAX_STR_PARAMS-1] = '\0';
+        *executions = sqlite3_column_int(stmt, 2);
+        *periodical = sqlite3_column_int(stmt, 3);
+        sqlite3_reset(stmt);
 
         storage_flight_plan_erase(timetodo);
 
-        if (atoi(results[9]) > 0)
-            storage_flight_plan_set(timetodo+*periodical,results[6],results[7],*executions,*periodical);
+        if (*periodical > 0)
+            storage_flight_plan_set(timetodo+*periodical, command, args, *executions, *periodical);
 
-        sqlite3_free(sql);
         return 0;
     }
 }
 
 int storage_flight_plan_erase(int timetodo)
 {
-
-    char *err_msg;
-    char *sql = sqlite3_mprintf("DELETE FROM %s\n WHERE time = %d", fp_table, timetodo);
+    sqlite3_stmt *stmt = storage_get_stmt(STORAGE_STMT_FP_ERASE, fp_table);
+    if(stmt == NULL)
+        return -1;
 
     /* Execute SQL statement */
-    int rc = sqlite3_exec(db, sql, dummy_callback, 0, &err_msg);
+    sqlite3_bind_int(stmt, 1, timetodo);
+    int rc = storage_step_done(stmt);
 
-    if (rc != SQLITE_OK)
+    if (rc != SQLITE_DONE)
     {
-        LOGE(tag, "SQL error: %s", err_msg);
-        sqlite3_free(err_msg);
-        sqlite3_free(sql);
+        LOGE(tag, "SQL error: %s", sqlite3_errmsg(db));
         return -1;
     }
     else
     {
         LOGV(tag, "Command in time %d, table %s was deleted", timetodo, fp_table);
-        sqlite3_free(err_msg);
-        sqlite3_free(sql);
         return 0;
     }
 }
 
+int storage_flight_plan_next(int from)
+{
+    sqlite3_stmt *stmt = storage_get_stmt(STORAGE_STMT_FP_NEXT, fp_table);
+    if(stmt == NULL)
+    {
+        LOGE(tag, "Selecting data from DB Failed");
+        return -1;
+    }
+
+    // MIN() returns one NULL row if there are no entries
+    int next = -1;
+    sqlite3_bind_int(stmt, 1, from);
+    if(sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL)
+        next = sqlite3_column_int(stmt, 0);
+
+    sqlite3_reset(stmt);
+    return next;
+}
+
 int storage_flight_plan_reset(void)
 {
     return storage_table_flight_plan_init(1);
@@ -374,6 +633,7 @@ int storage_close(void)
     if(db != NULL)
     {
         LOGD(tag, "Closing database");
+        storage_finalize_stmts(NULL);
         sqlite3_close(db);
         db = NULL;
         return 0;
@@ -384,8 +644,3 @@ int storage_close(void)
         return -1;
     }
 }
-
-static int dummy_callback(void *data, int argc, char **argv, char **names)
-{
-    return 0;
-}
@@ -54,10 +54,13 @@ CSRCS = \
        $(PROJ_ROOT)/util/init.c                           \
        $(PROJ_ROOT)/lowlevel/port.c                       \
        $(PROJ_ROOT)/os/FreeRTOS/osDelay.c                 \
+       $(PROJ_ROOT)/os/FreeRTOS/osEvent.c                 \
+       $(PROJ_ROOT)/os/FreeRTOS/osPool.c                  \
        $(PROJ_ROOT)/os/FreeRTOS/osQueue.c                 \
        $(PROJ_ROOT)/os/FreeRTOS/osScheduler.c             \
        $(PROJ_ROOT)/os/FreeRTOS/osSemphr.c                \
        $(PROJ_ROOT)/os/FreeRTOS/osThread.c                \
+       $(PROJ_ROOT)/os/FreeRTOS/osTimer.c                 \
        avr32/boards/uc3_a3_xplained/init.c                \
        avr32/boards/uc3_a3_xplained/led.c                 \
        avr32/drivers/flashc/flashc.c                      \
@@ -56,6 +56,16 @@ int storage_repo_get_value_idx(int index, char *table)
     return (int)(data.data32);
 }
 
+int storage_repo_get_values(int *values, int n, char *table)
+{
+    // Values are stored in consecutive addresses, read them in one burst
+    uint16_t len = (uint16_t)(n*sizeof(uint32_t));
+    fm33256b_read_data(0, (uint8_t *)values, len);
+
+    LOGV(tag, "Read %d values", n);
+    return n;
+}
+
 int storage_repo_get_value_str(char *name, char *table)
 {
     return 0;
@@ -79,6 +89,17 @@ int storage_repo_set_value_str(char *name, int value, char *table)
     return 0;
 }
 
+int storage_transaction_begin(int sync)
+{
+    // FRAM writes are not buffered, they are always synced
+    return 0;
+}
+
+int storage_transaction_commit(void)
+{
+    return 0;
+}
+
 int storage_flight_plan_set(int timetodo, char* command, char* args, int executions, int periodical)
 {
     return 0;
@@ -94,6 +115,11 @@ int storage_flight_plan_erase(int timetodo)
     return 0;
 }
 
+int storage_flight_plan_next(int from)
+{
+    return -1;
+}
+
 int storage_flight_plan_reset(void)
 {
     return 0;
@@ -143,14 +169,15 @@ int storage_set_payload_data(int index, void* data, int payload)
 
 int storage_add_payload_data(void* data, int payload)
 {
-    int index = dat_get_system_var(data_map[payload].sys_index);
+    // Reserve the index, so concurrent writers use different addresses
+    int index = dat_add_system_var(data_map[payload].sys_index, 1) - 1;
     LOGV(tag, "Adding data for payload %d in index %d", payload, index);
     int ret = storage_set_payload_data(index, data, payload);
-    // Update address
     if(ret==0) {
-        dat_set_system_var(data_map[payload].sys_index, index+1);
         return index+1;
     } else {
+        // Release the index if nobody else reserved the next one
+        dat_cas_system_var(data_map[payload].sys_index, index+1, index);
         return -1;
     }
 }
@@ -77,6 +77,19 @@ int storage_table_flight_plan_init(int drop);
  */
 int storage_repo_get_value_idx(int index, char *table);
 
+/**
+ * Get the INT (integer) values of the indexes 0 to @n - 1 from table at once.
+ * Missing values are set to -1.
+ *
+ * @note: non-reentrant function, use mutex to sync access
+ *
+ * @param values Int *. Destination array of @n values
+ * @param n Int. Number of values to read
+ * @param table Str. Table name
+ * @return Int. Number of values read, -1 Error
+ */
+int storage_repo_get_values(int *values, int n, char *table);
+
 /**
  * Get a INT (integer) value from table by name
  *
@@ -116,6 +129,29 @@ int storage_repo_set_value_idx(int index, int value, char *table);
  */
 int storage_repo_set_value_str(char *name, int value, char *table);
 
+/**
+ * Begin a transaction, the following writes are committed to the storage at
+ * once with storage_transaction_commit (one journal sync instead of one per
+ * write).
+ *
+ * @note: non-reentrant function, use mutex to sync access
+ *
+ * @param sync Int. 1 to sync the transaction to the storage device when it is
+ * committed, 0 to let the storage sync it later (survives a software crash
+ * but not a power failure)
+ * @return 0 OK, -1 Error
+ */
+int storage_transaction_begin(int sync);
+
+/**
+ * Commit the transaction started with storage_transaction_begin
+ *
+ * @note: non-reentrant function, use mutex to sync access
+ *
+ * @return 0 OK, -1 Error
+ */
+int storage_transaction_commit(void);
+
 /**
  * Set or update the row of a certain time
  *
@@ -156,6 +192,17 @@ int storage_flight_plan_get(int timetodo, char** command, char** args, int** rep
  */
 int storage_flight_plan_erase(int timetodo);
 
+/**
+ * Time of the first flight plan entry at or after @from
+ *
+ * @note: NOT IMPLEMENTED
+ * @note: non-reentrant function, use mutex to sync access
+ *
+ * @param from Int. Start time (unix time)
+ * @return Int. Time of the next entry, -1 if there are no entries
+ */
+int storage_flight_plan_next(int from);
+
 /**
  * Reset the table in the opened database (@relatesalso storage_init) in the
  * form (time, command, args, repeat).
@@ -10,10 +10,12 @@
  */
 
 #include "osDelay.h"
+#include "osThread.h"
 
 void osDelay(uint32_t mseconds){
     portTick ticks = mseconds/portTICK_RATE_MS;
     vTaskDelay(ticks);
+    osTaskStatsWakeup();
 }
 
 portTick osDefineTime(uint32_t mseconds){
@@ -26,5 +28,19 @@ portTick osTaskGetTickCount(void){
 
 void osTaskDelayUntil(portTick *lastTime, uint32_t mseconds){
     portTick ticks = osDefineTime(mseconds);
-	vTaskDelayUntil(lastTime, ticks);
+    portTick now = xTaskGetTickCount();
+
+    // Already late, vTaskDelayUntil returns without blocking
+    if((portTick)(now - *lastTime) >= ticks)
+    {
+        osTaskStatsOverrun();
+        vTaskDelayUntil(lastTime, ticks);
+        return;
+    }
+
+    vTaskDelayUntil(lastTime, ticks);
+
+    // Latency with tick resolution, since the end of the period
+    osTaskStatsWakeup();
+    osTaskStatsLatency((uint32_t)(xTaskGetTickCount() - *lastTime)*portTICK_RATE_MS*1000);
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+/**
+ * @file  FreeRTOS/osEvent.c
+ * @author Carlos Gonzalez Cortes
+ * @date 2018
+ * @copyright GNU Public License.
+ *
+ * Event flags for FreeRTOS, mapped to event groups in FreeRTOS 8 or later
+ * (include event_groups.c in the build). Older kernels keep the bits in a
+ * critical section and wake the waiting tasks with a counting semaphore.
+ */
+
+#include "osEvent.h"
+
+#if defined(tskKERNEL_VERSION_MAJOR) && tskKERNEL_VERSION_MAJOR >= 8
+#include "event_groups.h"
+
+osEvent osEventCreate(void)
+{
+    return (osEvent)xEventGroupCreate();
+}
+
+uint32_t osEventSet(osEvent event, uint32_t bits)
+{
+    return (uint32_t)xEventGroupSetBits((EventGroupHandle_t)event, bits & OS_EVENT_ALL_BITS);
+}
+
+uint32_t osEventClear(osEvent event, uint32_t bits)
+{
+    return (uint32_t)xEventGroupClearBits((EventGroupHandle_t)event, bits & OS_EVENT_ALL_BITS);
+}
+
+uint32_t osEventGet(osEvent event)
+{
+    return (uint32_t)xEventGroupGetBits((EventGroupHandle_t)event);
+}
+
+uint32_t osEventWait(osEvent event, uint32_t bits, int wait_all, int clear, uint32_t timeout)
+{
+    portTickType ticks = timeout == portMAX_DELAY ? portMAX_DELAY : timeout/portTICK_RATE_MS;
+    return (uint32_t)xEventGroupWaitBits((EventGroupHandle_t)event, bits & OS_EVENT_ALL_BITS,
+                                         clear ? pdTRUE : pdFALSE, wait_all ? pdTRUE : pdFALSE,
+                                         ticks);
+}
+
+#else
+
+#define OS_EVENT_MAX_WAITERS 16
+
+typedef struct os_event_s {
+    uint32_t bits;              ///< Event bits
+    int waiters;                ///< Tasks waiting in @wake
+    xSemaphoreHandle wake;      ///< Given once per waiter when bits are set
+} os_event_t;
+
+static int event_ready(os_event_t *e, uint32_t bits, int wait_all)
+{
+    return wait_all ? (e->bits & bits) == bits : (e->bits & bits) != 0;
+}
+
+osEvent osEventCreate(void)
+{
+    os_event_t *e = pvPortMalloc(sizeof(os_event_t));
+    if(e == NULL)
+        return NULL;
+
+    e->wake = xSemaphoreCreateCounting(OS_EVENT_MAX_WAITERS, 0);
+    if(e->wake == NULL)
+    {
+        vPortFree(e);
+        return NULL;
+    }
+    e->bits = 0;
+    e->waiters = 0;
+    return e;
+}
+
+uint32_t osEventSet(osEvent event, uint32_t bits)
+{
+    os_event_t *e = (os_event_t *)event;
+    uint32_t value;
+    int waiters;
+
+    taskENTER_CRITICAL();
+    e->bits |= bits & OS_EVENT_ALL_BITS;
+    value = e->bits;
+    waiters = e->waiters;
+    taskEXIT_CRITICAL();
+
+    // Waiters test their own condition, extra gives only cause a retry
+    while(waiters-- > 0)
+        xSemaphoreGive(e->wake);
+    return value;
+}
+
+uint32_t osEventClear(osEvent event, uint32_t bits)
+{
+    os_event_t *e = (os_event_t *)event;
+    uint32_t value;
+
+    taskENTER_CRITICAL();
+    value = e->bits;
+    e->bits &= ~bits;
+    taskEXIT_CRITICAL();
+    return value;
+}
+
+uint32_t osEventGet(osEvent event)
+{
+    return ((os_event_t *)event)->bits;
+}
+
+uint32_t osEventWait(osEvent event, uint32_t bits, int wait_all, int clear, uint32_t timeout)
+{
+    os_event_t *e = (os_event_t *)event;
+    portTickType ticks = timeout == portMAX_DELAY ? portMAX_DELAY : timeout/portTICK_RATE_MS;
+    portTickType start = xTaskGetTickCount();
+    portTickType left = ticks;
+    uint32_t value;
+
+    taskENTER_CRITICAL();
+    while(!event_ready(e, bits, wait_all) && left != 0)
+    {
+        e->waiters++;
+        taskEXIT_CRITICAL();
+        xSemaphoreTake(e->wake, left);
+        taskENTER_CRITICAL();
+        e->waiters--;
+
+        if(ticks != portMAX_DELAY)
+        {
+            portTickType elapsed = xTaskGetTickCount() - start;
+            left = elapsed < ticks ? ticks - elapsed : 0;
+        }
+    }
+
+    value = e->bits;
+    if(clear && event_ready(e, bits, wait_all))
+        e->bits &= ~bits;
+    taskEXIT_CRITICAL();
+    return value;
+}
+
+#endif
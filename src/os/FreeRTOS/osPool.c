@@ -0,0 +1,129 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "osPool.h"
+
+/**
+ * Pool structure. Blocks are stored after the structure in a single
+ * allocation. Free blocks are linked using their first bytes. The free list is
+ * protected by short critical sections instead of a mutex.
+ */
+typedef struct os_pool_handle{
+    char *blocks;               ///< First block
+    void *free_list;            ///< Next free block
+    size_t block_size;          ///< Aligned block size
+    osPoolStats stats;          ///< Allocation statistics
+} os_pool_handle_t;
+
+osPool osPoolCreate(int length, size_t block_size)
+{
+    os_pool_handle_t *pool;
+    size_t align = sizeof(void *) > sizeof(double) ? sizeof(void *) : sizeof(double);
+    size_t size;
+    int i;
+
+    if(length <= 0 || block_size == 0)
+        return NULL;
+
+    // Blocks must be able to store the free list pointer and keep alignment
+    size = block_size < sizeof(void *) ? sizeof(void *) : block_size;
+    size = (size + align - 1) & ~(align - 1);
+
+    size_t header = (sizeof(os_pool_handle_t) + align - 1) & ~(align - 1);
+    pool = (os_pool_handle_t *)pvPortMalloc(header + size*length);
+    if(pool == NULL)
+        return NULL;
+
+    pool->blocks = (char *)pool + header;
+    pool->block_size = size;
+    pool->free_list = NULL;
+    for(i=length-1; i>=0; i--)
+    {
+        void **block = (void **)(pool->blocks + i*size);
+        *block = pool->free_list;
+        pool->free_list = block;
+    }
+
+    memset(&pool->stats, 0, sizeof(osPoolStats));
+    pool->stats.capacity = (uint32_t)length;
+    pool->stats.block_size = (uint32_t)block_size;
+
+    return pool;
+}
+
+void *osPoolAlloc(osPool pool)
+{
+    os_pool_handle_t *p = (os_pool_handle_t *)pool;
+    void **block;
+
+    taskENTER_CRITICAL();
+    block = (void **)p->free_list;
+    if(block != NULL)
+    {
+        p->free_list = *block;
+        p->stats.allocs++;
+        p->stats.used++;
+        if(p->stats.used > p->stats.peak)
+            p->stats.peak = p->stats.used;
+    }
+    else
+    {
+        p->stats.fails++;
+    }
+    taskEXIT_CRITICAL();
+
+    return block;
+}
+
+int osPoolFree(osPool pool, void *block)
+{
+    os_pool_handle_t *p = (os_pool_handle_t *)pool;
+
+    if(!osPoolOwns(pool, block))
+        return 0;
+
+    taskENTER_CRITICAL();
+    *(void **)block = p->free_list;
+    p->free_list = block;
+    p->stats.used--;
+    taskEXIT_CRITICAL();
+
+    return pdPASS;
+}
+
+int osPoolOwns(osPool pool, void *block)
+{
+    os_pool_handle_t *p = (os_pool_handle_t *)pool;
+    char *ptr = (char *)block;
+
+    if(p == NULL || ptr < p->blocks)
+        return 0;
+    if(ptr >= p->blocks + p->block_size*p->stats.capacity)
+        return 0;
+    return (size_t)(ptr - p->blocks) % p->block_size == 0;
+}
+
+void osPoolGetStats(osPool pool, osPoolStats *stats)
+{
+    os_pool_handle_t *p = (os_pool_handle_t *)pool;
+
+    taskENTER_CRITICAL();
+    *stats = p->stats;
+    taskEXIT_CRITICAL();
+}
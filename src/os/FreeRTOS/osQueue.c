@@ -1,14 +1,83 @@
 
 #include "osQueue.h"
 
+/**
+ * FreeRTOS queue handle and the size of its items, that FreeRTOS does not
+ * expose, required to send several items at once
+ */
+typedef struct os_queue_s {
+    xQueueHandle handle;
+    size_t item_size;
+} os_queue_t;
+
 osQueue osQueueCreate(int length, size_t item_size) {
-	return xQueueCreate(length, item_size);
+    os_queue_t *q = (os_queue_t *)pvPortMalloc(sizeof(os_queue_t));
+    if(q == NULL)
+        return NULL;
+
+    q->handle = xQueueCreate(length, item_size);
+    q->item_size = item_size;
+    if(q->handle == NULL) {
+        vPortFree(q);
+        return NULL;
+    }
+    return q;
 }
 
 int osQueueSend(osQueue queue, void * value, uint32_t timeout) {
-	return xQueueSend(queue, value, timeout);
+	return xQueueSend(((os_queue_t *)queue)->handle, value, timeout);
 }
 
 int osQueueReceive(osQueue queue, void * buf, uint32_t timeout){
-    return xQueueReceive(queue, buf, timeout);
-}
\ No newline at end of file
+    return xQueueReceive(((os_queue_t *)queue)->handle, buf, timeout);
+}
+
+int osQueueSendBatch(osQueue queue, void *values, int n, uint32_t timeout) {
+    os_queue_t *q = (os_queue_t *)queue;
+    uint8_t *items = (uint8_t *)values;
+    int sent = 0;
+
+    /* Copy the items that fit with the scheduler suspended, so the receiver
+     * is woken up once, when the scheduler is resumed */
+    vTaskSuspendAll();
+    while(sent < n && xQueueSend(q->handle, items + sent*q->item_size, 0) == pdPASS)
+        sent++;
+    xTaskResumeAll();
+
+    /* Wait for space for the remaining items */
+    while(sent < n && xQueueSend(q->handle, items + sent*q->item_size, timeout) == pdPASS)
+        sent++;
+
+    return sent;
+}
+
+int osQueueReceiveBatch(osQueue queue, void *buf, int n, uint32_t timeout) {
+    os_queue_t *q = (os_queue_t *)queue;
+    uint8_t *items = (uint8_t *)buf;
+    int received = 0;
+
+    if(n <= 0)
+        return 0;
+
+    /* Wait for the first item only */
+    if(xQueueReceive(q->handle, items, timeout) != pdPASS)
+        return 0;
+    received++;
+
+    /* Take the available items with the scheduler suspended, so the senders
+     * are woken up once, when the scheduler is resumed */
+    vTaskSuspendAll();
+    while(received < n && xQueueReceive(q->handle, items + received*q->item_size, 0) == pdPASS)
+        received++;
+    xTaskResumeAll();
+
+    return received;
+}
+
+int osQueueSize(osQueue queue) {
+    return (int)uxQueueMessagesWaiting(((os_queue_t *)queue)->handle);
+}
+
+int osQueuePeek(osQueue queue, void *buf, uint32_t timeout) {
+    return xQueuePeek(((os_queue_t *)queue)->handle, buf, timeout);
+}
@@ -24,3 +24,11 @@ void osScheduler(os_thread* thread_id, int n_thread)
     	printf("[ERROR] FreeRTOS scheduler stopped!\n");
     }
 }
+
+/**
+ * FreeRTOS has no virtual memory, there is nothing to lock or pre-fault
+ */
+int osSchedulerRealTime(void)
+{
+    return 0;
+}
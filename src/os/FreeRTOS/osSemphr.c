@@ -1,8 +1,120 @@
+#include <stddef.h>
+#include <string.h>
 #include "osSemphr.h"
 
+#if SCH_OS_LOCK_PROFILE
+/* Lock profiler registry, times are measured in ticks. The profile of a
+ * semaphore is updated while the semaphore is taken. */
+static osLockProfile lock_profiles[SCH_OS_LOCK_MAX_ENTRIES];
+static int lock_profiles_n = 0;
+
+static uint64_t sem_now_us(void){
+	return (uint64_t)xTaskGetTickCount()*portTICK_RATE_MS*1000;
+}
+
+static int lock_profile_bucket(uint32_t us){
+	int bucket = us == 0 ? 0 : 32 - __builtin_clz(us);
+	return bucket < OS_LOCK_HIST_BUCKETS ? bucket : OS_LOCK_HIST_BUCKETS - 1;
+}
+
+/* Records a take, the semaphore is already taken */
+static void lock_profile_take(osLockProfile *profile, uint32_t waited, int contended){
+	profile->acquisitions++;
+	profile->contended += contended;
+	profile->wait_hist[lock_profile_bucket(waited)]++;
+	if (waited > profile->wait_max_us)
+		profile->wait_max_us = waited;
+	profile->taken_us = sem_now_us();
+}
+
+void osSemaphoreSetName(osSemaphore* mutex, const char *name){
+	int i;
+	osLockProfile *profile = NULL;
+
+	taskENTER_CRITICAL();
+	for (i = 0; i < lock_profiles_n; i++) {
+		if (strncmp(lock_profiles[i].name, name, sizeof(lock_profiles[i].name) - 1) == 0 &&
+		    lock_profiles[i].owner == mutex) {
+			profile = &lock_profiles[i];
+			break;
+		}
+	}
+	if (profile == NULL && lock_profiles_n < SCH_OS_LOCK_MAX_ENTRIES) {
+		profile = &lock_profiles[lock_profiles_n++];
+		memset(profile, 0, sizeof(osLockProfile));
+		strncpy(profile->name, name, sizeof(profile->name) - 1);
+		profile->owner = mutex;
+	}
+	mutex->profile = profile;
+	taskEXIT_CRITICAL();
+}
+
+int osLockProfileGet(int index, osLockProfile *profile){
+	int ok = 0;
+
+	taskENTER_CRITICAL();
+	if (index >= 0 && index < lock_profiles_n) {
+		memcpy(profile, &lock_profiles[index], sizeof(osLockProfile));
+		ok = 1;
+	}
+	taskEXIT_CRITICAL();
+	return ok;
+}
+
+void osLockProfileReset(void){
+	int i;
+
+	taskENTER_CRITICAL();
+	for (i = 0; i < lock_profiles_n; i++) {
+		osLockProfile *profile = &lock_profiles[i];
+		uint32_t waiters = profile->waiters;
+		uint64_t taken_us = profile->taken_us;
+		memset((char *)profile + offsetof(osLockProfile, acquisitions), 0,
+			   sizeof(osLockProfile) - offsetof(osLockProfile, acquisitions));
+		profile->waiters = waiters;
+		profile->max_waiters = waiters;
+		profile->taken_us = taken_us;
+	}
+	taskEXIT_CRITICAL();
+}
+
+uint32_t osLockProfilePercentile(const uint32_t *hist, uint32_t max_us, int percent){
+	uint64_t count = 0, seen = 0, target;
+	int bucket;
+
+	for (bucket = 0; bucket < OS_LOCK_HIST_BUCKETS; bucket++)
+		count += hist[bucket];
+	if (count == 0)
+		return 0;
+
+	target = (count*percent + 99)/100;
+	for (bucket = 0; bucket < OS_LOCK_HIST_BUCKETS - 1; bucket++) {
+		seen += hist[bucket];
+		if (seen >= target)
+			break;
+	}
+	uint32_t limit = bucket == 0 ? 0 : (uint32_t)((1ULL << bucket) - 1);
+	return limit < max_us ? limit : max_us;
+}
+#endif
+
 int osSemaphoreCreate(osSemaphore* mutex){
-	*mutex = xSemaphoreCreateMutex();
-	if (*mutex) {
+	return osSemaphoreCreateProtocol(mutex, OS_SEMAPHORE_INHERIT, 0);
+}
+
+/**
+ * FreeRTOS mutexes always use priority inheritance
+ */
+int osSemaphoreCreateProtocol(osSemaphore* mutex, int protocol, int ceiling){
+	mutex->takes = 0;
+	mutex->contended = 0;
+	mutex->wait_max_us = 0;
+	mutex->wait_total_us = 0;
+#if SCH_OS_LOCK_PROFILE
+	mutex->profile = NULL;
+#endif
+	mutex->handle = xSemaphoreCreateMutex();
+	if (mutex->handle) {
 		return CSP_SEMAPHORE_OK;
 	} else {
 		return CSP_SEMAPHORE_ERROR;
@@ -10,9 +122,52 @@ int osSemaphoreCreate(osSemaphore* mutex){
 }
 
 int osSemaphoreTake(osSemaphore *mutex, uint32_t timeout){
+	portTickType start;
+	uint32_t waited;
+
+	// Fast path, only contended takes are timed
+	if (xSemaphoreTake(mutex->handle, 0) == pdPASS) {
+		mutex->takes++;
+#if SCH_OS_LOCK_PROFILE
+		if (mutex->profile)
+			lock_profile_take(mutex->profile, 0, 0);
+#endif
+		return CSP_SEMAPHORE_OK;
+	}
+	if (timeout == 0)
+		return CSP_SEMAPHORE_ERROR;
+
 	if (timeout != portMAX_DELAY)
 		timeout = timeout / portTICK_RATE_MS;
-	if (xSemaphoreTake(*mutex, timeout) == pdPASS) {
+	start = xTaskGetTickCount();
+#if SCH_OS_LOCK_PROFILE
+	osLockProfile *profile = mutex->profile;
+	if (profile) {
+		taskENTER_CRITICAL();
+		if (++profile->waiters > profile->max_waiters)
+			profile->max_waiters = profile->waiters;
+		taskEXIT_CRITICAL();
+	}
+#endif
+	int ok = xSemaphoreTake(mutex->handle, timeout) == pdPASS;
+#if SCH_OS_LOCK_PROFILE
+	if (profile) {
+		taskENTER_CRITICAL();
+		profile->waiters--;
+		taskEXIT_CRITICAL();
+	}
+#endif
+	if (ok) {
+		waited = (uint32_t)(xTaskGetTickCount() - start)*portTICK_RATE_MS*1000;
+		mutex->takes++;
+		mutex->contended++;
+		mutex->wait_total_us += waited;
+		if (waited > mutex->wait_max_us)
+			mutex->wait_max_us = waited;
+#if SCH_OS_LOCK_PROFILE
+		if (profile)
+			lock_profile_take(profile, waited, 1);
+#endif
 		return CSP_SEMAPHORE_OK;
 	} else {
 		return CSP_SEMAPHORE_ERROR;
@@ -20,9 +175,26 @@ int osSemaphoreTake(osSemaphore *mutex, uint32_t timeout){
 }
 
 int osSemaphoreGiven(osSemaphore *mutex){
-	if (xSemaphoreGive(*mutex) == pdPASS) {
+#if SCH_OS_LOCK_PROFILE
+	osLockProfile *profile = mutex->profile;
+	if (profile) {
+		uint32_t held = (uint32_t)(sem_now_us() - profile->taken_us);
+		profile->hold_hist[lock_profile_bucket(held)]++;
+		profile->hold_total_us += held;
+		if (held > profile->hold_max_us)
+			profile->hold_max_us = held;
+	}
+#endif
+	if (xSemaphoreGive(mutex->handle) == pdPASS) {
 		return CSP_SEMAPHORE_OK;
 	} else {
 		return CSP_SEMAPHORE_ERROR;
 	}
 }
+
+void osSemaphoreGetStats(osSemaphore *mutex, osSemaphoreStats *stats){
+	stats->takes = mutex->takes;
+	stats->contended = mutex->contended;
+	stats->wait_max_us = mutex->wait_max_us;
+	stats->wait_total_us = mutex->wait_total_us;
+}
@@ -4,27 +4,138 @@
  * @date 26-10-2016
  * @copyright GNU Public License.
  *
- * Creation of functions related with time for systems operating FreeRTOS.
+ * Creation of functions related with tasks for systems operating FreeRTOS.
  * 
  */
+#include <string.h>
 #include "osThread.h"
 
+/**
+ * Task registry record. The stack high water mark is read from the kernel,
+ * CPU time is not available. Wake ups are counted only in delays.
+ */
+typedef struct os_task_record_s {
+    osTaskStats stats;
+    xTaskHandle handle;
+} os_task_record_t;
+
+static os_task_record_t task_registry[SCH_OS_TASK_MAX_ENTRIES];
+static int task_count = 0;
+
+/**
+ * Record of the calling task, or NULL
+ */
+static osTaskStats *os_task_self(void)
+{
+#if INCLUDE_xTaskGetCurrentTaskHandle
+    xTaskHandle self = xTaskGetCurrentTaskHandle();
+    int i;
+    for(i=0; i<task_count; i++)
+    {
+        if(task_registry[i].handle == self)
+            return &task_registry[i].stats;
+    }
+#endif
+    return NULL;
+}
+
 /**
  * create a task in FreeRTOS
  */
 int osCreateTask(void (*functionTask)(void *), char* name, unsigned short size, void * parameters, unsigned int priority, os_thread *thread)
 {
+    xTaskHandle handle = NULL;
 #ifdef AVR32
     // FreeRTOS 7.0.0
-    portBASE_TYPE created = xTaskCreate((*functionTask), (signed char*)name, size, parameters, priority, NULL);
+    portBASE_TYPE created = xTaskCreate((*functionTask), (signed char*)name, size, parameters, priority, &handle);
 #else
     // FreeRTOS > 8.0.0
-    BaseType_t created = xTaskCreate((*functionTask), name, size, parameters, priority, NULL);
+    BaseType_t created = xTaskCreate((*functionTask), name, size, parameters, priority, &handle);
 #endif
+
+    // Tasks are created before the scheduler starts or by a single task
+    if(created == pdPASS && task_count < SCH_OS_TASK_MAX_ENTRIES)
+    {
+        os_task_record_t *task = &task_registry[task_count];
+        memset(task, 0, sizeof(os_task_record_t));
+        strncpy(task->stats.name, name, sizeof(task->stats.name)-1);
+        task->stats.alive = 1;
+        task->stats.stack_size = (uint32_t)size*sizeof(portSTACK_TYPE);
+        task->handle = handle;
+        task_count++;
+    }
+
     return created == pdPASS ? 0 : 1;
 }
 
+int osCreateTaskAffinity(void (*functionTask)(void *), char* name, unsigned short size, void * parameters, unsigned int priority, int cpu, os_thread *thread)
+{
+    return osCreateTask(functionTask, name, size, parameters, priority, thread);
+}
+
 void osTaskDelete(void *task_handle)
 {
+    osTaskStats *stats = os_task_self();
+    if(task_handle == NULL && stats != NULL)
+        stats->alive = 0;
     vTaskDelete(task_handle);
 }
+
+int osTaskSetAffinity(os_thread *thread, int cpu)
+{
+    return 0;
+}
+
+int osTaskGetStats(int index, osTaskStats *stats)
+{
+    if(index < 0 || index >= task_count || stats == NULL)
+        return 0;
+
+    *stats = task_registry[index].stats;
+#if INCLUDE_uxTaskGetStackHighWaterMark
+    // The handle of a deleted task is no longer valid
+    if(stats->alive)
+        stats->stack_used = stats->stack_size -
+            (uint32_t)uxTaskGetStackHighWaterMark(task_registry[index].handle)*sizeof(portSTACK_TYPE);
+#endif
+    return 1;
+}
+
+void osTaskResetStats(void)
+{
+    int i;
+    for(i=0; i<task_count; i++)
+    {
+        osTaskStats *stats = &task_registry[i].stats;
+        stats->wakeups = 0;
+        stats->latency_count = 0;
+        stats->latency_total_us = 0;
+        stats->latency_max_us = 0;
+        stats->overruns = 0;
+    }
+}
+
+void osTaskStatsWakeup(void)
+{
+    osTaskStats *stats = os_task_self();
+    if(stats != NULL)
+        stats->wakeups++;
+}
+
+void osTaskStatsLatency(uint32_t latency_us)
+{
+    osTaskStats *stats = os_task_self();
+    if(stats == NULL)
+        return;
+    stats->latency_count++;
+    stats->latency_total_us += latency_us;
+    if(latency_us > stats->latency_max_us)
+        stats->latency_max_us = latency_us;
+}
+
+void osTaskStatsOverrun(void)
+{
+    osTaskStats *stats = os_task_self();
+    if(stats != NULL)
+        stats->overruns++;
+}
@@ -0,0 +1,65 @@
+/**
+ * @file  FreeRTOS/osTimer.c
+ * @author Carlos Gonzalez Cortes
+ * @date 2018
+ * @copyright GNU Public License.
+ *
+ * Software timers for FreeRTOS, mapped to the timer service task.
+ *
+ */
+
+#include "osTimer.h"
+
+typedef struct os_timer_s {
+    xTimerHandle handle;
+    osTimerCallback callback;
+    void *arg;
+} os_timer_t;
+
+/**
+ * FreeRTOS timer callback, calls the osTimer callback stored in the timer ID
+ */
+static void os_timer_callback(xTimerHandle handle)
+{
+    os_timer_t *t = (os_timer_t *)pvTimerGetTimerID(handle);
+    t->callback(t->arg);
+}
+
+osTimer osTimerCreate(char *name, uint32_t period_ms, int periodic, osTimerCallback callback, void *arg)
+{
+    os_timer_t *t;
+    portTickType ticks = period_ms/portTICK_RATE_MS;
+
+    if(ticks == 0 || callback == NULL)
+        return NULL;
+
+    t = pvPortMalloc(sizeof(os_timer_t));
+    if(t == NULL)
+        return NULL;
+
+    t->callback = callback;
+    t->arg = arg;
+#ifdef AVR32
+    // FreeRTOS 7.0.0
+    t->handle = xTimerCreate((signed char *)name, ticks, periodic ? pdTRUE : pdFALSE, t, os_timer_callback);
+#else
+    // FreeRTOS > 8.0.0
+    t->handle = xTimerCreate(name, ticks, periodic ? pdTRUE : pdFALSE, t, os_timer_callback);
+#endif
+    if(t->handle == NULL)
+    {
+        vPortFree(t);
+        return NULL;
+    }
+    return t;
+}
+
+int osTimerStart(osTimer timer)
+{
+    return xTimerReset(((os_timer_t *)timer)->handle, portMAX_DELAY);
+}
+
+int osTimerStop(osTimer timer)
+{
+    return xTimerStop(((os_timer_t *)timer)->handle, portMAX_DELAY);
+}
@@ -18,7 +18,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <errno.h>
 #include "osDelay.h"
+#include "osThread.h"
 
 portTick osDefineTime(uint32_t mseconds)
 {
@@ -28,38 +30,58 @@ portTick osDefineTime(uint32_t mseconds)
 
 portTick osTaskGetTickCount(void)
 {
-    //calculate time
+    //calculate time, same clock used by osTaskDelayUntil
     struct timespec time;
-    clock_gettime(CLOCK_MONOTONIC_RAW, &time);
+    clock_gettime(CLOCK_MONOTONIC, &time);
     //return time in microseconds
     return (portTick)(time.tv_sec*1000000+time.tv_nsec/1000);
 }
 
 void osDelay(uint32_t mseconds)
 {
+    portTick start = osTaskGetTickCount();
     //transform to microseconds
     usleep(mseconds*1000);
+
+    // Latency is the time slept beyond the requested delay
+    portTick slept = osTaskGetTickCount() - start;
+    osTaskStatsWakeup();
+    osTaskStatsLatency(slept > osDefineTime(mseconds) ? slept - osDefineTime(mseconds) : 0);
 }
 
 void osTaskDelayUntil(portTick *lastTime, uint32_t mseconds)
 {
-    //calculate time left
-    portTick c_usec = osTaskGetTickCount();   // Current ticks
-    portTick d_usec = c_usec - *lastTime;     // Delta ticks
-    portTick s_usec = osDefineTime(mseconds); // Sleep ticks
+    struct timespec wake;
+    portTick left;                                         // Ticks left
+    portTick s_usec = osDefineTime(mseconds);              // Sleep ticks
+    portTick d_usec = osTaskGetTickCount() - *lastTime;    // Delta ticks
+
+    // The next period starts when this one should end, not when the task
+    // wakes up, so periods do not drift
+    *lastTime += s_usec;
 
     // Return if more than desired milli seconds have passed
-    if(d_usec > s_usec)
+    if(d_usec >= s_usec)
     {
-        // Tag last delay ticks
-        *lastTime = osTaskGetTickCount()-(d_usec-s_usec);
+        osTaskStatsOverrun();
         return;
     }
+    left = s_usec - d_usec;
 
-    // Delay left ticks
-    uint32_t s_msec = (s_usec - d_usec)/1000;
-    osDelay(s_msec);
+    // Sleep until an absolute time, not affected by the time used to
+    // calculate the delay or by interruptions
+    clock_gettime(CLOCK_MONOTONIC, &wake);
+    wake.tv_sec += left/1000000;
+    wake.tv_nsec += (long)(left%1000000)*1000;
+    if(wake.tv_nsec >= 1000000000)
+    {
+        wake.tv_sec++;
+        wake.tv_nsec -= 1000000000;
+    }
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wake, NULL) == EINTR);
 
-    // Tag last delay ticks
-    *lastTime = osTaskGetTickCount();
-}
\ No newline at end of file
+    // Latency is the time since the end of the period, *lastTime
+    osTaskStatsWakeup();
+    int32_t late = (int32_t)(osTaskGetTickCount() - *lastTime);
+    osTaskStatsLatency(late > 0 ? (uint32_t)late : 0);
+}
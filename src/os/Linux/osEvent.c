@@ -0,0 +1,128 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "osEvent.h"
+#include "osThread.h"
+
+/**
+ * Linux event. Bits are protected by the mutex, waiting tasks are woken with
+ * a broadcast and test their own condition.
+ */
+typedef struct os_event_s {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;        ///< Broadcast when bits are set
+    uint32_t bits;              ///< Event bits
+} os_event_t;
+
+static inline int event_ready(os_event_t *e, uint32_t bits, int wait_all)
+{
+    return wait_all ? (e->bits & bits) == bits : (e->bits & bits) != 0;
+}
+
+osEvent osEventCreate(void)
+{
+    pthread_condattr_t attr;
+    os_event_t *e = malloc(sizeof(os_event_t));
+    if(e == NULL)
+        return NULL;
+
+    pthread_mutex_init(&e->mutex, NULL);
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&e->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    e->bits = 0;
+    return e;
+}
+
+uint32_t osEventSet(osEvent event, uint32_t bits)
+{
+    os_event_t *e = (os_event_t *)event;
+    uint32_t value;
+
+    pthread_mutex_lock(&e->mutex);
+    e->bits |= bits & OS_EVENT_ALL_BITS;
+    value = e->bits;
+    pthread_cond_broadcast(&e->cond);
+    pthread_mutex_unlock(&e->mutex);
+    return value;
+}
+
+uint32_t osEventClear(osEvent event, uint32_t bits)
+{
+    os_event_t *e = (os_event_t *)event;
+    uint32_t value;
+
+    pthread_mutex_lock(&e->mutex);
+    value = e->bits;
+    e->bits &= ~bits;
+    pthread_mutex_unlock(&e->mutex);
+    return value;
+}
+
+uint32_t osEventGet(osEvent event)
+{
+    os_event_t *e = (os_event_t *)event;
+    uint32_t value;
+
+    pthread_mutex_lock(&e->mutex);
+    value = e->bits;
+    pthread_mutex_unlock(&e->mutex);
+    return value;
+}
+
+uint32_t osEventWait(osEvent event, uint32_t bits, int wait_all, int clear, uint32_t timeout)
+{
+    os_event_t *e = (os_event_t *)event;
+    struct timespec deadline;
+    uint32_t value;
+    int rc = 0;
+
+    if(timeout != portMAX_DELAY)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout/1000;
+        deadline.tv_nsec += (long)(timeout%1000)*1000000L;
+        if(deadline.tv_nsec >= 1000000000L)
+        {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&e->mutex);
+    while(!event_ready(e, bits, wait_all) && timeout != 0 && rc == 0)
+    {
+        if(timeout == portMAX_DELAY)
+            rc = pthread_cond_wait(&e->cond, &e->mutex);
+        else
+            rc = pthread_cond_timedwait(&e->cond, &e->mutex, &deadline);
+        osTaskStatsWakeup();
+    }
+
+    value = e->bits;
+    if(clear && event_ready(e, bits, wait_all))
+        e->bits &= ~bits;
+    pthread_mutex_unlock(&e->mutex);
+    return value;
+}
@@ -22,15 +22,35 @@
 
 osQueue osQueueCreate(int length, size_t item_size)
 {
-	return os_pthread_queue_create(length, item_size);
+	// Queues in the system have several senders or receivers
+	return os_ring_queue_create(length, item_size, 0);
 }
 
 int osQueueSend(osQueue queue, void * value, uint32_t timeout)
 {
-	return os_pthread_queue_send(queue, value, timeout);
+	return os_ring_queue_send(queue, value, timeout);
 }
 
 int osQueueReceive(osQueue queue, void * buf, uint32_t timeout){
-    return os_pthread_queue_receive(queue, buf, timeout);
+    return os_ring_queue_receive(queue, buf, timeout);
 }
 
+int osQueueSendBatch(osQueue queue, void *values, int n, uint32_t timeout)
+{
+    return os_ring_queue_send_batch(queue, values, n, timeout);
+}
+
+int osQueueReceiveBatch(osQueue queue, void *buf, int n, uint32_t timeout)
+{
+    return os_ring_queue_receive_batch(queue, buf, n, timeout);
+}
+
+int osQueueSize(osQueue queue)
+{
+    return os_ring_queue_size(queue);
+}
+
+int osQueuePeek(osQueue queue, void *buf, uint32_t timeout)
+{
+    return os_ring_queue_peek(queue, buf, timeout);
+}
@@ -18,6 +18,12 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <errno.h>
+#include <malloc.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
 #include "osScheduler.h"
 
 const static char *tag = "osScheduler";
@@ -38,3 +44,37 @@ void osScheduler(os_thread* threads_id, int n_threads)
     /* FIXME: Catch term or exit or kill signal to do a clean exit */
     exit(0);
 }
+
+int osSchedulerRealTime(void)
+{
+    int rc = 0;
+
+    // Allocations after start up must not call the kernel: freed memory is
+    // kept in the heap, big blocks do not use mmap and all threads share the
+    // pre-faulted main arena
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    mallopt(M_ARENA_MAX, 1);
+
+    // Lock (and fault in) the pages mapped now, as pools, and the ones mapped
+    // later, as task stacks
+    if(mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        LOGW(tag, "Failed to lock memory (%s), try as root or increase RLIMIT_MEMLOCK", strerror(errno));
+        rc = -1;
+    }
+
+    // Fault in a heap reserve, it remains in the heap after free. Volatile
+    // writes, the compiler must not remove them.
+    volatile char *reserve = malloc(SCH_OS_RT_HEAP_RESERVE);
+    if(reserve != NULL)
+    {
+        size_t page = (size_t)sysconf(_SC_PAGESIZE), i;
+        for(i=0; i<SCH_OS_RT_HEAP_RESERVE; i+=page)
+            reserve[i] = 0;
+        free((void *)reserve);
+    }
+
+    LOGI(tag, "Real-time mode enabled, memory %slocked", rc == 0 ? "" : "not ");
+    return rc;
+}
@@ -18,11 +18,159 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+#include <time.h>
 #include "osSemphr.h"
 
+static uint64_t sem_now_us(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec*1000000ULL + (uint64_t)now.tv_nsec/1000;
+}
+
+#if SCH_OS_LOCK_PROFILE
+/* Lock profiler registry, only locked to add names and read profiles. The
+ * profile of a semaphore is updated while the semaphore is taken. */
+static osLockProfile lock_profiles[SCH_OS_LOCK_MAX_ENTRIES];
+static int lock_profiles_n = 0;
+static pthread_mutex_t lock_profiles_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static inline int lock_profile_bucket(uint32_t us)
+{
+	int bucket = us == 0 ? 0 : 32 - __builtin_clz(us);
+	return bucket < OS_LOCK_HIST_BUCKETS ? bucket : OS_LOCK_HIST_BUCKETS - 1;
+}
+
+/* Records a take, the semaphore is already taken */
+static inline void lock_profile_take(osLockProfile *profile, uint64_t now, uint32_t waited, int contended)
+{
+	profile->acquisitions++;
+	profile->contended += contended;
+	profile->wait_hist[lock_profile_bucket(waited)]++;
+	if (waited > profile->wait_max_us)
+		profile->wait_max_us = waited;
+	profile->taken_us = now;
+}
+
+void osSemaphoreSetName(osSemaphore *mutex, const char *name)
+{
+	int i;
+	osLockProfile *profile = NULL;
+
+	pthread_mutex_lock(&lock_profiles_mutex);
+	for (i = 0; i < lock_profiles_n; i++)
+	{
+		if (strncmp(lock_profiles[i].name, name, sizeof(lock_profiles[i].name) - 1) == 0 &&
+		    lock_profiles[i].owner == mutex)
+		{
+			profile = &lock_profiles[i];
+			break;
+		}
+	}
+	if (profile == NULL && lock_profiles_n < SCH_OS_LOCK_MAX_ENTRIES)
+	{
+		profile = &lock_profiles[lock_profiles_n++];
+		memset(profile, 0, sizeof(osLockProfile));
+		strncpy(profile->name, name, sizeof(profile->name) - 1);
+		profile->owner = mutex;
+	}
+	mutex->profile = profile;
+	pthread_mutex_unlock(&lock_profiles_mutex);
+}
+
+int osLockProfileGet(int index, osLockProfile *profile)
+{
+	int ok = 0;
+
+	pthread_mutex_lock(&lock_profiles_mutex);
+	if (index >= 0 && index < lock_profiles_n)
+	{
+		memcpy(profile, &lock_profiles[index], sizeof(osLockProfile));
+		ok = 1;
+	}
+	pthread_mutex_unlock(&lock_profiles_mutex);
+	return ok;
+}
+
+void osLockProfileReset(void)
+{
+	int i;
+
+	pthread_mutex_lock(&lock_profiles_mutex);
+	for (i = 0; i < lock_profiles_n; i++)
+	{
+		osLockProfile *profile = &lock_profiles[i];
+		uint32_t waiters = __atomic_load_n(&profile->waiters, __ATOMIC_RELAXED);
+		uint64_t taken_us = profile->taken_us;
+		memset((char *)profile + offsetof(osLockProfile, acquisitions), 0,
+			   sizeof(osLockProfile) - offsetof(osLockProfile, acquisitions));
+		profile->waiters = waiters;
+		profile->max_waiters = waiters;
+		profile->taken_us = taken_us;
+	}
+	pthread_mutex_unlock(&lock_profiles_mutex);
+}
+
+uint32_t osLockProfilePercentile(const uint32_t *hist, uint32_t max_us, int percent)
+{
+	uint64_t count = 0, seen = 0, target;
+	int bucket;
+
+	for (bucket = 0; bucket < OS_LOCK_HIST_BUCKETS; bucket++)
+		count += hist[bucket];
+	if (count == 0)
+		return 0;
+
+	target = (count*percent + 99)/100;
+	for (bucket = 0; bucket < OS_LOCK_HIST_BUCKETS - 1; bucket++)
+	{
+		seen += hist[bucket];
+		if (seen >= target)
+			break;
+	}
+	uint32_t limit = bucket == 0 ? 0 : (uint32_t)((1ULL << bucket) - 1);
+	return limit < max_us ? limit : max_us;
+}
+#endif
+
 int osSemaphoreCreate(osSemaphore* mutex)
 {
-	if (pthread_mutex_init(mutex, NULL) == 0)
+	return osSemaphoreCreateProtocol(mutex, OS_SEMAPHORE_INHERIT, 0);
+}
+
+int osSemaphoreCreateProtocol(osSemaphore* mutex, int protocol, int ceiling)
+{
+	pthread_mutexattr_t attr;
+	int ret = 0;
+
+	mutex->takes = 0;
+	mutex->contended = 0;
+	mutex->wait_max_us = 0;
+	mutex->wait_total_us = 0;
+#if SCH_OS_LOCK_PROFILE
+	mutex->profile = NULL;
+#endif
+
+	pthread_mutexattr_init(&attr);
+	if (protocol == OS_SEMAPHORE_INHERIT)
+	{
+		ret = pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	}
+	else if (protocol == OS_SEMAPHORE_CEILING)
+	{
+		ret = pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_PROTECT);
+		if (ret == 0)
+			ret = pthread_mutexattr_setprioceiling(&attr, ceiling);
+	}
+
+	if (ret == 0)
+		ret = pthread_mutex_init(&mutex->mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	if (ret == 0)
 	{
 		return CSP_SEMAPHORE_OK;
 	} else
@@ -36,12 +184,38 @@ int osSemaphoreTake(osSemaphore *mutex, uint32_t timeout)
 	int ret;
 	struct timespec ts;
 	uint32_t sec, nsec;
+	uint64_t start;
 
 	//csp_log_lock("Wait: %p timeout PRIu32\r\n", mutex, timeout);
 
+	// Fast path, only contended takes are timed
+	ret = pthread_mutex_trylock(&mutex->mutex);
+	if (ret == 0)
+	{
+		mutex->takes++;
+#if SCH_OS_LOCK_PROFILE
+		if (mutex->profile)
+			lock_profile_take(mutex->profile, sem_now_us(), 0, 0);
+#endif
+		return CSP_SEMAPHORE_OK;
+	}
+	if (ret != EBUSY || timeout == 0)
+		return CSP_SEMAPHORE_ERROR;
+
+	start = sem_now_us();
+#if SCH_OS_LOCK_PROFILE
+	osLockProfile *profile = mutex->profile;
+	if (profile)
+	{
+		uint32_t waiters = __atomic_add_fetch(&profile->waiters, 1, __ATOMIC_RELAXED);
+		uint32_t max = __atomic_load_n(&profile->max_waiters, __ATOMIC_RELAXED);
+		while (waiters > max && !__atomic_compare_exchange_n(&profile->max_waiters,
+				&max, waiters, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+	}
+#endif
 	if (timeout == portMAX_DELAY)
 	{
-		ret = pthread_mutex_lock(mutex);
+		ret = pthread_mutex_lock(&mutex->mutex);
 	}
 	else
 	{
@@ -58,18 +232,46 @@ int osSemaphoreTake(osSemaphore *mutex, uint32_t timeout)
 
 		ts.tv_nsec = (ts.tv_nsec + nsec) % 1000000000;
 
-		ret = pthread_mutex_timedlock(mutex, &ts);
+		ret = pthread_mutex_timedlock(&mutex->mutex, &ts);
 	}
 
+#if SCH_OS_LOCK_PROFILE
+	if (profile)
+		__atomic_sub_fetch(&profile->waiters, 1, __ATOMIC_RELAXED);
+#endif
 	if (ret != 0)
 		return CSP_SEMAPHORE_ERROR;
 
+	// Mutex taken, counters are protected
+	uint64_t now = sem_now_us();
+	uint32_t waited = (uint32_t)(now - start);
+	mutex->takes++;
+	mutex->contended++;
+	mutex->wait_total_us += waited;
+	if (waited > mutex->wait_max_us)
+		mutex->wait_max_us = waited;
+#if SCH_OS_LOCK_PROFILE
+	if (profile)
+		lock_profile_take(profile, now, waited, 1);
+#endif
+
 	return CSP_SEMAPHORE_OK;
 }
 
 int osSemaphoreGiven(osSemaphore *mutex)
 {
-	if (pthread_mutex_unlock(mutex) == 0)
+#if SCH_OS_LOCK_PROFILE
+	osLockProfile *profile = mutex->profile;
+	if (profile)
+	{
+		uint32_t held = (uint32_t)(sem_now_us() - profile->taken_us);
+		profile->hold_hist[lock_profile_bucket(held)]++;
+		profile->hold_total_us += held;
+		if (held > profile->hold_max_us)
+			profile->hold_max_us = held;
+	}
+#endif
+	if (pthread_mutex_unlock(&mutex->mutex) == 0)
 	{
 		return CSP_SEMAPHORE_OK;
 	}
@@ -77,4 +279,12 @@ int osSemaphoreGiven(osSemaphore *mutex)
 	{
 		return CSP_SEMAPHORE_ERROR;
 	}
-}
\ No newline at end of file
+}
+
+void osSemaphoreGetStats(osSemaphore *mutex, osSemaphoreStats *stats)
+{
+	stats->takes = mutex->takes;
+	stats->contended = mutex->contended;
+	stats->wait_max_us = mutex->wait_max_us;
+	stats->wait_total_us = mutex->wait_total_us;
+}
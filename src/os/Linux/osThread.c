@@ -18,28 +18,113 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
 #include "osThread.h"
+#include "task_stats.h"
+
+/**
+ * Task start parameters
+ */
+typedef struct os_task_s {
+    void (*function)(void *);   ///< Task function
+    void *parameters;           ///< Task function parameters
+    int index;                  ///< Task index in the registry
+} os_task_t;
+
+/* CPUs of the process, saved before any task is pinned. Tasks that can run
+ * in any CPU do not inherit the CPU of the task that creates them. */
+static cpu_set_t os_process_cpus;
+static pthread_once_t os_process_cpus_once = PTHREAD_ONCE_INIT;
+
+static void os_process_cpus_init(void)
+{
+    if(sched_getaffinity(0, sizeof(os_process_cpus), &os_process_cpus) != 0)
+        CPU_ZERO(&os_process_cpus);
+}
+
+static void os_task_end(void *arg)
+{
+    os_task_stats_end();
+}
+
+/**
+ * Runs the task function, the registry is updated when the function returns
+ * or the task is deleted
+ */
+static void *os_task(void *arg)
+{
+    os_task_t task = *(os_task_t *)arg;
+    free(arg);
+
+    os_task_stats_start(task.index);
+    pthread_cleanup_push(os_task_end, NULL);
+    task.function(task.parameters);
+    pthread_cleanup_pop(1);
+    return NULL;
+}
 
 /**
  * create a task in Linux as thread
  */
 int osCreateTask(void (*functionTask)(void *), char* name, unsigned short size, void * parameters, unsigned int priority, os_thread* thread){
+    return osCreateTaskAffinity(functionTask, name, size, parameters, priority, -1, thread);
+}
+
+int osCreateTaskAffinity(void (*functionTask)(void *), char* name, unsigned short size, void * parameters, unsigned int priority, int cpu, os_thread* thread){
 
     pthread_attr_t attr;
-    pthread_attr_init(&attr);
-    pthread_attr_setstacksize(&attr, size);
+    os_task_t *task = malloc(sizeof(os_task_t));
+    if(task == NULL)
+        return 1;
+    task->function = functionTask;
+    task->parameters = parameters;
 
-    int created = pthread_create(thread , &attr , (void *)(*functionTask) , parameters);
-    pthread_setname_np(*thread, name);
+    // Tasks out of the registry use the min. stack, size (unsigned short) is
+    // always below it
+    pthread_attr_init(&attr);
+    task->index = os_task_stats_add(name, size, &attr);
+    if(task->index < 0)
+        pthread_attr_setstacksize(&attr, SCH_OS_TASK_STACK_MIN);
 
-    // Set Real Time scheduling and thread priority
+    // Set Real Time scheduling and thread priority before the task starts
     // Only with proper permissions
     const struct sched_param _priority = {(int) priority};
-    if(pthread_setschedparam(*thread, SCHED_FIFO, &_priority) != 0)
-        printf("[WARN] (%s) Failed to assign task priority, try as root\n", name);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &_priority);
 
+    // Pin the task before it starts, by default it runs in any CPU of the process
+    cpu_set_t cpus;
+    pthread_once(&os_process_cpus_once, os_process_cpus_init);
+    cpus = os_process_cpus;
+    if(cpu >= 0 && cpu < CPU_SETSIZE)
+    {
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+    }
+    if(cpu >= CPU_SETSIZE || (CPU_COUNT(&cpus) > 0 &&
+       pthread_attr_setaffinity_np(&attr, sizeof(cpus), &cpus) != 0))
+        printf("[WARN] (%s) Failed to pin task to CPU %d\n", name, cpu);
+
+    int created = pthread_create(thread , &attr , os_task, task);
+    if(created == EPERM)
+    {
+        printf("[WARN] (%s) Failed to assign task priority, try as root\n", name);
+        pthread_attr_setinheritsched(&attr, PTHREAD_INHERIT_SCHED);
+        created = pthread_create(thread , &attr , os_task, task);
+    }
     pthread_attr_destroy(&attr);
 
+    if(created != 0)
+    {
+        free(task);
+        return created;
+    }
+    pthread_setname_np(*thread, name);
+
+
     return created;
 }
 
@@ -56,3 +141,29 @@ void osTaskDelete(void *task_handle)
     if (s != 0) printf("[WARN] Failed to cancel thread %lu\n", thread);
 }
 
+/**
+ * Pin a thread to one CPU, or allow all the CPUs of the process
+ */
+int osTaskSetAffinity(os_thread *thread, int cpu)
+{
+    cpu_set_t cpus;
+
+    CPU_ZERO(&cpus);
+    if(cpu < 0)
+    {
+        // Any CPU available to the process
+        pthread_once(&os_process_cpus_once, os_process_cpus_init);
+        cpus = os_process_cpus;
+        if(CPU_COUNT(&cpus) == 0)
+            return 1;
+    }
+    else
+    {
+        CPU_SET(cpu, &cpus);
+    }
+
+    int rc = pthread_setaffinity_np(*thread, sizeof(cpus), &cpus);
+    if(rc != 0)
+        printf("[WARN] Failed to pin thread %lu to CPU %d\n", *thread, cpu);
+    return rc;
+}
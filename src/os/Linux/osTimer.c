@@ -0,0 +1,237 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "osTimer.h"
+#include "osThread.h"
+
+/**
+ * Linux timer. Active timers are kept in a min-heap sorted by expiration
+ * time, the timer task sleeps until the first one expires.
+ */
+typedef struct os_timer_s {
+    char *name;                 ///< Timer name
+    osTimerCallback callback;   ///< Function called when the timer expires
+    void *arg;                  ///< Callback argument
+    uint64_t period_ns;         ///< Timer period in nanoseconds
+    int periodic;               ///< 1 if the timer is rescheduled after expiring
+    uint64_t expiry_ns;         ///< Next expiration, CLOCK_MONOTONIC time
+    int index;                  ///< Position in the heap, -1 if stopped
+} os_timer_t;
+
+static os_timer_t *timer_heap[SCH_OS_TIMER_MAX_ENTRIES];
+static int timer_count = 0;
+
+static pthread_mutex_t timer_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timer_cond;
+static pthread_once_t timer_once = PTHREAD_ONCE_INIT;
+static os_thread timer_thread;
+
+static uint64_t timer_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec*1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void timer_heap_swap(int i, int j)
+{
+    os_timer_t *tmp = timer_heap[i];
+    timer_heap[i] = timer_heap[j];
+    timer_heap[j] = tmp;
+    timer_heap[i]->index = i;
+    timer_heap[j]->index = j;
+}
+
+/**
+ * Restores the heap order after the timer at @i changed its expiration time
+ */
+static void timer_heap_fix(int i)
+{
+    // Move up
+    while(i > 0 && timer_heap[i]->expiry_ns < timer_heap[(i-1)/2]->expiry_ns)
+    {
+        timer_heap_swap(i, (i-1)/2);
+        i = (i-1)/2;
+    }
+
+    // Move down
+    while(1)
+    {
+        int min = i, l = 2*i + 1, r = 2*i + 2;
+        if(l < timer_count && timer_heap[l]->expiry_ns < timer_heap[min]->expiry_ns)
+            min = l;
+        if(r < timer_count && timer_heap[r]->expiry_ns < timer_heap[min]->expiry_ns)
+            min = r;
+        if(min == i)
+            break;
+        timer_heap_swap(i, min);
+        i = min;
+    }
+}
+
+static void timer_heap_remove(os_timer_t *timer)
+{
+    int i = timer->index;
+    timer->index = -1;
+    timer_count--;
+    if(i != timer_count)
+    {
+        timer_heap[i] = timer_heap[timer_count];
+        timer_heap[i]->index = i;
+        timer_heap_fix(i);
+    }
+}
+
+static int timer_heap_insert(os_timer_t *timer)
+{
+    if(timer_count >= SCH_OS_TIMER_MAX_ENTRIES)
+        return 0;
+    timer->index = timer_count;
+    timer_heap[timer_count++] = timer;
+    timer_heap_fix(timer->index);
+    return 1;
+}
+
+/**
+ * Timer task. Sleeps until the first timer expires (absolute CLOCK_MONOTONIC
+ * time) or a timer is started, and runs the expired callbacks without holding
+ * the lock.
+ */
+static void timer_task(void *param)
+{
+    struct timespec deadline;
+    os_timer_t *timer;
+    uint64_t now;
+
+    pthread_mutex_lock(&timer_mutex);
+    while(1)
+    {
+        if(timer_count == 0)
+        {
+            pthread_cond_wait(&timer_cond, &timer_mutex);
+            continue;
+        }
+
+        timer = timer_heap[0];
+        now = timer_now_ns();
+        if(timer->expiry_ns > now)
+        {
+            deadline.tv_sec = (time_t)(timer->expiry_ns/1000000000ULL);
+            deadline.tv_nsec = (long)(timer->expiry_ns%1000000000ULL);
+            pthread_cond_timedwait(&timer_cond, &timer_mutex, &deadline);
+            continue;
+        }
+
+        osTaskStatsWakeup();
+        osTaskStatsLatency((uint32_t)((now - timer->expiry_ns)/1000));
+        if(timer->periodic && now - timer->expiry_ns >= timer->period_ns)
+            osTaskStatsOverrun();
+
+        // Reschedule from the expiration time, not from now, to avoid drift.
+        // Missed periods are skipped.
+        if(timer->periodic)
+        {
+            timer->expiry_ns += ((now - timer->expiry_ns)/timer->period_ns + 1)*timer->period_ns;
+            timer_heap_fix(0);
+        }
+        else
+        {
+            timer_heap_remove(timer);
+        }
+
+        pthread_mutex_unlock(&timer_mutex);
+        timer->callback(timer->arg);
+        pthread_mutex_lock(&timer_mutex);
+    }
+}
+
+static void timer_init(void)
+{
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&timer_cond, &attr);
+    pthread_condattr_destroy(&attr);
+
+    // Created as a system task to be listed in the task registry
+    if(osCreateTaskAffinity(timer_task, "timer", SCH_TASK_DEF_STACK, NULL, 3, SCH_TASK_TMR_CPU, &timer_thread) != 0)
+        printf("[ERROR] Failed to create the timer task\n");
+}
+
+osTimer osTimerCreate(char *name, uint32_t period_ms, int periodic, osTimerCallback callback, void *arg)
+{
+    os_timer_t *timer;
+
+    if(period_ms == 0 || callback == NULL)
+        return NULL;
+
+    pthread_once(&timer_once, timer_init);
+
+    timer = (os_timer_t *)malloc(sizeof(os_timer_t));
+    if(timer == NULL)
+        return NULL;
+
+    timer->name = name;
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->period_ns = (uint64_t)period_ms*1000000ULL;
+    timer->periodic = periodic;
+    timer->expiry_ns = 0;
+    timer->index = -1;
+    return timer;
+}
+
+int osTimerStart(osTimer timer)
+{
+    os_timer_t *t = (os_timer_t *)timer;
+    int ok = 1;
+
+    pthread_mutex_lock(&timer_mutex);
+    t->expiry_ns = timer_now_ns() + t->period_ns;
+    if(t->index >= 0)
+        timer_heap_fix(t->index);
+    else
+        ok = timer_heap_insert(t);
+
+    // Wake the timer task only if this is the new first timer
+    if(ok && t->index == 0)
+        pthread_cond_signal(&timer_cond);
+    pthread_mutex_unlock(&timer_mutex);
+
+    if(!ok)
+        printf("[ERROR] Timer %s not started, too many timers\n", t->name);
+    return ok ? pdPASS : 0;
+}
+
+int osTimerStop(osTimer timer)
+{
+    os_timer_t *t = (os_timer_t *)timer;
+
+    pthread_mutex_lock(&timer_mutex);
+    if(t->index >= 0)
+        timer_heap_remove(t);
+    pthread_mutex_unlock(&timer_mutex);
+
+    return pdPASS;
+}
@@ -78,6 +78,11 @@ int os_pthread_queue_send(os_pthread_queue_t *queue, void *value,
 	/* Get queue lock */
 	pthread_mutex_lock(&(queue->mutex));
 	while (queue->items == queue->size) {
+		/* Polling, do not wait for the condition */
+		if (timeout == 0) {
+			pthread_mutex_unlock(&(queue->mutex));
+			return PTHREAD_QUEUE_FULL;
+		}
 		ret = pthread_cond_timedwait(&(queue->cond_full), &(queue->mutex), &ts);
 		if (ret != 0) {
 			pthread_mutex_unlock(&(queue->mutex));
@@ -91,8 +96,8 @@ int os_pthread_queue_send(os_pthread_queue_t *queue, void *value,
 	queue->in = (queue->in + 1) % queue->size;
 	pthread_mutex_unlock(&(queue->mutex));
 	
-	/* Nofify blocked threads */
-	pthread_cond_broadcast(&(queue->cond_empty));
+	/* Nofify one blocked thread, only one can take the new item */
+	pthread_cond_signal(&(queue->cond_empty));
 	
 	return PTHREAD_QUEUE_OK;
 	
@@ -121,6 +126,11 @@ int os_pthread_queue_receive(os_pthread_queue_t *queue, void *buf,
 	/* Get queue lock */
 	pthread_mutex_lock(&(queue->mutex));
 	while (queue->items == 0) {
+		/* Polling, do not wait for the condition */
+		if (timeout == 0) {
+			pthread_mutex_unlock(&(queue->mutex));
+			return PTHREAD_QUEUE_EMPTY;
+		}
 		ret = pthread_cond_timedwait(&(queue->cond_empty), &(queue->mutex), &ts);
 		if (ret != 0) {
 			pthread_mutex_unlock(&(queue->mutex));
@@ -134,10 +144,181 @@ int os_pthread_queue_receive(os_pthread_queue_t *queue, void *buf,
 	queue->out = (queue->out + 1) % queue->size;
 	pthread_mutex_unlock(&(queue->mutex));
 	
-	/* Nofify blocked threads */
-	pthread_cond_broadcast(&(queue->cond_full));
+	/* Nofify one blocked thread, only one can take the free slot */
+	pthread_cond_signal(&(queue->cond_full));
 
 	return PTHREAD_QUEUE_OK;
 	
 }
 
+int os_pthread_queue_send_batch(os_pthread_queue_t *queue, void *values,
+                                int n, uint32_t timeout) {
+
+	int ret, sent = 0;
+
+	/* Calculate timeout */
+	struct timespec ts;
+	if (clock_gettime(CLOCK_REALTIME, &ts))
+		return 0;
+
+	uint32_t sec = timeout / 1000;
+	uint32_t nsec = (timeout - 1000 * sec) * 1000000;
+
+	ts.tv_sec += sec;
+
+	if (ts.tv_nsec + nsec > 1000000000)
+		ts.tv_sec++;
+
+	ts.tv_nsec = (ts.tv_nsec + nsec) % 1000000000;
+
+	/* Get queue lock once for all the items */
+	pthread_mutex_lock(&(queue->mutex));
+	while (sent < n) {
+		while (queue->items == queue->size) {
+			/* Polling, do not wait for the condition */
+			if (timeout == 0) {
+				pthread_mutex_unlock(&(queue->mutex));
+				if (sent > 0)
+					pthread_cond_broadcast(&(queue->cond_empty));
+				return sent;
+			}
+			/* Let receivers drain the items already copied */
+			if (sent > 0)
+				pthread_cond_broadcast(&(queue->cond_empty));
+			ret = pthread_cond_timedwait(&(queue->cond_full), &(queue->mutex), &ts);
+			if (ret != 0) {
+				pthread_mutex_unlock(&(queue->mutex));
+				if (sent > 0)
+					pthread_cond_broadcast(&(queue->cond_empty));
+				return sent;
+			}
+		}
+
+		/* Copy as many objects as fit from the input buffer */
+		while (sent < n && queue->items < queue->size) {
+			memcpy(queue->buffer+(queue->in * queue->item_size),
+			       values+(sent * queue->item_size), queue->item_size);
+			queue->items++;
+			queue->in = (queue->in + 1) % queue->size;
+			sent++;
+		}
+	}
+	pthread_mutex_unlock(&(queue->mutex));
+
+	/* Nofify blocked threads once */
+	pthread_cond_broadcast(&(queue->cond_empty));
+
+	return sent;
+
+}
+
+int os_pthread_queue_receive_batch(os_pthread_queue_t *queue, void *buf,
+                                   int n, uint32_t timeout) {
+
+	int ret, received = 0;
+
+	/* Calculate timeout */
+	struct timespec ts;
+	if (clock_gettime(CLOCK_REALTIME, &ts))
+		return 0;
+
+	uint32_t sec = timeout / 1000;
+	uint32_t nsec = (timeout - 1000 * sec) * 1000000;
+
+	ts.tv_sec += sec;
+
+	if (ts.tv_nsec + nsec > 1000000000)
+		ts.tv_sec++;
+
+	ts.tv_nsec = (ts.tv_nsec + nsec) % 1000000000;
+
+	/* Get queue lock once for all the items, wait for the first one only */
+	pthread_mutex_lock(&(queue->mutex));
+	while (queue->items == 0) {
+		/* Polling, do not wait for the condition */
+		if (timeout == 0) {
+			pthread_mutex_unlock(&(queue->mutex));
+			return 0;
+		}
+		ret = pthread_cond_timedwait(&(queue->cond_empty), &(queue->mutex), &ts);
+		if (ret != 0) {
+			pthread_mutex_unlock(&(queue->mutex));
+			return 0;
+		}
+	}
+
+	/* Copy as many objects as available to the output buffer */
+	while (received < n && queue->items > 0) {
+		memcpy(buf+(received * queue->item_size),
+		       queue->buffer+(queue->out * queue->item_size), queue->item_size);
+		queue->items--;
+		queue->out = (queue->out + 1) % queue->size;
+		received++;
+	}
+	pthread_mutex_unlock(&(queue->mutex));
+
+	/* Nofify blocked threads once */
+	pthread_cond_broadcast(&(queue->cond_full));
+
+	return received;
+
+}
+
+int os_pthread_queue_peek(os_pthread_queue_t *queue, void *buf,
+                          uint32_t timeout) {
+
+	int ret;
+
+	/* Calculate timeout */
+	struct timespec ts;
+	if (clock_gettime(CLOCK_REALTIME, &ts))
+		return PTHREAD_QUEUE_ERROR;
+
+	uint32_t sec = timeout / 1000;
+	uint32_t nsec = (timeout - 1000 * sec) * 1000000;
+
+	ts.tv_sec += sec;
+
+	if (ts.tv_nsec + nsec > 1000000000)
+		ts.tv_sec++;
+
+	ts.tv_nsec = (ts.tv_nsec + nsec) % 1000000000;
+
+	/* Get queue lock */
+	pthread_mutex_lock(&(queue->mutex));
+	while (queue->items == 0) {
+		/* Polling, do not wait for the condition */
+		if (timeout == 0) {
+			pthread_mutex_unlock(&(queue->mutex));
+			return PTHREAD_QUEUE_EMPTY;
+		}
+		ret = pthread_cond_timedwait(&(queue->cond_empty), &(queue->mutex), &ts);
+		if (ret != 0) {
+			pthread_mutex_unlock(&(queue->mutex));
+			return PTHREAD_QUEUE_EMPTY;
+		}
+	}
+
+	/* Coby object to output buffer, the item stays in the queue */
+	memcpy(buf, queue->buffer+(queue->out * queue->item_size), queue->item_size);
+	pthread_mutex_unlock(&(queue->mutex));
+
+	/* The item is still there, pass the notification to a receiver */
+	pthread_cond_signal(&(queue->cond_empty));
+
+	return PTHREAD_QUEUE_OK;
+
+}
+
+int os_pthread_queue_items(os_pthread_queue_t *queue) {
+
+	int items;
+
+	/* Get queue lock */
+	pthread_mutex_lock(&(queue->mutex));
+	items = queue->items;
+	pthread_mutex_unlock(&(queue->mutex));
+
+	return items;
+
+}
@@ -0,0 +1,428 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <errno.h>
+#include <unistd.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "os.h"
+#include "ring_queue.h"
+#include "osThread.h"
+
+#define RING_CELL(queue, pos) ((uint64_t *)((queue)->cells + ((pos) % (queue)->size)*(queue)->cell_size))
+#define RING_CELL_DATA(cell) ((char *)((cell) + 1))
+#ifndef RING_QUEUE_SPIN
+#define RING_QUEUE_SPIN 4
+#endif
+
+/**
+ * Tries to copy an item to the cell at the tail. A cell is free to send if
+ * its sequence is equal to the position, and it is full when the sequence is
+ * the position + 1.
+ */
+static int ring_try_send(os_ring_queue_t *queue, void *value)
+{
+    uint64_t pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+    uint64_t *cell;
+
+    while(1)
+    {
+        cell = RING_CELL(queue, pos);
+        uint64_t seq = __atomic_load_n(cell, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(seq - pos);
+
+        if(diff < 0)
+            return RING_QUEUE_FULL;
+
+        if(diff == 0)
+        {
+            // Only one sender, the tail is not shared
+            if(queue->spsc)
+            {
+                __atomic_store_n(&queue->tail, pos + 1, __ATOMIC_RELAXED);
+                break;
+            }
+            if(__atomic_compare_exchange_n(&queue->tail, &pos, pos + 1, 1,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else
+        {
+            // Another sender took the cell
+            pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(RING_CELL_DATA(cell), value, queue->item_size);
+    __atomic_store_n(cell, pos + 1, __ATOMIC_RELEASE);
+    return RING_QUEUE_OK;
+}
+
+/**
+ * Tries to copy an item from the cell at the head. After the copy the
+ * sequence of the cell is set to be free for the next turn of the ring.
+ */
+static int ring_try_receive(os_ring_queue_t *queue, void *buf)
+{
+    uint64_t pos = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    uint64_t *cell;
+
+    while(1)
+    {
+        cell = RING_CELL(queue, pos);
+        uint64_t seq = __atomic_load_n(cell, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)(seq - (pos + 1));
+
+        if(diff < 0)
+            return RING_QUEUE_EMPTY;
+
+        if(diff == 0)
+        {
+            // Only one receiver, the head is not shared
+            if(queue->spsc)
+            {
+                __atomic_store_n(&queue->head, pos + 1, __ATOMIC_RELAXED);
+                break;
+            }
+            if(__atomic_compare_exchange_n(&queue->head, &pos, pos + 1, 1,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else
+        {
+            // Another receiver took the cell
+            pos = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+        }
+    }
+
+    memcpy(buf, RING_CELL_DATA(cell), queue->item_size);
+    __atomic_store_n(cell, pos + queue->size, __ATOMIC_RELEASE);
+    return RING_QUEUE_OK;
+}
+
+/**
+ * Takes up to @n items from the head with a single compare and swap. Only the
+ * full cells in a row from the head are taken.
+ *
+ * @return Int. Number of items copied to @buf
+ */
+static int ring_try_receive_batch(os_ring_queue_t *queue, void *buf, int n)
+{
+    uint64_t pos = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+    int count, i;
+
+    while(1)
+    {
+        // Count the full cells from the head
+        for(count=0; count<n && count<(int)queue->size; count++)
+        {
+            uint64_t seq = __atomic_load_n(RING_CELL(queue, pos + count), __ATOMIC_ACQUIRE);
+            if(seq != pos + count + 1)
+                break;
+        }
+
+        if(count == 0)
+        {
+            uint64_t seq = __atomic_load_n(RING_CELL(queue, pos), __ATOMIC_ACQUIRE);
+            if((int64_t)(seq - (pos + 1)) < 0)
+                return 0;
+            // Another receiver took the cell
+            pos = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        if(queue->spsc)
+        {
+            __atomic_store_n(&queue->head, pos + count, __ATOMIC_RELAXED);
+            break;
+        }
+        if(__atomic_compare_exchange_n(&queue->head, &pos, pos + count, 1,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            break;
+    }
+
+    for(i=0; i<count; i++)
+    {
+        uint64_t *cell = RING_CELL(queue, pos + i);
+        memcpy((char *)buf + (size_t)i*queue->item_size, RING_CELL_DATA(cell), queue->item_size);
+        __atomic_store_n(cell, pos + i + queue->size, __ATOMIC_RELEASE);
+    }
+    return count;
+}
+
+/**
+ * Batch receive request, so ring_wait can retry ring_try_receive_batch
+ */
+typedef struct ring_batch_s {
+    void *buf;          ///< Buffer for @n items
+    int n;              ///< Max. number of items to take
+    int received;       ///< Number of items taken
+} ring_batch_t;
+
+static int ring_try_receive_batch_op(os_ring_queue_t *queue, void *item)
+{
+    ring_batch_t *batch = (ring_batch_t *)item;
+    batch->received = ring_try_receive_batch(queue, batch->buf, batch->n);
+    return batch->received > 0 ? RING_QUEUE_OK : RING_QUEUE_EMPTY;
+}
+
+/**
+ * Copies the item at the head without taking it. The cell is read again
+ * after the copy to detect if a receiver took it meanwhile.
+ */
+static int ring_try_peek(os_ring_queue_t *queue, void *buf)
+{
+    while(1)
+    {
+        uint64_t pos = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+        uint64_t *cell = RING_CELL(queue, pos);
+        uint64_t seq = __atomic_load_n(cell, __ATOMIC_ACQUIRE);
+
+        if(seq != pos + 1)
+        {
+            if((int64_t)(seq - (pos + 1)) < 0)
+                return RING_QUEUE_EMPTY;
+            continue;
+        }
+
+        memcpy(buf, RING_CELL_DATA(cell), queue->item_size);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if(__atomic_load_n(cell, __ATOMIC_RELAXED) == seq &&
+           __atomic_load_n(&queue->head, __ATOMIC_RELAXED) == pos)
+            return RING_QUEUE_OK;
+    }
+}
+
+/**
+ * Absolute CLOCK_MONOTONIC deadline @timeout milliseconds from now
+ */
+static void ring_deadline(struct timespec *deadline, uint32_t timeout)
+{
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += timeout / 1000;
+    deadline->tv_nsec += (long)(timeout % 1000) * 1000000;
+    if(deadline->tv_nsec >= 1000000000)
+    {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000;
+    }
+}
+
+/**
+ * Sleeps while *@word is @value, until @deadline (NULL to wait forever)
+ *
+ * @return 0 if woken, or the errno value (ETIMEDOUT, EAGAIN, EINTR)
+ */
+static int ring_futex_wait(uint32_t *word, uint32_t value, struct timespec *deadline)
+{
+    if(syscall(SYS_futex, word, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG, value,
+               deadline, NULL, FUTEX_BITSET_MATCH_ANY) == 0)
+        return 0;
+    return errno;
+}
+
+/**
+ * Changes the futex @word and wakes up to @n tasks, only if someone waits
+ */
+static void ring_futex_wake(uint32_t *word, uint32_t *waiters, int n)
+{
+    __atomic_add_fetch(word, 1, __ATOMIC_SEQ_CST);
+    if(__atomic_load_n(waiters, __ATOMIC_SEQ_CST) > 0)
+        syscall(SYS_futex, word, FUTEX_WAKE | FUTEX_PRIVATE_FLAG, n, NULL, NULL, 0);
+}
+
+/**
+ * Waits until @try_op succeeds or the @timeout expires. The waiter is
+ * registered before checking the queue again, so a task that changes the
+ * queue afterwards always sees it and wakes it up.
+ *
+ * @return RING_QUEUE_OK if @try_op succeeded
+ */
+static int ring_wait(os_ring_queue_t *queue, int (*try_op)(os_ring_queue_t *, void *),
+                     void *item, uint32_t *word, uint32_t *waiters,
+                     struct timespec *deadline, uint32_t timeout)
+{
+    int rc, spin;
+
+    if(timeout == 0)
+        return RING_QUEUE_ERROR;
+
+    // The deadline is computed once, and never for portMAX_DELAY
+    if(timeout != portMAX_DELAY && deadline->tv_sec == 0 && deadline->tv_nsec == 0)
+        ring_deadline(deadline, timeout);
+
+    // Give the other side a chance to run before sleeping, the queue is
+    // usually ready again after a short time
+    for(spin=0; spin<RING_QUEUE_SPIN; spin++)
+    {
+        sched_yield();
+        if(try_op(queue, item) == RING_QUEUE_OK)
+            return RING_QUEUE_OK;
+    }
+
+    while(1)
+    {
+        __atomic_add_fetch(waiters, 1, __ATOMIC_SEQ_CST);
+        uint32_t value = __atomic_load_n(word, __ATOMIC_SEQ_CST);
+        if(try_op(queue, item) == RING_QUEUE_OK)
+        {
+            __atomic_sub_fetch(waiters, 1, __ATOMIC_SEQ_CST);
+            return RING_QUEUE_OK;
+        }
+
+        rc = ring_futex_wait(word, value, timeout == portMAX_DELAY ? NULL : deadline);
+        __atomic_sub_fetch(waiters, 1, __ATOMIC_SEQ_CST);
+        if(rc != EAGAIN)
+            osTaskStatsWakeup();
+
+        if(rc == ETIMEDOUT)
+            return try_op(queue, item);
+        if(try_op(queue, item) == RING_QUEUE_OK)
+            return RING_QUEUE_OK;
+    }
+}
+
+os_ring_queue_t * os_ring_queue_create(int length, size_t item_size, int spsc)
+{
+    os_ring_queue_t *queue;
+    size_t cell_size;
+    uint32_t i;
+
+    if(length <= 0 || item_size == 0)
+        return NULL;
+
+    // Sequence number followed by the item, aligned for the next cell
+    cell_size = sizeof(uint64_t) + ((item_size + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1));
+
+    if(posix_memalign((void **)&queue, 64, sizeof(os_ring_queue_t) + (size_t)length*cell_size) != 0)
+        return NULL;
+
+    memset(queue, 0, sizeof(os_ring_queue_t));
+    queue->cells = (char *)(queue + 1);
+    queue->cell_size = cell_size;
+    queue->size = (uint32_t)length;
+    queue->item_size = (uint32_t)item_size;
+    queue->spsc = spsc;
+
+    // Cell i is free for the position i
+    for(i=0; i<queue->size; i++)
+        *RING_CELL(queue, i) = i;
+
+    return queue;
+}
+
+int os_ring_queue_send(os_ring_queue_t *queue, void *value, uint32_t timeout)
+{
+    return os_ring_queue_send_batch(queue, value, 1, timeout) == 1 ? RING_QUEUE_OK : RING_QUEUE_FULL;
+}
+
+int os_ring_queue_receive(os_ring_queue_t *queue, void *buf, uint32_t timeout)
+{
+    struct timespec deadline = {0, 0};
+
+    if(ring_try_receive(queue, buf) != RING_QUEUE_OK &&
+       ring_wait(queue, ring_try_receive, buf, &queue->not_empty,
+                 &queue->recv_waiters, &deadline, timeout) != RING_QUEUE_OK)
+        return RING_QUEUE_EMPTY;
+
+    ring_futex_wake(&queue->not_full, &queue->send_waiters, 1);
+    return RING_QUEUE_OK;
+}
+
+int os_ring_queue_receive_batch(os_ring_queue_t *queue, void *buf, int n, uint32_t timeout)
+{
+    struct timespec deadline = {0, 0};
+    ring_batch_t batch = {buf, n, 0};
+
+    if(n <= 0)
+        return 0;
+
+    // Wait until the queue is not empty, then take all the items at once
+    if(ring_try_receive_batch_op(queue, &batch) != RING_QUEUE_OK &&
+       ring_wait(queue, ring_try_receive_batch_op, &batch, &queue->not_empty,
+                 &queue->recv_waiters, &deadline, timeout) != RING_QUEUE_OK)
+        return 0;
+
+    ring_futex_wake(&queue->not_full, &queue->send_waiters, batch.received);
+    return batch.received;
+}
+
+int os_ring_queue_peek(os_ring_queue_t *queue, void *buf, uint32_t timeout)
+{
+    struct timespec deadline = {0, 0};
+
+    if(ring_try_peek(queue, buf) != RING_QUEUE_OK &&
+       ring_wait(queue, ring_try_peek, buf, &queue->not_empty,
+                 &queue->recv_waiters, &deadline, timeout) != RING_QUEUE_OK)
+        return RING_QUEUE_EMPTY;
+
+    // The item is still there, pass the wake up to a receiver
+    ring_futex_wake(&queue->not_empty, &queue->recv_waiters, 1);
+    return RING_QUEUE_OK;
+}
+
+int os_ring_queue_size(os_ring_queue_t *queue)
+{
+    uint64_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    uint64_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    int64_t items = (int64_t)(tail - head);
+
+    // Positions are read at different times, the result is a snapshot
+    if(items < 0)
+        return 0;
+    if(items > queue->size)
+        return queue->size;
+    return (int)items;
+}
+
+int os_ring_queue_send_batch(os_ring_queue_t *queue, void *values, int n, uint32_t timeout)
+{
+    struct timespec deadline = {0, 0};
+    int sent = 0, notified = 0;
+
+    while(sent < n)
+    {
+        void *value = (char *)values + (size_t)sent*queue->item_size;
+        if(ring_try_send(queue, value) == RING_QUEUE_OK)
+        {
+            sent++;
+            continue;
+        }
+
+        // Let receivers drain the items already sent before waiting
+        if(sent > notified)
+        {
+            ring_futex_wake(&queue->not_empty, &queue->recv_waiters, sent - notified);
+            notified = sent;
+        }
+
+        if(ring_wait(queue, ring_try_send, value, &queue->not_full,
+                     &queue->send_waiters, &deadline, timeout) != RING_QUEUE_OK)
+            break;
+        sent++;
+    }
+
+    // Notify receivers once
+    if(sent > notified)
+        ring_futex_wake(&queue->not_empty, &queue->recv_waiters, sent - notified);
+
+    return sent;
+}
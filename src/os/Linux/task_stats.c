@@ -0,0 +1,190 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "task_stats.h"
+
+/**
+ * Registry record. Counters in @stats are only written by the task itself.
+ */
+typedef struct task_stats_s {
+    osTaskStats stats;          ///< Task statistics
+    pthread_t thread;           ///< Task thread, valid if @started
+    int started;                ///< 1 after the task called os_task_stats_start
+    unsigned char *stack;       ///< Lowest address of the painted stack
+} task_stats_t;
+
+static task_stats_t task_registry[SCH_OS_TASK_MAX_ENTRIES];
+static int task_count = 0;
+static pthread_mutex_t task_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* Record of the calling task, NULL for threads not created by osCreateTask */
+static __thread task_stats_t *task_self = NULL;
+
+static uint64_t task_cpu_us(clockid_t clock)
+{
+    struct timespec ts;
+    if(clock_gettime(clock, &ts) != 0)
+        return 0;
+    return (uint64_t)ts.tv_sec*1000000ULL + (uint64_t)ts.tv_nsec/1000;
+}
+
+int os_task_stats_add(char *name, size_t size, pthread_attr_t *attr)
+{
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t stack_size = size < SCH_OS_TASK_STACK_MIN ? SCH_OS_TASK_STACK_MIN : size;
+    void *mem;
+    int index;
+
+    if(stack_size < (size_t)PTHREAD_STACK_MIN)
+        stack_size = (size_t)PTHREAD_STACK_MIN;
+    stack_size = (stack_size + page - 1)/page*page;
+
+    pthread_mutex_lock(&task_mutex);
+    if(task_count >= SCH_OS_TASK_MAX_ENTRIES)
+    {
+        pthread_mutex_unlock(&task_mutex);
+        return -1;
+    }
+
+    // One guard page below the stack, stacks grow down
+    if(posix_memalign(&mem, page, stack_size + page) != 0)
+    {
+        pthread_mutex_unlock(&task_mutex);
+        return -1;
+    }
+    mprotect(mem, page, PROT_NONE);
+    memset((char *)mem + page, TASK_STATS_PAINT, stack_size);
+
+    if(pthread_attr_setstack(attr, (char *)mem + page, stack_size) != 0)
+    {
+        mprotect(mem, page, PROT_READ | PROT_WRITE);
+        free(mem);
+        pthread_mutex_unlock(&task_mutex);
+        return -1;
+    }
+
+    // Records and stacks are kept after the task ends, the high water mark
+    // of short lived tasks can still be read
+    index = task_count;
+    task_stats_t *task = &task_registry[index];
+    memset(task, 0, sizeof(task_stats_t));
+    strncpy(task->stats.name, name, sizeof(task->stats.name)-1);
+    task->stats.alive = 1;
+    task->stats.stack_size = (uint32_t)stack_size;
+    task->stack = (unsigned char *)mem + page;
+    task_count++;
+    pthread_mutex_unlock(&task_mutex);
+
+    return index;
+}
+
+void os_task_stats_start(int index)
+{
+    if(index < 0 || index >= SCH_OS_TASK_MAX_ENTRIES)
+        return;
+    task_self = &task_registry[index];
+    task_self->thread = pthread_self();
+    __atomic_store_n(&task_self->started, 1, __ATOMIC_RELEASE);
+}
+
+void os_task_stats_end(void)
+{
+    if(task_self == NULL)
+        return;
+    task_self->stats.cpu_us = task_cpu_us(CLOCK_THREAD_CPUTIME_ID);
+    __atomic_store_n(&task_self->stats.alive, 0, __ATOMIC_RELEASE);
+}
+
+int osTaskGetStats(int index, osTaskStats *stats)
+{
+    task_stats_t *task;
+    clockid_t clock;
+    uint32_t unused = 0;
+
+    pthread_mutex_lock(&task_mutex);
+    int count = task_count;
+    pthread_mutex_unlock(&task_mutex);
+    if(index < 0 || index >= count || stats == NULL)
+        return 0;
+
+    task = &task_registry[index];
+    *stats = task->stats;
+
+    // CPU time of running tasks is read from their thread CPU clock
+    if(__atomic_load_n(&task->stats.alive, __ATOMIC_ACQUIRE) &&
+       __atomic_load_n(&task->started, __ATOMIC_ACQUIRE) &&
+       pthread_getcpuclockid(task->thread, &clock) == 0)
+    {
+        uint64_t cpu_us = task_cpu_us(clock);
+        if(cpu_us != 0)
+            stats->cpu_us = cpu_us;
+    }
+
+    // The stack grows down, count the painted bytes from the bottom
+    while(unused < task->stats.stack_size && task->stack[unused] == TASK_STATS_PAINT)
+        unused++;
+    stats->stack_used = task->stats.stack_size - unused;
+
+    return 1;
+}
+
+void osTaskResetStats(void)
+{
+    int i;
+    pthread_mutex_lock(&task_mutex);
+    for(i=0; i<task_count; i++)
+    {
+        osTaskStats *stats = &task_registry[i].stats;
+        stats->wakeups = 0;
+        stats->latency_count = 0;
+        stats->latency_total_us = 0;
+        stats->latency_max_us = 0;
+        stats->overruns = 0;
+    }
+    pthread_mutex_unlock(&task_mutex);
+}
+
+void osTaskStatsWakeup(void)
+{
+    if(task_self != NULL)
+        task_self->stats.wakeups++;
+}
+
+void osTaskStatsLatency(uint32_t latency_us)
+{
+    if(task_self == NULL)
+        return;
+    task_self->stats.latency_count++;
+    task_self->stats.latency_total_us += latency_us;
+    if(latency_us > task_self->stats.latency_max_us)
+        task_self->stats.latency_max_us = latency_us;
+}
+
+void osTaskStatsOverrun(void)
+{
+    if(task_self != NULL)
+        task_self->stats.overruns++;
+}
@@ -0,0 +1,68 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "osDelay.h"
+#include "osSim.h"
+#include "osThread.h"
+
+portTick osDefineTime(uint32_t mseconds)
+{
+    //use time
+    return (portTick)mseconds*1000;
+}
+
+portTick osTaskGetTickCount(void)
+{
+    //virtual time in microseconds
+    return (portTick)(osSimGetNs()/1000);
+}
+
+void osDelay(uint32_t mseconds)
+{
+    osSimLock();
+    osSimWait(NULL, osSimDeadline(mseconds));
+    osSimUnlock();
+    // Tasks always wake up on time in virtual time
+    osTaskStatsWakeup();
+    osTaskStatsLatency(0);
+}
+
+void osTaskDelayUntil(portTick *lastTime, uint32_t mseconds)
+{
+    portTick s_usec = osDefineTime(mseconds);   // Sleep ticks
+    portTick d_usec;                            // Delta ticks
+
+    // Same as Linux, the next period starts when this one should end
+    osSimLock();
+    d_usec = (portTick)(osSimDeadline(0)/1000) - *lastTime;
+    *lastTime += s_usec;
+    if(d_usec < s_usec)
+        osSimWait(NULL, osSimDeadline(0) + (uint64_t)(s_usec - d_usec)*1000);
+    osSimUnlock();
+
+    if(d_usec >= s_usec)
+    {
+        osTaskStatsOverrun();
+    }
+    else
+    {
+        osTaskStatsWakeup();
+        osTaskStatsLatency(0);
+    }
+}
@@ -0,0 +1,108 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "osEvent.h"
+#include "osSim.h"
+#include "osThread.h"
+
+/**
+ * Simulator event, protected by the virtual clock lock. Setting bits wakes
+ * up all the waiting tasks before the clock can advance.
+ */
+typedef struct os_sim_event_s {
+    uint32_t bits;              ///< Event bits
+    os_sim_waiter_t *waiters;   ///< Tasks waiting for bits
+} os_sim_event_t;
+
+static inline int sim_event_ready(os_sim_event_t *e, uint32_t bits, int wait_all)
+{
+    return wait_all ? (e->bits & bits) == bits : (e->bits & bits) != 0;
+}
+
+osEvent osEventCreate(void)
+{
+    os_sim_event_t *e = malloc(sizeof(os_sim_event_t));
+    if(e == NULL)
+        return NULL;
+
+    e->bits = 0;
+    e->waiters = NULL;
+    return e;
+}
+
+uint32_t osEventSet(osEvent event, uint32_t bits)
+{
+    os_sim_event_t *e = (os_sim_event_t *)event;
+    uint32_t value;
+
+    osSimLock();
+    e->bits |= bits & OS_EVENT_ALL_BITS;
+    value = e->bits;
+    while(osSimWakeOne(&e->waiters));
+    osSimUnlock();
+    return value;
+}
+
+uint32_t osEventClear(osEvent event, uint32_t bits)
+{
+    os_sim_event_t *e = (os_sim_event_t *)event;
+    uint32_t value;
+
+    osSimLock();
+    value = e->bits;
+    e->bits &= ~bits;
+    osSimUnlock();
+    return value;
+}
+
+uint32_t osEventGet(osEvent event)
+{
+    os_sim_event_t *e = (os_sim_event_t *)event;
+    uint32_t value;
+
+    osSimLock();
+    value = e->bits;
+    osSimUnlock();
+    return value;
+}
+
+uint32_t osEventWait(osEvent event, uint32_t bits, int wait_all, int clear, uint32_t timeout)
+{
+    os_sim_event_t *e = (os_sim_event_t *)event;
+    uint64_t deadline = 0;
+    uint32_t value;
+    int rc = OS_SIM_WOKEN;
+
+    osSimLock();
+    while(!sim_event_ready(e, bits, wait_all) && timeout != 0 && rc == OS_SIM_WOKEN)
+    {
+        if(deadline == 0)
+            deadline = osSimDeadline(timeout);
+        rc = osSimWait(&e->waiters, deadline);
+        osTaskStatsWakeup();
+    }
+
+    value = e->bits;
+    if(clear && sim_event_ready(e, bits, wait_all))
+        e->bits &= ~bits;
+    osSimUnlock();
+    return value;
+}
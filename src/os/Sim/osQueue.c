@@ -0,0 +1,163 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "osQueue.h"
+#include "osSim.h"
+#include "osThread.h"
+
+/**
+ * Simulator queue. All the queues share the virtual clock lock, so a task
+ * that sends an item wakes up a receiver before the clock can advance.
+ */
+typedef struct os_sim_queue_s {
+    char *buffer;               ///< Items buffer
+    int size;                   ///< Max. number of items
+    int item_size;              ///< Size of an item in bytes
+    int items;                  ///< Number of items in the queue
+    int in;                     ///< Next position to send
+    int out;                    ///< Next position to receive
+    os_sim_waiter_t *senders;   ///< Tasks waiting for space
+    os_sim_waiter_t *receivers; ///< Tasks waiting for items
+} os_sim_queue_t;
+
+/**
+ * Waits until the queue has an item (@full = 0) or a free slot (@full = 1).
+ * Called with the lock taken.
+ *
+ * @return 1 if the condition is met, 0 if the timeout expired
+ */
+static int sim_queue_wait(os_sim_queue_t *q, int full, uint64_t *deadline, uint32_t timeout)
+{
+    while(full ? q->items == q->size : q->items == 0)
+    {
+        if(timeout == 0)
+            return 0;
+        if(*deadline == 0)
+            *deadline = osSimDeadline(timeout);
+        int rc = osSimWait(full ? &q->senders : &q->receivers, *deadline);
+        osTaskStatsWakeup();
+        if(rc == OS_SIM_TIMEOUT && (full ? q->items == q->size : q->items == 0))
+            return 0;
+    }
+    return 1;
+}
+
+osQueue osQueueCreate(int length, size_t item_size)
+{
+    os_sim_queue_t *q = malloc(sizeof(os_sim_queue_t));
+    if(q == NULL)
+        return NULL;
+
+    q->buffer = malloc(length*item_size);
+    if(q->buffer == NULL)
+    {
+        free(q);
+        return NULL;
+    }
+    q->size = length;
+    q->item_size = (int)item_size;
+    q->items = 0;
+    q->in = 0;
+    q->out = 0;
+    q->senders = NULL;
+    q->receivers = NULL;
+    return q;
+}
+
+int osQueueSend(osQueue queue, void *value, uint32_t timeout)
+{
+    return osQueueSendBatch(queue, value, 1, timeout) == 1 ? pdPASS : 0;
+}
+
+int osQueueReceive(osQueue queue, void *buf, uint32_t timeout)
+{
+    return osQueueReceiveBatch(queue, buf, 1, timeout) == 1 ? pdPASS : 0;
+}
+
+int osQueueSendBatch(osQueue queue, void *values, int n, uint32_t timeout)
+{
+    os_sim_queue_t *q = (os_sim_queue_t *)queue;
+    uint64_t deadline = 0;
+    int sent = 0;
+
+    osSimLock();
+    while(sent < n && sim_queue_wait(q, 1, &deadline, timeout))
+    {
+        memcpy(q->buffer + q->in*q->item_size, (char *)values + sent*q->item_size, q->item_size);
+        q->in = (q->in + 1) % q->size;
+        q->items++;
+        sent++;
+        osSimWakeOne(&q->receivers);
+    }
+    osSimUnlock();
+
+    return sent;
+}
+
+int osQueueReceiveBatch(osQueue queue, void *buf, int n, uint32_t timeout)
+{
+    os_sim_queue_t *q = (os_sim_queue_t *)queue;
+    uint64_t deadline = 0;
+    int received = 0;
+
+    osSimLock();
+    // Wait for the first item only
+    if(n > 0 && sim_queue_wait(q, 0, &deadline, timeout))
+    {
+        while(received < n && q->items > 0)
+        {
+            memcpy((char *)buf + received*q->item_size, q->buffer + q->out*q->item_size, q->item_size);
+            q->out = (q->out + 1) % q->size;
+            q->items--;
+            received++;
+            osSimWakeOne(&q->senders);
+        }
+    }
+    osSimUnlock();
+
+    return received;
+}
+
+int osQueueSize(osQueue queue)
+{
+    int items;
+    osSimLock();
+    items = ((os_sim_queue_t *)queue)->items;
+    osSimUnlock();
+    return items;
+}
+
+int osQueuePeek(osQueue queue, void *buf, uint32_t timeout)
+{
+    os_sim_queue_t *q = (os_sim_queue_t *)queue;
+    uint64_t deadline = 0;
+    int ok;
+
+    osSimLock();
+    ok = sim_queue_wait(q, 0, &deadline, timeout);
+    if(ok)
+    {
+        memcpy(buf, q->buffer + q->out*q->item_size, q->item_size);
+        // The item is still there, pass the wake up to a receiver
+        osSimWakeOne(&q->receivers);
+    }
+    osSimUnlock();
+
+    return ok ? pdPASS : 0;
+}
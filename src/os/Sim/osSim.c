@@ -0,0 +1,241 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include "osSim.h"
+
+static pthread_mutex_t sim_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t sim_now = 0;            // Virtual time in ns, 0 until first used
+static int sim_tasks = 0;               // Tasks running or blocked
+static int sim_blocked = 0;             // Tasks blocked in osSimWait
+static os_sim_waiter_t *sim_timed = NULL; // Waiters with a deadline
+
+/**
+ * The virtual clock starts at the host time, unless set by osSimSetTime
+ */
+static void sim_clock_init(void)
+{
+    if(sim_now == 0)
+    {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        sim_now = (uint64_t)now.tv_sec*1000000000ULL + (uint64_t)now.tv_nsec;
+    }
+}
+
+/**
+ * Removes @w from its wait list and from the deadlines list
+ */
+static void sim_waiter_remove(os_sim_waiter_t *w)
+{
+    os_sim_waiter_t **p;
+
+    if(w->list != NULL)
+    {
+        for(p = w->list; *p != NULL; p = &(*p)->next)
+        {
+            if(*p == w)
+            {
+                *p = w->next;
+                break;
+            }
+        }
+        w->list = NULL;
+    }
+
+    if(w->deadline != OS_SIM_NO_DEADLINE)
+    {
+        for(p = &sim_timed; *p != NULL; p = &(*p)->timed_next)
+        {
+            if(*p == w)
+            {
+                *p = w->timed_next;
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * Wakes a blocked task. The waker counts it as running, so the virtual clock
+ * can not advance before the task actually runs.
+ */
+static void sim_waiter_wake(os_sim_waiter_t *w, int reason)
+{
+    sim_waiter_remove(w);
+    w->woken = reason;
+    sim_blocked--;
+    pthread_cond_signal(&w->cond);
+}
+
+/**
+ * Wakes up the tasks due at the current virtual time
+ */
+static void sim_wake_due(void)
+{
+    os_sim_waiter_t *w = sim_timed;
+    while(w != NULL)
+    {
+        os_sim_waiter_t *next = w->timed_next;
+        if(w->deadline <= sim_now)
+            sim_waiter_wake(w, OS_SIM_TIMEOUT);
+        w = next;
+    }
+}
+
+/**
+ * If all the tasks are blocked, jumps to the earliest deadline
+ */
+static void sim_advance_if_idle(void)
+{
+    os_sim_waiter_t *w;
+    uint64_t next = OS_SIM_NO_DEADLINE;
+
+    if(sim_tasks == 0 || sim_blocked < sim_tasks)
+        return;
+
+    for(w = sim_timed; w != NULL; w = w->timed_next)
+    {
+        if(w->deadline < next)
+            next = w->deadline;
+    }
+
+    // All tasks wait for each other
+    if(next == OS_SIM_NO_DEADLINE)
+    {
+        printf("[WARN] All tasks are blocked without timeout, virtual clock stopped\n");
+        return;
+    }
+
+    if(next > sim_now)
+        sim_now = next;
+    sim_wake_due();
+}
+
+void osSimLock(void)
+{
+    pthread_mutex_lock(&sim_lock);
+}
+
+void osSimUnlock(void)
+{
+    pthread_mutex_unlock(&sim_lock);
+}
+
+void osSimSetTime(time_t unix_time)
+{
+    osSimLock();
+    sim_now = (uint64_t)unix_time*1000000000ULL;
+    sim_wake_due();
+    osSimUnlock();
+}
+
+time_t osSimGetTime(void)
+{
+    return (time_t)(osSimGetNs()/1000000000ULL);
+}
+
+uint64_t osSimGetNs(void)
+{
+    uint64_t now;
+    osSimLock();
+    sim_clock_init();
+    now = sim_now;
+    osSimUnlock();
+    return now;
+}
+
+void osSimAdvance(uint32_t mseconds)
+{
+    osSimLock();
+    sim_clock_init();
+    sim_now += (uint64_t)mseconds*1000000ULL;
+    sim_wake_due();
+    osSimUnlock();
+}
+
+int osSimWait(os_sim_waiter_t **list, uint64_t deadline)
+{
+    os_sim_waiter_t w;
+
+    sim_clock_init();
+    if(deadline <= sim_now)
+        return OS_SIM_TIMEOUT;
+
+    pthread_cond_init(&w.cond, NULL);
+    w.deadline = deadline;
+    w.woken = 0;
+    w.list = list;
+    w.next = NULL;
+    w.timed_next = NULL;
+
+    // Append to the wait list, tasks are woken in order
+    if(list != NULL)
+    {
+        os_sim_waiter_t **p = list;
+        while(*p != NULL)
+            p = &(*p)->next;
+        *p = &w;
+    }
+    if(deadline != OS_SIM_NO_DEADLINE)
+    {
+        w.timed_next = sim_timed;
+        sim_timed = &w;
+    }
+
+    sim_blocked++;
+    sim_advance_if_idle();
+    while(!w.woken)
+        pthread_cond_wait(&w.cond, &sim_lock);
+
+    pthread_cond_destroy(&w.cond);
+    return w.woken;
+}
+
+int osSimWakeOne(os_sim_waiter_t **list)
+{
+    if(*list == NULL)
+        return 0;
+    sim_waiter_wake(*list, OS_SIM_WOKEN);
+    return 1;
+}
+
+uint64_t osSimDeadline(uint32_t mseconds)
+{
+    if(mseconds == portMAX_DELAY)
+        return OS_SIM_NO_DEADLINE;
+    sim_clock_init();
+    return sim_now + (uint64_t)mseconds*1000000ULL;
+}
+
+void osSimTaskAdd(void)
+{
+    osSimLock();
+    sim_tasks++;
+    osSimUnlock();
+}
+
+void osSimTaskRemove(void)
+{
+    osSimLock();
+    sim_tasks--;
+    sim_advance_if_idle();
+    osSimUnlock();
+}
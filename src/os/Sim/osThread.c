@@ -0,0 +1,116 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "osThread.h"
+#include "osSim.h"
+#include "task_stats.h"
+
+/**
+ * Task start parameters
+ */
+typedef struct os_sim_task_s {
+    void (*function)(void *);   ///< Task function
+    void *parameters;           ///< Task function parameters
+    int index;                  ///< Task index in the registry
+} os_sim_task_t;
+
+static void sim_task_end(void *arg)
+{
+    os_task_stats_end();
+    osSimTaskRemove();
+}
+
+/**
+ * Runs the task function, the task is unregistered from the virtual clock
+ * when the function returns or the task is deleted
+ */
+static void *sim_task(void *arg)
+{
+    os_sim_task_t task = *(os_sim_task_t *)arg;
+    free(arg);
+
+    os_task_stats_start(task.index);
+    pthread_cleanup_push(sim_task_end, NULL);
+    task.function(task.parameters);
+    pthread_cleanup_pop(1);
+    return NULL;
+}
+
+/**
+ * Create a task in the simulator as thread. Priorities are not used, the
+ * virtual clock decides when the tasks run.
+ */
+int osCreateTask(void (*functionTask)(void *), char* name, unsigned short size, void * parameters, unsigned int priority, os_thread* thread){
+
+    pthread_attr_t attr;
+    os_sim_task_t *task = malloc(sizeof(os_sim_task_t));
+    if(task == NULL)
+        return 1;
+    task->function = functionTask;
+    task->parameters = parameters;
+
+    // Same task registry as Linux, CPU time and stack are real, latencies are
+    // measured in virtual time
+    pthread_attr_init(&attr);
+    task->index = os_task_stats_add(name, size, &attr);
+    if(task->index < 0)
+        pthread_attr_setstacksize(&attr, SCH_OS_TASK_STACK_MIN);
+
+    // Registered before it starts, so the clock waits for the new task
+    osSimTaskAdd();
+    int created = pthread_create(thread , &attr , sim_task, task);
+    if(created != 0)
+    {
+        osSimTaskRemove();
+        free(task);
+    }
+    else
+    {
+        pthread_setname_np(*thread, name);
+    }
+
+    pthread_attr_destroy(&attr);
+
+    return created;
+}
+
+/**
+ * Tasks run one at a time in virtual time, CPU affinity is not used
+ */
+int osCreateTaskAffinity(void (*functionTask)(void *), char* name, unsigned short size, void * parameters, unsigned int priority, int cpu, os_thread* thread){
+    return osCreateTask(functionTask, name, size, parameters, priority, thread);
+}
+
+/**
+ * Only the calling task (NULL) can be deleted in the simulator
+ */
+void osTaskDelete(void *task_handle)
+{
+    if(task_handle == NULL)
+        pthread_exit(NULL);
+    printf("[WARN] Only the calling task can be deleted in SIM\n");
+}
+
+/**
+ * Tasks run one at a time in virtual time, CPU affinity is not used
+ */
+int osTaskSetAffinity(os_thread *thread, int cpu)
+{
+    return 0;
+}
@@ -0,0 +1,160 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "osTimer.h"
+#include "osThread.h"
+#include "osSim.h"
+
+/**
+ * Simulator timer, expiration times use the virtual clock
+ */
+typedef struct os_sim_timer_s {
+    char *name;                 ///< Timer name
+    osTimerCallback callback;   ///< Function called when the timer expires
+    void *arg;                  ///< Callback argument
+    uint64_t period_ns;         ///< Timer period in nanoseconds
+    int periodic;               ///< 1 if the timer is rescheduled after expiring
+    int active;                 ///< 1 if the timer is running
+    uint64_t expiry_ns;         ///< Next expiration, virtual time
+} os_sim_timer_t;
+
+static os_sim_timer_t *timer_list[SCH_OS_TIMER_MAX_ENTRIES];
+static int timer_count = 0;
+static os_sim_waiter_t *timer_waiter = NULL;
+static os_thread timer_thread;
+
+/**
+ * First running timer to expire. Called with the lock taken.
+ */
+static os_sim_timer_t *sim_timer_next(void)
+{
+    os_sim_timer_t *next = NULL;
+    int i;
+    for(i=0; i<timer_count; i++)
+    {
+        if(timer_list[i]->active && (next == NULL || timer_list[i]->expiry_ns < next->expiry_ns))
+            next = timer_list[i];
+    }
+    return next;
+}
+
+/**
+ * Timer task, a simulator task that waits until the first timer expires
+ */
+static void sim_timer_task(void *param)
+{
+    os_sim_timer_t *timer;
+    uint64_t now;
+
+    osSimLock();
+    while(1)
+    {
+        timer = sim_timer_next();
+        if(timer == NULL)
+        {
+            osSimWait(&timer_waiter, OS_SIM_NO_DEADLINE);
+            continue;
+        }
+
+        now = osSimDeadline(0);
+        if(timer->expiry_ns > now)
+        {
+            osSimWait(&timer_waiter, timer->expiry_ns);
+            continue;
+        }
+
+        // Latency and overruns in virtual time, only if the timer task was
+        // delayed by a long callback
+        osTaskStatsWakeup();
+        osTaskStatsLatency((uint32_t)((now - timer->expiry_ns)/1000));
+        if(timer->periodic && now - timer->expiry_ns >= timer->period_ns)
+            osTaskStatsOverrun();
+
+        // Same as Linux, reschedule from the expiration time
+        if(timer->periodic)
+            timer->expiry_ns += ((now - timer->expiry_ns)/timer->period_ns + 1)*timer->period_ns;
+        else
+            timer->active = 0;
+
+        osSimUnlock();
+        timer->callback(timer->arg);
+        osSimLock();
+    }
+}
+
+osTimer osTimerCreate(char *name, uint32_t period_ms, int periodic, osTimerCallback callback, void *arg)
+{
+    os_sim_timer_t *timer;
+    int start_task;
+
+    if(period_ms == 0 || callback == NULL)
+        return NULL;
+
+    timer = (os_sim_timer_t *)malloc(sizeof(os_sim_timer_t));
+    if(timer == NULL)
+        return NULL;
+
+    timer->name = name;
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->period_ns = (uint64_t)period_ms*1000000ULL;
+    timer->periodic = periodic;
+    timer->active = 0;
+    timer->expiry_ns = 0;
+
+    osSimLock();
+    if(timer_count >= SCH_OS_TIMER_MAX_ENTRIES)
+    {
+        osSimUnlock();
+        printf("[ERROR] Timer %s not created, too many timers\n", name);
+        free(timer);
+        return NULL;
+    }
+    timer_list[timer_count++] = timer;
+    start_task = timer_count == 1;
+    osSimUnlock();
+
+    // The timer task is started with the first timer
+    if(start_task && osCreateTask(sim_timer_task, "timer", SCH_TASK_DEF_STACK, NULL, 2, &timer_thread) != 0)
+        printf("[ERROR] Failed to create the timer task\n");
+
+    return timer;
+}
+
+int osTimerStart(osTimer timer)
+{
+    os_sim_timer_t *t = (os_sim_timer_t *)timer;
+
+    osSimLock();
+    t->expiry_ns = osSimDeadline(0) + t->period_ns;
+    t->active = 1;
+    osSimWakeOne(&timer_waiter);
+    osSimUnlock();
+
+    return pdPASS;
+}
+
+int osTimerStop(osTimer timer)
+{
+    osSimLock();
+    ((os_sim_timer_t *)timer)->active = 0;
+    osSimUnlock();
+
+    return pdPASS;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file  osEvent.h
+ * @author Carlos Gonzalez Cortes
+ * @date 2018
+ * @copyright GNU Public License.
+ *
+ * Event flags for operating systems Linux and FreeRTOS. An event is a set of
+ * bits, tasks block until some (wait any) or all (wait all) of the bits they
+ * are interested in are set by other tasks, so they do not need to poll.
+ *
+ * In GNU/Linux events use a mutex and a condition variable (monotonic clock).
+ * In FreeRTOS they are event groups (FreeRTOS 8 or later), older kernels use
+ * a counting semaphore to wake up the waiting tasks. Only the lower 24 bits
+ * (OS_EVENT_ALL_BITS) can be used.
+ */
+
+#ifndef _OS_EVENT_H_
+#define _OS_EVENT_H_
+
+#include "os.h"
+#include "stdint.h"
+
+typedef void* osEvent;
+
+#define OS_EVENT_ALL_BITS 0x00FFFFFF   ///< Bits available in an event
+
+/**
+ * Create a new event with all the bits cleared
+ *
+ * @return osEvent. The new event or NULL in case of errors
+ */
+osEvent osEventCreate(void);
+
+/**
+ * Set bits of an event and wake up the tasks waiting for them
+ *
+ * @param event osEvent. The event
+ * @param bits uint32_t. Bits to set
+ * @return uint32_t. Event bits after setting @bits
+ */
+uint32_t osEventSet(osEvent event, uint32_t bits);
+
+/**
+ * Clear bits of an event
+ *
+ * @param event osEvent. The event
+ * @param bits uint32_t. Bits to clear
+ * @return uint32_t. Event bits before clearing @bits
+ */
+uint32_t osEventClear(osEvent event, uint32_t bits);
+
+/**
+ * Current bits of an event, does not block
+ *
+ * @param event osEvent. The event
+ * @return uint32_t. Event bits
+ */
+uint32_t osEventGet(osEvent event);
+
+/**
+ * Wait until any (@wait_all = 0) or all (@wait_all = 1) of @bits are set, or
+ * until the @timeout (ms) expires. Use portMAX_DELAY to wait forever and 0 to
+ * only test the bits.
+ *
+ * @code
+ *      uint32_t bits = osEventWait(event, EV_A | EV_B, 0, 1, 1000);
+ *      if(bits & EV_A)
+ *          ...
+ * @endcode
+ *
+ * @param event osEvent. The event
+ * @param bits uint32_t. Bits to wait for
+ * @param wait_all Int. 1 to wait for all the @bits, 0 to wait for any of them
+ * @param clear Int. 1 to clear @bits when the condition is met
+ * @param timeout uint32_t. Max. time to wait in milliseconds
+ * @return uint32_t. Event bits when the condition was met (before clearing),
+ * or when the timeout expired
+ */
+uint32_t osEventWait(osEvent event, uint32_t bits, int wait_all, int clear, uint32_t timeout);
+
+#endif //_OS_EVENT_H_
@@ -0,0 +1,86 @@
+/**
+ * @file  osPool.h
+ * @author Carlos Gonzalez Cortes
+ * @date 2018
+ * @copyright GNU Public License.
+ *
+ * Fixed size memory pools. A pool pre-allocates @length blocks of @block_size
+ * bytes at creation, then blocks are allocated and released in constant time
+ * without using the heap, avoiding fragmentation.
+ */
+
+#ifndef _OS_POOL_H_
+#define _OS_POOL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+#include "os.h"
+
+#ifdef LINUX
+    #include <pthread.h>
+#else
+    #include "FreeRTOS.h"
+    #include "task.h"
+#endif
+
+typedef void* osPool;
+
+/**
+ * Pool allocation statistics
+ */
+typedef struct os_pool_stats{
+    uint32_t capacity;      ///< Number of blocks in the pool
+    uint32_t block_size;    ///< Size of each block in bytes
+    uint32_t used;          ///< Blocks currently allocated
+    uint32_t peak;          ///< Max. number of blocks allocated at the same time
+    uint32_t allocs;        ///< Number of successful allocations
+    uint32_t fails;         ///< Number of allocations failed because the pool was exhausted
+} osPoolStats;
+
+/**
+ * Creates a new pool of @length blocks of @block_size bytes each
+ *
+ * @param length Int. Number of blocks
+ * @param block_size Size_t. Size of each block in bytes
+ * @return osPool. The new pool or NULL in case of errors
+ */
+osPool osPoolCreate(int length, size_t block_size);
+
+/**
+ * Allocates a block from the pool
+ *
+ * @param pool osPool. The pool
+ * @return Pointer to a block of at least block_size bytes, or NULL if the
+ * pool is exhausted
+ */
+void *osPoolAlloc(osPool pool);
+
+/**
+ * Returns a block to the pool
+ *
+ * @param pool osPool. The pool
+ * @param block Pointer to a block allocated with @osPoolAlloc
+ * @return pdPASS if the block was released, 0 if the block does not belong to
+ * the pool
+ */
+int osPoolFree(osPool pool, void *block);
+
+/**
+ * Checks if a pointer is a block of the pool
+ *
+ * @param pool osPool. The pool
+ * @param block Pointer to check
+ * @return 1 if @block belongs to @pool, 0 otherwise
+ */
+int osPoolOwns(osPool pool, void *block);
+
+/**
+ * Gets the pool allocation statistics
+ *
+ * @param pool osPool. The pool
+ * @param stats osPoolStats *. Structure to store the statistics
+ */
+void osPoolGetStats(osPool pool, osPoolStats *stats);
+
+#endif //_OS_POOL_H_
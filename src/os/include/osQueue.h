@@ -13,7 +13,7 @@
 #include "config.h"
 
 #ifdef LINUX
-	#include "pthread_queue.h"
+	#include "ring_queue.h"
 #else
     #include "FreeRTOS.h"
     #include "queue.h"
@@ -24,12 +24,56 @@ typedef void* osQueue;
 osQueue osQueueCreate(int length, size_t item_size);
 int osQueueSend(osQueue queues, void *value, uint32_t timeout);
 int osQueueReceive(osQueue queue, void *buf, uint32_t timeout);
+
+/**
+ * Sends @n items to the queue at once. Receivers are notified once instead of
+ * once per item. If the queue is full, waits until there is space for the
+ * remaining items or the @timeout (ms) expires.
+ *
+ * @param queue osQueue. The queue
+ * @param values Pointer to an array of @n items of the queue item size
+ * @param n Int. Number of items to send
+ * @param timeout Max time to wait for space in the queue, in ms
+ * @return Int. Number of items sent, @n if all items were sent
+ */
+int osQueueSendBatch(osQueue queue, void *values, int n, uint32_t timeout);
+
+/**
+ * Receives up to @n items from the queue at once. Waits up to @timeout (ms)
+ * only for the first item, then takes the items already in the queue. Senders
+ * are notified once instead of once per item.
+ *
+ * @param queue osQueue. The queue
+ * @param buf Pointer to an array of @n items of the queue item size
+ * @param n Int. Max. number of items to receive
+ * @param timeout Max time to wait for the first item, in ms
+ * @return Int. Number of items received, 0 if the queue was empty
+ */
+int osQueueReceiveBatch(osQueue queue, void *buf, int n, uint32_t timeout);
+
+/**
+ * Number of items waiting in the queue. Does not block, the value is only a
+ * snapshot if other tasks are using the queue.
+ *
+ * @param queue osQueue. The queue
+ * @return Int. Number of items in the queue
+ */
+int osQueueSize(osQueue queue);
+
+/**
+ * Copies the next item of the queue without removing it. Waits up to
+ * @timeout (ms) if the queue is empty.
+ *
+ * @param queue osQueue. The queue
+ * @param buf Pointer to store one item of the queue item size
+ * @param timeout Max time to wait for an item, in ms
+ * @return pdPASS if an item was copied
+ */
+int osQueuePeek(osQueue queue, void *buf, uint32_t timeout);
+
 //void os_queue_remove(csp_queue_handle_t queue);
-//int os_queue_enqueue(csp_queue_handle_t handle, void *value, uint32_t timeout);
 //int os_queue_enqueue_isr(csp_queue_handle_t handle, void * value, CSP_BASE_TYPE * task_woken);
-//int os_queue_dequeue(csp_queue_handle_t handle, void *buf, uint32_t timeout);
 //int os_queue_dequeue_isr(csp_queue_handle_t handle, void * buf, CSP_BASE_TYPE * task_woken);
-//int os_queue_size(csp_queue_handle_t handle);
 //int os_queue_size_isr(csp_queue_handle_t handle);
 
 #endif
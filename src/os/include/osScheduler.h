@@ -27,4 +27,18 @@
 
 void osScheduler(os_thread* threads_id, int n_threads);
 
+/**
+ * Enables the real-time mode (SCH_OS_RT_MODE) of the process. Call after
+ * creating the queues and pools and before creating the tasks.
+ *
+ * In GNU/Linux it locks the current and future memory pages (mlockall), which
+ * also pre-faults the pools, keeps freed heap memory in the process, uses a
+ * single heap arena for all threads and pre-faults SCH_OS_RT_HEAP_RESERVE
+ * bytes of heap. Task stacks are pre-faulted by osCreateTask. Requires root
+ * or a large enough RLIMIT_MEMLOCK. In FreeRTOS it does nothing.
+ *
+ * @return 0 on success, -1 if the memory could not be locked
+ */
+int osSchedulerRealTime(void);
+
 #endif
@@ -15,7 +15,21 @@
 #ifdef LINUX
 	#include <pthread.h>
 	#include <stdint.h>
-	typedef pthread_mutex_t osSemaphore;
+
+	/**
+	 * Linux mutex and its wait time statistics, counters are updated with
+	 * the mutex taken
+	 */
+	typedef struct os_semaphore_s {
+		pthread_mutex_t mutex;
+		uint32_t takes;             ///< Successful takes
+		uint32_t contended;         ///< Takes that had to wait
+		uint32_t wait_max_us;       ///< Max. wait time (us)
+		uint64_t wait_total_us;     ///< Sum of the wait times (us)
+	#if SCH_OS_LOCK_PROFILE
+		struct os_lock_profile_s *profile;  ///< Profiler record, NULL if not named
+	#endif
+	} osSemaphore;
 
 	#define CSP_SEMAPHORE_OK 	1
 	#define CSP_SEMAPHORE_ERROR 2
@@ -25,7 +39,20 @@
 	#include "FreeRTOS.h"
 	#include "queue.h"
 	#include "semphr.h"
-	typedef xSemaphoreHandle osSemaphore;
+
+	/**
+	 * FreeRTOS mutex and its wait time statistics
+	 */
+	typedef struct os_semaphore_s {
+		xSemaphoreHandle handle;
+		uint32_t takes;             ///< Successful takes
+		uint32_t contended;         ///< Takes that had to wait
+		uint32_t wait_max_us;       ///< Max. wait time (us), tick resolution
+		uint64_t wait_total_us;     ///< Sum of the wait times (us)
+	#if SCH_OS_LOCK_PROFILE
+		struct os_lock_profile_s *profile;  ///< Profiler record, NULL if not named
+	#endif
+	} osSemaphore;
 
 	#define CSP_SEMAPHORE_OK 	pdPASS
     #define CSP_SEMAPHORE_ERROR	pdFAIL
@@ -33,8 +60,129 @@
     #define CSP_MUTEX_ERROR		CSP_SEMAPHORE_ERROR
 #endif
 
+/**
+ * Mutex protocols, @see osSemaphoreCreateProtocol
+ */
+#define OS_SEMAPHORE_PLAIN      0   ///< No priority changes
+#define OS_SEMAPHORE_INHERIT    1   ///< Priority inheritance
+#define OS_SEMAPHORE_CEILING    2   ///< Priority ceiling (priority protect)
+
+/**
+ * Wait time statistics of a semaphore
+ */
+typedef struct os_semaphore_stats_s {
+	uint32_t takes;             ///< Successful takes
+	uint32_t contended;         ///< Takes that had to wait
+	uint32_t wait_max_us;       ///< Max. wait time (us)
+	uint64_t wait_total_us;     ///< Sum of the wait times (us)
+} osSemaphoreStats;
+
+/**
+ * Creates a priority inheritance mutex, the same as
+ * osSemaphoreCreateProtocol(mutex, OS_SEMAPHORE_INHERIT, 0). A low priority
+ * task holding the mutex runs with the priority of the highest priority task
+ * waiting for it, so medium priority tasks can not delay the waiting task
+ * (priority inversion). FreeRTOS mutexes always use priority inheritance.
+ *
+ * @param mutex osSemaphore *. Mutex to initialize
+ * @return CSP_SEMAPHORE_OK or CSP_SEMAPHORE_ERROR
+ */
 int osSemaphoreCreate(osSemaphore* mutex);
+
+/**
+ * Creates a mutex with the given priority protocol. With OS_SEMAPHORE_CEILING
+ * a task runs with the @ceiling priority while it holds the mutex, in
+ * GNU/Linux this requires SCHED_FIFO permissions (root) even to take the
+ * mutex. FreeRTOS only supports priority inheritance, the protocol is ignored.
+ *
+ * @param mutex osSemaphore *. Mutex to initialize
+ * @param protocol Int. OS_SEMAPHORE_PLAIN, OS_SEMAPHORE_INHERIT or OS_SEMAPHORE_CEILING
+ * @param ceiling Int. Ceiling priority, only for OS_SEMAPHORE_CEILING
+ * @return CSP_SEMAPHORE_OK or CSP_SEMAPHORE_ERROR
+ */
+int osSemaphoreCreateProtocol(osSemaphore* mutex, int protocol, int ceiling);
+
 int osSemaphoreTake(osSemaphore* mutex, uint32_t timeout);
 int osSemaphoreGiven(osSemaphore* mutex);
 
-#endif
\ No newline at end of file
+/**
+ * Gets the wait time statistics of a semaphore. Only takes that find the
+ * semaphore taken are timed, uncontended takes only increment a counter.
+ *
+ * @param mutex osSemaphore *. The semaphore
+ * @param stats osSemaphoreStats *. Structure to store the statistics
+ */
+void osSemaphoreGetStats(osSemaphore* mutex, osSemaphoreStats *stats);
+
+/**
+ * Lock contention profiler (SCH_OS_LOCK_PROFILE). Named semaphores record
+ * every take and give: acquisitions, contended acquisitions, waiting tasks
+ * and histograms of the wait and hold times. With SCH_OS_LOCK_PROFILE 0 the
+ * profiler is compiled out and osSemaphoreSetName does nothing.
+ *
+ * Histogram bucket 0 counts times of 0 us, bucket i counts times from
+ * 2^(i-1) to 2^i - 1 us, the last bucket also counts longer times.
+ */
+#define OS_LOCK_HIST_BUCKETS 24
+
+#if SCH_OS_LOCK_PROFILE
+/**
+ * Profile of a named semaphore
+ */
+typedef struct os_lock_profile_s {
+	char name[16];                          ///< Semaphore name
+	const void *owner;                      ///< Profiled semaphore, internal
+	uint32_t acquisitions;                  ///< Successful takes
+	uint32_t contended;                     ///< Takes that found the semaphore taken
+	uint32_t waiters;                       ///< Tasks waiting now
+	uint32_t max_waiters;                   ///< Max. tasks waiting at the same time
+	uint32_t wait_hist[OS_LOCK_HIST_BUCKETS];   ///< Wait time histogram, all takes
+	uint32_t wait_max_us;                   ///< Max. wait time (us)
+	uint32_t hold_hist[OS_LOCK_HIST_BUCKETS];   ///< Hold time histogram
+	uint32_t hold_max_us;                   ///< Max. hold time (us)
+	uint64_t hold_total_us;                 ///< Sum of the hold times (us)
+	uint64_t taken_us;                      ///< Time of the last take (us), internal
+} osLockProfile;
+
+/**
+ * Adds a semaphore to the profiler. Call after osSemaphoreCreate, naming a
+ * semaphore again (after creating it again) keeps its profile. Each semaphore
+ * has its own profile, semaphores with the same name are listed separately.
+ * Up to SCH_OS_LOCK_MAX_ENTRIES profiles, later semaphores are not profiled.
+ *
+ * @param mutex osSemaphore *. The semaphore
+ * @param name Str. Name shown in the profile, max 15 chars
+ */
+void osSemaphoreSetName(osSemaphore* mutex, const char *name);
+
+/**
+ * Gets the profile of the @index named semaphore, in naming order
+ *
+ * @param index Int. Profile index, from 0
+ * @param profile osLockProfile *. Structure to store the profile
+ * @return 1 if the profile exists, 0 if @index is out of range
+ */
+int osLockProfileGet(int index, osLockProfile *profile);
+
+/**
+ * Clears all the profiles, names are kept. In GNU/Linux the profiles are
+ * cleared without taking the profiled semaphores, so a take or give running
+ * at the same time may be partly counted in the new measurement.
+ */
+void osLockProfileReset(void);
+
+/**
+ * Percentile of a profile histogram, the upper limit of the bucket but never
+ * more than @max_us
+ *
+ * @param hist uint32_t *. Histogram of OS_LOCK_HIST_BUCKETS buckets
+ * @param max_us uint32_t. Max. time of the histogram (us)
+ * @param percent Int. Percentile, from 1 to 100
+ * @return uint32_t. Time in microseconds, 0 if the histogram is empty
+ */
+uint32_t osLockProfilePercentile(const uint32_t *hist, uint32_t max_us, int percent);
+#else
+	#define osSemaphoreSetName(mutex, name)
+#endif
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * @file  osSim.h
+ * @author Carlos Gonzalez Cortes
+ * @date 2018
+ * @copyright GNU Public License.
+ *
+ * Simulated time backend (src/os/Sim), a GNU/Linux backend where all the
+ * delays, timers, queue timeouts and the wall clock use a virtual clock. The
+ * virtual clock only advances when every task is blocked, and then it jumps
+ * straight to the next wake up time, so long mission scenarios run as fast as
+ * the tasks can execute and always in the same order.
+ *
+ * Build with -DSIM (cmake -DUSE_SIM=ON), the SIM backend replaces the Linux
+ * osDelay, osEvent, osQueue, osThread and osTimer implementations. Tasks must
+ * block only in OS functions (delays, timers, events and queues), tasks
+ * waiting for other events (console input, CSP sockets) stop the virtual
+ * clock, so the console and communications tasks are not created in SIM
+ * builds. Semaphores are the Linux mutexes, only used for short critical
+ * sections.
+ */
+
+#ifndef _OS_SIM_H_
+#define _OS_SIM_H_
+
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+#include "config.h"
+#include "os.h"
+
+#define OS_SIM_NO_DEADLINE UINT64_MAX
+
+/**
+ * A task blocked in the virtual clock, waiting to be woken by another task
+ * or until a deadline. Waiters are stored in the stack of the blocked task.
+ */
+typedef struct os_sim_waiter_s {
+    pthread_cond_t cond;                ///< Signaled when the task is woken
+    uint64_t deadline;                  ///< Virtual time to wake up (ns), or OS_SIM_NO_DEADLINE
+    int woken;                          ///< 0 while blocked, 1 if woken, 2 if the deadline expired
+    struct os_sim_waiter_s **list;      ///< Wait list of the waiter, or NULL
+    struct os_sim_waiter_s *next;       ///< Next waiter in the wait list
+    struct os_sim_waiter_s *timed_next; ///< Next waiter with a deadline
+} os_sim_waiter_t;
+
+#define OS_SIM_WOKEN 1
+#define OS_SIM_TIMEOUT 2
+
+/**
+ * Sets the virtual clock to the @unix_time wall clock time. Tasks blocked
+ * until an earlier time are woken. Call before creating the tasks to set the
+ * scenario start date, by default the virtual clock starts at the host time.
+ *
+ * @param unix_time time_t. New virtual wall clock time in seconds
+ */
+void osSimSetTime(time_t unix_time);
+
+/**
+ * Virtual wall clock time
+ *
+ * @return time_t. Seconds since the epoch
+ */
+time_t osSimGetTime(void);
+
+/**
+ * Virtual clock in nanoseconds since the epoch
+ *
+ * @return uint64_t. Virtual time in ns
+ */
+uint64_t osSimGetNs(void);
+
+/**
+ * Advances the virtual clock @mseconds milliseconds, without waiting for all
+ * the tasks to be blocked, and wakes up the tasks that are due.
+ *
+ * @param mseconds uint32_t. Milliseconds to advance
+ */
+void osSimAdvance(uint32_t mseconds);
+
+/**
+ * Lock of the virtual clock, shared by all the SIM backend objects. The
+ * following functions up to osSimDeadline must be called with the lock taken.
+ */
+void osSimLock(void);
+void osSimUnlock(void);
+
+/**
+ * Blocks the calling task in a wait list until another task wakes it up with
+ * osSimWakeOne or until the virtual @deadline.
+ *
+ * @param list Wait list, NULL to wait only for the deadline
+ * @param deadline uint64_t. Virtual time in ns or OS_SIM_NO_DEADLINE
+ * @return OS_SIM_WOKEN or OS_SIM_TIMEOUT
+ */
+int osSimWait(os_sim_waiter_t **list, uint64_t deadline);
+
+/**
+ * Wakes up the first task of a wait list
+ *
+ * @param list Wait list
+ * @return 1 if a task was woken, 0 if the list was empty
+ */
+int osSimWakeOne(os_sim_waiter_t **list);
+
+/**
+ * Virtual deadline @mseconds milliseconds from now, OS_SIM_NO_DEADLINE for
+ * portMAX_DELAY
+ */
+uint64_t osSimDeadline(uint32_t mseconds);
+
+/**
+ * Registers a new task, the virtual clock does not advance while it runs
+ */
+void osSimTaskAdd(void);
+
+/**
+ * Unregisters the calling task when it ends
+ */
+void osSimTaskRemove(void);
+
+#endif //_OS_SIM_H_
@@ -12,6 +12,7 @@
 #ifndef _OS_THREAD_H_
 #define _OS_THREAD_H_
 
+#include <stdint.h>
 #include "config.h"
 
 #ifdef LINUX
@@ -26,11 +27,32 @@
     typedef portBASE_TYPE os_thread;
 #endif
 
+/**
+ * Execution statistics of a task created with osCreateTask
+ */
+typedef struct os_task_stats_s {
+    char name[16];              ///< Task name
+    int alive;                  ///< 1 while the task runs, 0 if it ended
+    uint64_t cpu_us;            ///< CPU time used by the task (us), 0 if not available
+    uint32_t wakeups;           ///< Times the task woke up from a delay, timer or queue
+    uint32_t latency_count;     ///< Wake ups with a known wake up time (delays and timers)
+    uint64_t latency_total_us;  ///< Sum of the scheduling latencies (us)
+    uint32_t latency_max_us;    ///< Max. scheduling latency, from the wake up time until the task runs (us)
+    uint32_t overruns;          ///< Times osTaskDelayUntil or a periodic timer woke up a period late
+    uint32_t stack_size;        ///< Stack size in bytes
+    uint32_t stack_used;        ///< Stack high water mark in bytes, 0 if not available
+} osTaskStats;
+
 /**
  * Create a new task.
  * In GNU/Linux a new thread is created and started inmediately. In FreeRTOS
  * a new Task is created but will start after a call to osScheduler().
  *
+ * Tasks are added to a registry (up to SCH_OS_TASK_MAX_ENTRIES) to collect
+ * their execution statistics, @see osTaskGetStats. In GNU/Linux the stack is
+ * allocated by the registry, with at least SCH_OS_TASK_STACK_MIN bytes, and
+ * painted with a known pattern to measure the stack high water mark.
+ *
  * @param functionTask Pointer to the target function task
  * @param name Task name. In GNU/Linux max 16 chars.
  * @param size Task stack size.
@@ -46,10 +68,54 @@
  */
 int osCreateTask(void (*functionTask)(void *), char* name, unsigned short size, void * parameters, unsigned int priority, os_thread* thread);
 
+/**
+ * Create a new task pinned to one CPU (@see osCreateTask). In GNU/Linux the
+ * affinity is set before the thread starts, so the task never runs in another
+ * CPU. In FreeRTOS and SIM builds @cpu is ignored.
+ *
+ * @param cpu Int. CPU number, -1 to let the task run in any CPU
+ * @return Returns 0 on success, error code if the task can not be created.
+ */
+int osCreateTaskAffinity(void (*functionTask)(void *), char* name, unsigned short size, void * parameters, unsigned int priority, int cpu, os_thread* thread);
+
 /**
  * Delete a task. Only in FreeRTOS, not implemented for GNU/Linux
  * @param task_handle Pinter to a task handler
  */
 void osTaskDelete(void *task_handle);
 
+/**
+ * Pin a task to one CPU. Only in GNU/Linux, in FreeRTOS and SIM builds it
+ * does nothing.
+ *
+ * @param thread Pointer to the task handler set by osCreateTask
+ * @param cpu Int. CPU number, -1 to let the task run in any CPU
+ * @return Returns 0 on success, error code if the affinity can not be set.
+ */
+int osTaskSetAffinity(os_thread *thread, int cpu);
+
+/**
+ * Get the execution statistics of the @index task of the registry. Tasks are
+ * numbered in creation order, ended tasks are kept in the registry.
+ *
+ * @param index Int. Task index, from 0
+ * @param stats osTaskStats *. Structure to store the statistics
+ * @return 1 if the task exists, 0 if @index is out of range
+ */
+int osTaskGetStats(int index, osTaskStats *stats);
+
+/**
+ * Clears the wake up, latency and overrun counters of all tasks
+ */
+void osTaskResetStats(void);
+
+/**
+ * Update the statistics of the calling task. Used by the OS functions that
+ * block (delays, timers and queues), tasks not created with osCreateTask are
+ * ignored.
+ */
+void osTaskStatsWakeup(void);
+void osTaskStatsLatency(uint32_t latency_us);
+void osTaskStatsOverrun(void);
+
 #endif // _OS_THREAD_H_
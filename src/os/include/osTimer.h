@@ -0,0 +1,62 @@
+/**
+ * @file  osTimer.h
+ * @author Carlos Gonzalez Cortes
+ * @date 2018
+ * @copyright GNU Public License.
+ *
+ * Software timers for operating systems Linux and FreeRTOS. All the timers
+ * share one timer task that sleeps until the next timer expires, so periodic
+ * tasks do not need their own thread. Periodic timers are rescheduled from
+ * their previous expiration time, so the period does not drift.
+ *
+ * In GNU/Linux the timer task is started with the first timer. In FreeRTOS
+ * the timers use the timer service task (configUSE_TIMERS must be set to 1).
+ */
+
+#ifndef _OS_TIMER_H_
+#define _OS_TIMER_H_
+
+#include "os.h"
+#include "stdint.h"
+
+/**
+ * Timer callback. Runs in the timer task, so it must be short and must not
+ * block for long, otherwise it delays the other timers.
+ *
+ * @param arg Argument given in osTimerCreate
+ */
+typedef void (*osTimerCallback)(void *arg);
+
+typedef void* osTimer;
+
+/**
+ * Create a new timer. The timer is created stopped, use osTimerStart.
+ *
+ * @param name Timer name, for debugging
+ * @param period_ms uint32_t. Timer period in milliseconds
+ * @param periodic Int. 1 to run the callback every @period_ms milliseconds, 0
+ * to run it once
+ * @param callback osTimerCallback. Function to call when the timer expires
+ * @param arg Argument for the callback
+ * @return osTimer. The new timer or NULL in case of errors
+ */
+osTimer osTimerCreate(char *name, uint32_t period_ms, int periodic, osTimerCallback callback, void *arg);
+
+/**
+ * Start or restart a timer. The timer expires @period_ms milliseconds after
+ * this call.
+ *
+ * @param timer osTimer. The timer
+ * @return pdPASS if the timer was started
+ */
+int osTimerStart(osTimer timer);
+
+/**
+ * Stop a timer. The callback is not called until the timer is started again.
+ *
+ * @param timer osTimer. The timer
+ * @return pdPASS if the timer was stopped
+ */
+int osTimerStop(osTimer timer);
+
+#endif //_OS_TIMER_H_
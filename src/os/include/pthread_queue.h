@@ -51,6 +51,10 @@ typedef struct os_thread_queue_s {
 os_pthread_queue_t * os_pthread_queue_create(int length, size_t item_size);
 int os_pthread_queue_send(os_pthread_queue_t *queue, void *value, uint32_t timeout);
 int os_pthread_queue_receive(os_pthread_queue_t *queue, void *buf, uint32_t timeout);
+int os_pthread_queue_send_batch(os_pthread_queue_t *queue, void *values, int n, uint32_t timeout);
+int os_pthread_queue_receive_batch(os_pthread_queue_t *queue, void *buf, int n, uint32_t timeout);
+int os_pthread_queue_peek(os_pthread_queue_t *queue, void *buf, uint32_t timeout);
+int os_pthread_queue_items(os_pthread_queue_t *queue);
 
 #endif 
 
@@ -0,0 +1,111 @@
+/**
+ * @file  ring_queue.h
+ * @author Carlos Gonzalez Cortes
+ * @date 2018
+ * @copyright GNU Public License.
+ *
+ * Lock-free bounded queue for Linux, used by osQueue. Items are copied to a
+ * ring of cells, each cell has a sequence number that tells if it is free or
+ * full, so senders and receivers only compete with an atomic compare and swap
+ * of the tail or head position (multiple producers, multiple consumers). A
+ * queue created for a single producer and a single consumer does not use
+ * compare and swap at all.
+ *
+ * Tasks only block, using futex waits, when the queue is full or empty, and
+ * only wake other tasks if someone is waiting.
+ */
+
+#ifndef _RING_QUEUE_H_
+#define _RING_QUEUE_H_
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/**
+ * Queue structure. Cells are stored after the structure in a single
+ * allocation. Positions and futex words are kept in different cache lines
+ * to avoid false sharing between senders and receivers.
+ */
+typedef struct os_ring_queue_s {
+    char *cells;                ///< First cell, a sequence number and the item
+    size_t cell_size;           ///< Aligned size of a cell
+    uint32_t size;              ///< Number of cells (queue length)
+    uint32_t item_size;         ///< Size of an item in bytes
+    int spsc;                   ///< Single producer, single consumer queue
+
+    uint64_t tail __attribute__((aligned(64)));   ///< Next position to send
+    uint32_t not_empty;         ///< Futex word, changes when an item is sent
+    uint32_t recv_waiters;      ///< Receivers waiting in @not_empty
+
+    uint64_t head __attribute__((aligned(64)));   ///< Next position to receive
+    uint32_t not_full;          ///< Futex word, changes when an item is received
+    uint32_t send_waiters;      ///< Senders waiting in @not_full
+} os_ring_queue_t;
+
+#define RING_QUEUE_ERROR 0
+#define RING_QUEUE_EMPTY 0
+#define RING_QUEUE_FULL 0
+#define RING_QUEUE_OK 1
+
+/**
+ * Creates a new queue of @length items of @item_size bytes
+ *
+ * @param length Int. Max. number of items in the queue
+ * @param item_size Size_t. Size of each item in bytes
+ * @param spsc Int. 1 if only one task sends and only one task receives, 0
+ * for any number of senders and receivers
+ * @return os_ring_queue_t *. The new queue or NULL in case of errors
+ */
+os_ring_queue_t * os_ring_queue_create(int length, size_t item_size, int spsc);
+
+/**
+ * Copies an item to the queue. Blocks up to @timeout milliseconds if the
+ * queue is full (portMAX_DELAY to wait forever, 0 to not wait).
+ *
+ * @return RING_QUEUE_OK or RING_QUEUE_FULL
+ */
+int os_ring_queue_send(os_ring_queue_t *queue, void *value, uint32_t timeout);
+
+/**
+ * Copies an item from the queue to @buf. Blocks up to @timeout milliseconds if
+ * the queue is empty (portMAX_DELAY to wait forever, 0 to not wait).
+ *
+ * @return RING_QUEUE_OK or RING_QUEUE_EMPTY
+ */
+int os_ring_queue_receive(os_ring_queue_t *queue, void *buf, uint32_t timeout);
+
+/**
+ * Copies @n items from @values to the queue, receivers are woken once for all
+ * the items. Blocks up to @timeout milliseconds while the queue is full.
+ *
+ * @return Int. Number of items sent
+ */
+int os_ring_queue_send_batch(os_ring_queue_t *queue, void *values, int n, uint32_t timeout);
+
+/**
+ * Copies up to @n items from the queue to @buf, taking them at once. Blocks up
+ * to @timeout milliseconds only if the queue is empty.
+ *
+ * @return Int. Number of items received, 0 if the queue is empty
+ */
+int os_ring_queue_receive_batch(os_ring_queue_t *queue, void *buf, int n, uint32_t timeout);
+
+/**
+ * Copies the next item to @buf without removing it from the queue. Blocks up
+ * to @timeout milliseconds if the queue is empty.
+ *
+ * @return RING_QUEUE_OK or RING_QUEUE_EMPTY
+ */
+int os_ring_queue_peek(os_ring_queue_t *queue, void *buf, uint32_t timeout);
+
+/**
+ * Number of items in the queue. Does not block, the value may be outdated
+ * when used if other tasks are using the queue.
+ *
+ * @return Int. Number of items in the queue
+ */
+int os_ring_queue_size(os_ring_queue_t *queue);
+
+#endif //_RING_QUEUE_H_
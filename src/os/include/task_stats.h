@@ -0,0 +1,54 @@
+/**
+ * @file  task_stats.h
+ * @author Carlos Gonzalez Cortes
+ * @date 2018
+ * @copyright GNU Public License.
+ *
+ * Task registry for Linux, used by osCreateTask (Linux and SIM backends) to
+ * collect the statistics returned by osTaskGetStats. Each task has its own
+ * record, updated only by the task itself, so counters do not need locks.
+ *
+ * Task stacks are allocated here and painted with TASK_STATS_PAINT, the stack
+ * high water mark is the part of the stack that no longer has the pattern.
+ * The lowest page of each stack is a guard page, so a stack overflow stops
+ * the program instead of corrupting memory.
+ */
+
+#ifndef _TASK_STATS_H_
+#define _TASK_STATS_H_
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include "config.h"
+#include "osThread.h"
+
+#define TASK_STATS_PAINT 0xA5
+
+/**
+ * Adds a new task to the registry and sets its stack in @attr, a painted
+ * stack of at least SCH_OS_TASK_STACK_MIN bytes. Call before pthread_create.
+ *
+ * @param name Task name
+ * @param size Stack size requested by osCreateTask
+ * @param attr pthread_attr_t *. Attributes used to create the task
+ * @return Int. Task index, or -1 if the registry is full or the stack can not
+ * be allocated (@attr is not modified)
+ */
+int os_task_stats_add(char *name, size_t size, pthread_attr_t *attr);
+
+/**
+ * Binds the calling thread to its record. Call from the new task before
+ * running the task function.
+ *
+ * @param index Int. Task index returned by os_task_stats_add
+ */
+void os_task_stats_start(int index);
+
+/**
+ * Marks the calling task as ended and saves its CPU time. Call when the task
+ * function returns or the task is canceled.
+ */
+void os_task_stats_end(void);
+
+#endif //_TASK_STATS_H_
@@ -29,30 +29,24 @@ static void _com_config_find(char *param_name, int *table, param_table_t **param
 
 void cmd_com_init(void)
 {
-    cmd_add("ping", com_ping, "%d", 1);
-    cmd_add("send_rpt", com_send_rpt, "%d %s", 2);
-    cmd_add("send_cmd", com_send_cmd, "%d %n", 1);
-    cmd_add("send_data", com_send_data, "%p", 1);
-    cmd_add("com_debug", com_debug, "", 0);
+    cmd_add("ping", com_ping, "%d", 1, CMD_DOMAIN_COM);
+    cmd_add("send_rpt", com_send_rpt, "%d %s", 2, CMD_DOMAIN_COM);
+    cmd_add("send_cmd", com_send_cmd, "%d %s", 2, CMD_DOMAIN_COM);
+    cmd_add("send_data", com_send_data, "%p", 1, CMD_DOMAIN_COM);
+    cmd_add("com_debug", com_debug, "", 0, CMD_DOMAIN_COM);
 #ifdef SCH_USE_NANOCOM
-    cmd_add("com_reset_wdt", com_reset_wdt, "%d", 1);
-    cmd_add("com_get_config", com_get_config, "%s", 1);
-    cmd_add("com_set_config", com_set_config, "%s %s", 2);
-    cmd_add("com_update_status", com_set_config, "", 2);
+    cmd_add("com_reset_wdt", com_reset_wdt, "%d", 1, CMD_DOMAIN_COM);
+    cmd_add("com_get_config", com_get_config, "%s", 1, CMD_DOMAIN_COM);
+    cmd_add("com_set_config", com_set_config, "%s %s", 2, CMD_DOMAIN_COM);
+    cmd_add("com_update_status", com_set_config, "", 2, CMD_DOMAIN_COM);
 #endif
 }
 
-int com_ping(char *fmt, char *params, int nparams)
+int com_ping(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    if(params == NULL)
-    {
-        LOGE(tag, "Null arguments!");
-        return CMD_ERROR;
-    }
-
-    int node;
-    if(sscanf(params, fmt, &node) == nparams)
+    if(args->argc == nparams)
     {
+        int node = args->argv[0].i;
         int rc = csp_ping((uint8_t)node, 3000, 10, CSP_O_NONE);
         LOGI(tag, "Ping to %d took %d", node, rc);
         if(rc > 0)
@@ -61,21 +55,14 @@ int com_ping(char *fmt, char *params, int nparams)
     return CMD_FAIL;
 }
 
-int com_send_rpt(char *fmt, char *params, int nparams)
+int com_send_rpt(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    if(params == NULL)
-    {
-        LOGE(tag, "Null arguments!");
-        return CMD_ERROR;
-    }
-
-    int node;
-    char msg[SCH_CMD_MAX_STR_PARAMS];
-    memset(msg, '\0', SCH_CMD_MAX_STR_PARAMS);
-
     // format: <node> <string>
-    if(sscanf(params, fmt, &node, msg) == nparams)
+    if(args->argc == nparams)
     {
+        int node = args->argv[0].i;
+        char *msg = args->argv[1].s;
+
         // Create a packet with the message
         size_t msg_len = strlen(msg);
         csp_packet_t *packet = csp_buffer_get(msg_len+1);
@@ -108,25 +95,16 @@ int com_send_rpt(char *fmt, char *params, int nparams)
     return CMD_FAIL;
 }
 
-int com_send_cmd(char *fmt, char *params, int nparams)
+int com_send_cmd(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    if(params == NULL)
-    {
-        LOGE(tag, "Null arguments!");
-        return CMD_ERROR;
-    }
-
-    int node, next, n_args;
     uint8_t rep[1];
-    char msg[SCH_CMD_MAX_STR_PARAMS];
-    memset(msg, '\0', SCH_CMD_MAX_STR_PARAMS);
 
     //format: <node> <command> [parameters]
-    n_args = sscanf(params, fmt, &node, &next);
-    if(n_args == nparams && next > 1)
+    if(args->argc == nparams)
     {
-        strncpy(msg, params+next, (size_t)SCH_CMD_MAX_STR_PARAMS);
-        LOGV(tag, "Parsed %d: %d, %s (%d))", n_args, node, msg, next);
+        int node = args->argv[0].i;
+        char *msg = args->argv[1].s;
+        LOGV(tag, "Parsed %d: %d, %s", args->argc, node, msg);
 
         // Sending message to node TC port and wait for response
         int rc = csp_transaction(1, (uint8_t)node, SCH_TRX_PORT_TC, 1000,
@@ -148,16 +126,16 @@ int com_send_cmd(char *fmt, char *params, int nparams)
     return CMD_FAIL;
 }
 
-int com_send_data(char *fmt, char *params, int nparams)
+int com_send_data(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    if(params == NULL)
+    if(args->argc != 1 || args->argv[0].p == NULL)
     {
         LOGE(tag, "Null arguments!");
         return CMD_ERROR;
     }
 
     uint8_t rep[1] = {0};
-    com_data_t *data_to_send = (com_data_t *)params;
+    com_data_t *data_to_send = (com_data_t *)args->argv[0].p;
 
     // Send the data buffer to node and wait 1 seg. for the confirmation
     int rc = csp_transaction(CSP_PRIO_NORM, data_to_send->node, SCH_TRX_PORT_TM,
@@ -176,7 +154,7 @@ int com_send_data(char *fmt, char *params, int nparams)
     }
 }
 
-int com_debug(char *fmt, char *params, int nparams)
+int com_debug(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     LOGD(tag, "Route table");
     csp_route_print_table();
@@ -187,19 +165,16 @@ int com_debug(char *fmt, char *params, int nparams)
 }
 
 #ifdef SCH_USE_NANOCOM
-int com_reset_wdt(char *fmt, char *params, int nparams)
+int com_reset_wdt(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
 
-    int rc, node, n_args = 0;
-
-    // If no params received, try to reset the default SCH_TRX_ADDRESS node
-    if(params == NULL)
-        node = SCH_TRX_ADDRESS;
+    int rc, node;
 
     //format: <node>
-    n_args = sscanf(params, fmt, &node);
     // If no params received, try to reset the default SCH_TRX_ADDRESS node
-    if(n_args != nparams)
+    if(args->argc == nparams)
+        node = args->argv[0].i;
+    else
         node = SCH_TRX_ADDRESS;
 
     // Send and empty message to GNDWDT_RESET (9) port
@@ -217,28 +192,20 @@ int com_reset_wdt(char *fmt, char *params, int nparams)
     }
 }
 
-int com_get_hk(char *fmt, char *params, int nparams)
+int com_get_hk(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     //TODO: Implement
     return CMD_FAIL;
 }
 
-int com_get_config(char *fmt, char *params, int nparams)
+int com_get_config(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    int rc, n_args;
-    char param[SCH_CMD_MAX_STR_PARAMS];
-    memset(param, '\0', SCH_CMD_MAX_STR_PARAMS);
-
-    if(params == NULL)
-    {
-        LOGE(tag, "Null arguments!");
-        return CMD_FAIL;
-    }
+    int rc;
 
     // Format: <param_name>
-    n_args = sscanf(params, fmt, &param);
-    if(n_args == nparams)
+    if(args->argc == nparams)
     {
+        char *param = args->argv[0].s;
         int table = 0;
         param_table_t *param_i;
 
@@ -283,24 +250,15 @@ int com_get_config(char *fmt, char *params, int nparams)
     }
 }
 
-int com_set_config(char *fmt, char *params, int nparams)
+int com_set_config(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    int rc, n_args;
-    char param[SCH_CMD_MAX_STR_PARAMS];
-    char value[SCH_CMD_MAX_STR_PARAMS];
-    memset(param, '\0', SCH_CMD_MAX_STR_PARAMS);
-    memset(value, '\0', SCH_CMD_MAX_STR_PARAMS);
-
-    if(params == NULL)
-    {
-        LOGE(tag, "Null arguments!");
-        return CMD_FAIL;
-    }
+    int rc;
 
     // Format: <param_name> <value>
-    n_args = sscanf(params, fmt, &param, &value);
-    if(n_args == nparams)
+    if(args->argc == nparams)
     {
+        char *param = args->argv[0].s;
+        char *value = args->argv[1].s;
         int table = 0;
         param_table_t *param_i;
 
@@ -346,7 +304,7 @@ int com_set_config(char *fmt, char *params, int nparams)
     }
 }
 
-int com_update_status_vars(char *fmt, char *params, int nparams)
+int com_update_status_vars(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     char *names[5] = {"freq", "tx_pwr", "baud", "mode", "bcn_interval"};
     dat_system_t vars[5] = {dat_com_freq, dat_com_tx_pwr, dat_com_bcn_period,
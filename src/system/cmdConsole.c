@@ -24,8 +24,8 @@ static const char *tag = "cmdConsole";
 
 void cmd_console_init(void)
 {
-    cmd_add("test", con_debug_msg, "%s", 1);
-    cmd_add("help", con_help, "", 0);
+    cmd_add("test", con_debug_msg, "%s", 1, CMD_DOMAIN_OBC);
+    cmd_add("help", con_help, "", 0, CMD_DOMAIN_OBC);
 }
 
 /**
@@ -33,18 +33,17 @@ void cmd_console_init(void)
  * @param param void message as char array
  * @return 1 - OK, 0 fail
  */
-int con_debug_msg(char *fmt, char *params, int nparams)
+int con_debug_msg(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    char msg[SCH_CMD_MAX_STR_PARAMS];
-    if(sscanf(params,fmt, msg) == nparams)
+    if(args->argc == nparams)
     {
-        printf("[Debug Msg] %s\n", msg);
+        printf("[Debug Msg] %s\n", args->argv[0].s);
         return CMD_OK;
     }
     return CMD_FAIL;
 }
 
-int con_help(char *fmt, char *params, int nparams)
+int con_help(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
 //    osSemaphoreTake(&log_mutex, portMAX_DELAY);
     printf("List of commands:\n");
@@ -28,23 +28,22 @@ static const char *tag = "cmdDRP";
  */
 void cmd_drp_init(void)
 {
-    cmd_add("ebf", drp_execute_before_flight, "%d", 1);
-    cmd_add("print_vars", drp_print_system_vars, "", 0);
-    cmd_add("update_sys_var", drp_update_sys_var_idx, "%d %d", 2);
-    cmd_add("update_hours_alive", drp_update_hours_alive, "%d", 1);
-    cmd_add("clear_gnd_wdt", drp_clear_gnd_wdt, "", 0);
-    cmd_add("sample_obc_sensors", drp_sample_obc_sensors, "", 0);
-    cmd_add("test_system_vars", drp_test_system_vars, "", 0);
+    cmd_add("ebf", drp_execute_before_flight, "%d", 1, CMD_DOMAIN_STORAGE);
+    cmd_add("print_vars", drp_print_system_vars, "", 0, CMD_DOMAIN_STORAGE);
+    cmd_add("update_sys_var", drp_update_sys_var_idx, "%d %d", 2, CMD_DOMAIN_STORAGE);
+    cmd_add("update_hours_alive", drp_update_hours_alive, "%d", 1, CMD_DOMAIN_STORAGE);
+    cmd_add("clear_gnd_wdt", drp_clear_gnd_wdt, "", 0, CMD_DOMAIN_STORAGE);
+    cmd_add("sample_obc_sensors", drp_sample_obc_sensors, "", 0, CMD_DOMAIN_STORAGE);
+    cmd_add("test_system_vars", drp_test_system_vars, "", 0, CMD_DOMAIN_STORAGE);
+    cmd_add("flush_vars", drp_flush_system_vars, "", 0, CMD_DOMAIN_STORAGE);
+    cmd_add("flush_stats", drp_get_flush_stats, "%d", 1, CMD_DOMAIN_STORAGE);
 }
 
-int drp_execute_before_flight(char *fmt, char *params, int nparams)
+int drp_execute_before_flight(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    if(params == NULL)
-        return CMD_ERROR;
-
-    int magic;
-    if(nparams == sscanf(params, fmt, &magic))
+    if(nparams == args->argc)
     {
+        int magic = args->argv[0].i;
         if(magic == SCH_DRP_MAGIC)
         {
             // Reset all status variables values to 0
@@ -54,11 +53,12 @@ int drp_execute_before_flight(char *fmt, char *params, int nparams)
                 dat_set_system_var(var, 0);
             }
             // Set all status variables default values
-            dat_set_system_var(dat_rtc_date_time, (int)time(NULL));
+            dat_set_system_var(dat_rtc_date_time, (int)dat_get_time());
             // dat_set_system_var(dat_custom, default_value);
 
             // Delete memory sections
             dat_delete_memory_sections();
+            dat_flush();
 
             return CMD_OK;
         }
@@ -75,7 +75,7 @@ int drp_execute_before_flight(char *fmt, char *params, int nparams)
     }
 }
 
-int drp_print_system_vars(char *fmt, char *params, int nparams)
+int drp_print_system_vars(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     LOGD(tag, "Displaying system variables list");
 
@@ -86,12 +86,12 @@ int drp_print_system_vars(char *fmt, char *params, int nparams)
     return CMD_OK;
 }
 
-int drp_update_sys_var_idx(char *fmt, char *params, int nparams)
+int drp_update_sys_var_idx(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    int index, value;
-    if(sscanf(params, fmt, &index, &value) == nparams)
+    if(args->argc == nparams)
     {
-        dat_system_t var_index = (dat_system_t)index;
+        int value = args->argv[1].i;
+        dat_system_t var_index = (dat_system_t)args->argv[0].i;
         if(var_index < dat_system_last_var)
         {
             dat_set_system_var(var_index, value);
@@ -111,22 +111,18 @@ int drp_update_sys_var_idx(char *fmt, char *params, int nparams)
 
 }
 
-int drp_update_hours_alive(char *fmt, char *params, int nparams)
+int drp_update_hours_alive(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     int value;  // Value to add
-    int current;  // Current value to update
 
-    if(sscanf(params, fmt, &value) == nparams)
+    if(args->argc == nparams)
     {
+        value = args->argv[0].i;
         // Adds <value> to current hours alive
-        current = dat_get_system_var(dat_obc_hrs_alive);
-        current += value;
-        dat_set_system_var(dat_obc_hrs_alive, current);
-
+        dat_add_system_var(dat_obc_hrs_alive, value);
         // Adds <value> to current hours without reset
-        current = dat_get_system_var(dat_obc_hrs_wo_reset);
-        current += value;
-        dat_set_system_var(dat_obc_hrs_wo_reset, current);
+        dat_add_system_var(dat_obc_hrs_wo_reset, value);
+        dat_flush();
         return CMD_OK;
     }
     else
@@ -136,13 +132,13 @@ int drp_update_hours_alive(char *fmt, char *params, int nparams)
     }
 }
 
-int drp_clear_gnd_wdt(char *fmt, char *params, int nparams)
+int drp_clear_gnd_wdt(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     dat_set_system_var(dat_obc_sw_wdt, 0);
     return CMD_OK;
 }
 
-int drp_sample_obc_sensors(char *fmt, char *params, int nparams)
+int drp_sample_obc_sensors(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
 #ifdef NANOMIND
     int16_t sensor1, sensor2;
@@ -241,7 +237,7 @@ int drp_sample_obc_sensors(char *fmt, char *params, int nparams)
     return CMD_OK;
 }
 
-int drp_test_system_vars(char *fmt, char *params, int nparams)
+int drp_test_system_vars(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     int var_index;
     int var;
@@ -264,3 +260,29 @@ int drp_test_system_vars(char *fmt, char *params, int nparams)
 
     return return_value;
 }
+
+int drp_flush_system_vars(char *fmt, char *params, int nparams, cmd_args_t *args)
+{
+    return dat_flush() == 0 ? CMD_OK : CMD_FAIL;
+}
+
+int drp_get_flush_stats(char *fmt, char *params, int nparams, cmd_args_t *args)
+{
+    dat_flush_stats_t stats;
+    int reset = args->argc == nparams && args->argv[0].i != 0;
+    dat_get_flush_stats(&stats, reset);
+
+    // Writing through, every copy of every write is committed on its own
+    uint32_t write_through = stats.writes * (SCH_STORAGE_TRIPLE_WR ? 3 : 1);
+    printf("%10s %10s %10s %10s %10s %10s %10s %14s %10s\n", "writes", "coalesced", "volatile", "values",
+           "commits", "synced", "busy", "write through", "saved");
+    printf("%10u %10u %10u %10u %10u %10u %10u %14u %10u\n", (unsigned int)stats.writes,
+           (unsigned int)stats.coalesced, (unsigned int)stats.skipped, (unsigned int)stats.rows,
+           (unsigned int)stats.commits, (unsigned int)stats.synced, (unsigned int)stats.busy,
+           (unsigned int)write_through,
+           write_through > stats.commits ? (unsigned int)(write_through - stats.commits) : 0);
+#if SCH_STORAGE_MODE == 0
+    LOGW(tag, "Status variables are stored in RAM, nothing is committed");
+#endif
+    return CMD_OK;
+}
@@ -30,16 +30,16 @@ void cmd_eps_init(void)
     eps_set_timeout(1000);
 
     // Register commands
-    cmd_add("eps_hard_reset", eps_hard_reset, "", 0);
-    cmd_add("eps_get_hk", eps_get_hk, "", 0);
-    cmd_add("eps_get_config", eps_get_config, "", 0);
-    cmd_add("eps_set_heater", eps_set_heater, "%d %d", 2);
-    cmd_add("eps_update_status", eps_update_status_vars, "", 0);
+    cmd_add("eps_hard_reset", eps_hard_reset, "", 0, CMD_DOMAIN_EPS);
+    cmd_add("eps_get_hk", eps_get_hk, "", 0, CMD_DOMAIN_EPS);
+    cmd_add("eps_get_config", eps_get_config, "", 0, CMD_DOMAIN_EPS);
+    cmd_add("eps_set_heater", eps_set_heater, "%d %d", 2, CMD_DOMAIN_EPS);
+    cmd_add("eps_update_status", eps_update_status_vars, "", 0, CMD_DOMAIN_EPS);
 #endif
 }
 
 #ifdef SCH_USE_NANOPOWER
-int eps_hard_reset(char *fmt, char *params, int nparams)
+int eps_hard_reset(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     if(eps_hardreset() > 0)
         return CMD_OK;
@@ -48,7 +48,7 @@ int eps_hard_reset(char *fmt, char *params, int nparams)
     return CMD_FAIL;
 }
 
-int eps_get_hk(char *fmt, char *params, int nparams)
+int eps_get_hk(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     eps_hk_t hk = {};
     if(eps_hk_get(&hk) > 0)
@@ -62,7 +62,7 @@ int eps_get_hk(char *fmt, char *params, int nparams)
     return CMD_OK;
 }
 
-int eps_get_config(char *fmt, char *params, int nparams)
+int eps_get_config(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     eps_config_t nanopower_config;
 
@@ -77,19 +77,15 @@ int eps_get_config(char *fmt, char *params, int nparams)
     return CMD_OK;
 }
 
-int eps_set_heater(char *fmt, char *params, int nparams)
+int eps_set_heater(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    if(params == NULL)
-    {
-        LOGE(tag, "NULL params!");
-        return CMD_FAIL;
-    }
-
     int heater, on_off;
     uint8_t state[2];
 
-    if(sscanf(params, fmt, &heater, &on_off) == nparams)
+    if(args->argc == nparams)
     {
+        heater = args->argv[0].i;
+        on_off = args->argv[1].i;
         LOGI(tag, "Setting heater %d to state %d", heater, on_off);
         eps_heater((uint8_t) heater, (uint8_t) on_off, state);
         LOGI(tag, "Heater state is %u %u",(unsigned int) state[0],(unsigned int) state[1]);
@@ -102,7 +98,7 @@ int eps_set_heater(char *fmt, char *params, int nparams)
     }
 }
 
-int eps_update_status_vars(char *fmt, char *params, int nparams)
+int eps_update_status_vars(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     eps_hk_t hk = {};
     if(eps_hk_get(&hk) > 0)
@@ -23,35 +23,36 @@ static const char* tag = "cmdFlightPlan";
 
 void cmd_fp_init(void)
 {
-    cmd_add("fp_set_cmd", fp_set, "%d %d %d %d %d %d %s %s %d %d", 10);
-    cmd_add("fp_del_cmd", fp_delete, "%d %d %d %d %d %d", 6);
-    cmd_add("fp_show", fp_show, "", 0);
-    cmd_add("fp_reset", fp_reset,"", 0);
-    cmd_add("test_fp_params", test_fp_params, "%d %s %d", 3);
+    cmd_add("fp_set_cmd", fp_set, "%d %d %d %d %d %d %s %s %d %d", 10, CMD_DOMAIN_STORAGE);
+    cmd_add("fp_del_cmd", fp_delete, "%d %d %d %d %d %d", 6, CMD_DOMAIN_STORAGE);
+    cmd_add("fp_show", fp_show, "", 0, CMD_DOMAIN_STORAGE);
+    cmd_add("fp_reset", fp_reset,"", 0, CMD_DOMAIN_STORAGE);
+    cmd_add("test_fp_params", test_fp_params, "%d %s %d", 3, CMD_DOMAIN_STORAGE);
 }
 
-int fp_set(char *fmt, char *params, int nparams)
+int fp_set(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     struct tm str_time;
     time_t unixtime;
-    int day, month, year, hour, min, sec;
-    char command[SCH_CMD_MAX_STR_PARAMS];
-    char args[SCH_CMD_MAX_STR_PARAMS];
-    int executions,periodical;
 
-    if(sscanf(params, fmt, &day, &month, &year, &hour, &min, &sec, &command, &args, &executions, &periodical) == nparams)
+    if(args->argc == nparams)
     {
-        str_time.tm_mday = day;
-        str_time.tm_mon = month-1;
-        str_time.tm_year = year-1900;
-        str_time.tm_hour = hour;
-        str_time.tm_min = min;
-        str_time.tm_sec = sec;
+        str_time.tm_mday = args->argv[0].i;
+        str_time.tm_mon = args->argv[1].i-1;
+        str_time.tm_year = args->argv[2].i-1900;
+        str_time.tm_hour = args->argv[3].i;
+        str_time.tm_min = args->argv[4].i;
+        str_time.tm_sec = args->argv[5].i;
         str_time.tm_isdst = 0;
 
+        char *command = args->argv[6].s;
+        char *cmd_args = args->argv[7].s;
+        int executions = args->argv[8].i;
+        int periodical = args->argv[9].i;
+
         unixtime = mktime(&str_time);
 
-        int rc = dat_set_fp((int)unixtime, command, args, executions, periodical);
+        int rc = dat_set_fp((int)unixtime, command, cmd_args, executions, periodical);
 
         if (rc == 0)
             return CMD_OK;
@@ -65,21 +66,20 @@ int fp_set(char *fmt, char *params, int nparams)
     }
 }
 
-int fp_delete(char* fmt, char* params, int nparams)
+int fp_delete(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
 
     struct tm str_time;
     time_t unixtime;
-    int day, month, year, hour, min, sec;
 
-    if(sscanf(params, fmt, &day, &month, &year, &hour, &min, &sec) == nparams)
+    if(args->argc == nparams)
     {
-        str_time.tm_mday = day;
-        str_time.tm_mon = month-1;
-        str_time.tm_year = year-1900;
-        str_time.tm_hour = hour;
-        str_time.tm_min = min;
-        str_time.tm_sec = sec;
+        str_time.tm_mday = args->argv[0].i;
+        str_time.tm_mon = args->argv[1].i-1;
+        str_time.tm_year = args->argv[2].i-1900;
+        str_time.tm_hour = args->argv[3].i;
+        str_time.tm_min = args->argv[4].i;
+        str_time.tm_sec = args->argv[5].i;
         str_time.tm_isdst = 0;
 
         unixtime = mktime(&str_time);
@@ -98,7 +98,7 @@ int fp_delete(char* fmt, char* params, int nparams)
     }
 }
 
-int fp_show(char* fmt, char* params, int nparams)
+int fp_show(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
 
     int rc= dat_show_fp();
@@ -109,7 +109,7 @@ int fp_show(char* fmt, char* params, int nparams)
         return CMD_FAIL;
 }
 
-int fp_reset(char* fmt, char* params, int nparams)
+int fp_reset(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
 
     int rc = dat_reset_fp();
@@ -120,13 +120,12 @@ int fp_reset(char* fmt, char* params, int nparams)
         return CMD_FAIL;
 }
 
-int test_fp_params(char* fmt, char* params,int nparams)
+int test_fp_params(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    int num1, num2;
-    char str[SCH_CMD_MAX_STR_PARAMS];
-    if(sscanf(params, fmt, &num1, &str, &num2) == nparams)
+    if(args->argc == nparams)
     {
-        printf("The parameters are: %d ; %s ; %d \n",num1, str ,num2);
+        printf("The parameters are: %d ; %s ; %d \n", args->argv[0].i,
+               args->argv[1].s, args->argv[2].i);
         return CMD_OK;
     }
     else
@@ -20,27 +20,31 @@
  */
  
 #include "cmdOBC.h"
+#include "taskDispatcher.h"
 
 static const char* tag = "cmdOBC";
 
 void cmd_obc_init(void)
 {
-    cmd_add("debug_obc", obc_debug, "%d", 1);
-    cmd_add("reset", obc_reset, "", 0);
-    cmd_add("get_mem", obc_get_os_memory, "", 0);
-    cmd_add("set_time", obc_set_time,"%d",1);
-    cmd_add("show_time", obc_show_time,"%d",1);
-    cmd_add("reset_wdt", obc_reset_wdt, "", 0);
-    cmd_add("system", obc_system, "%s", 1);
-    cmd_add("set_pwm_duty", obc_set_pwm_duty, "%d %d", 2);
+    cmd_add("debug_obc", obc_debug, "%d", 1, CMD_DOMAIN_OBC);
+    cmd_add("reset", obc_reset, "%s", 1, CMD_DOMAIN_OBC);
+    cmd_add("get_mem", obc_get_os_memory, "", 0, CMD_DOMAIN_OBC);
+    cmd_add("get_lanes", obc_get_lane_stats, "%d", 1, CMD_DOMAIN_OBC);
+    cmd_add("os_stats", obc_get_os_stats, "%d", 1, CMD_DOMAIN_OBC);
+    cmd_add("lock_stats", obc_get_lock_stats, "%d", 1, CMD_DOMAIN_OBC);
+    cmd_add("set_time", obc_set_time,"%d",1, CMD_DOMAIN_OBC);
+    cmd_add("show_time", obc_show_time,"%d",1, CMD_DOMAIN_OBC);
+    cmd_add("reset_wdt", obc_reset_wdt, "", 0, CMD_DOMAIN_WDT);
+    cmd_add("system", obc_system, "%s", 1, CMD_DOMAIN_OBC);
+    cmd_add("set_pwm_duty", obc_set_pwm_duty, "%d %d", 2, CMD_DOMAIN_OBC);
 }
 
-int obc_debug(char *fmt, char *params, int nparams)
+int obc_debug(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    int dbg_type;
-    if(sscanf(params, fmt, &dbg_type) == nparams)
+    if(args->argc == nparams)
     {
         #ifdef AVR32
+            int dbg_type = args->argv[0].i;
             switch(dbg_type)
             {
                 case 0: LED_Toggle(LED0); break;
@@ -51,6 +55,7 @@ int obc_debug(char *fmt, char *params, int nparams)
             }
         #endif
         #ifdef NANOMIND
+            int dbg_type = args->argv[0].i;
             if(dbg_type <= LED_A)
                 led_toggle((led_names_t)dbg_type);
         #endif
@@ -60,7 +65,7 @@ int obc_debug(char *fmt, char *params, int nparams)
             gpio_set_level(BLINK_GPIO, level);
         #endif
         #ifdef LINUX
-            LOGV(tag, "OBC Debug (%d)", dbg_type);
+            LOGV(tag, "OBC Debug (%d)", args->argv[0].i);
         #endif
         return CMD_OK;
     }
@@ -68,7 +73,7 @@ int obc_debug(char *fmt, char *params, int nparams)
     return CMD_FAIL;
 }
 
-int obc_reset_wdt(char *fmt, char *params, int nparams)
+int obc_reset_wdt(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     int rc = CMD_OK;
     #ifdef NANOMIND
@@ -80,12 +85,13 @@ int obc_reset_wdt(char *fmt, char *params, int nparams)
     return rc;
 }
 
-int obc_reset(char *fmt, char *params, int nparams)
+int obc_reset(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
     printf("Resetting system NOW!!\n");
+    dat_flush();  // Do not lose the pending status variables
 
     #ifdef LINUX
-        if(params != NULL && strcmp(params, "reboot")==0)
+        if(args->argc == 1 && strcmp(args->argv[0].s, "reboot")==0)
             system("sudo reboot");
         else
             exit(0);
@@ -101,8 +107,9 @@ int obc_reset(char *fmt, char *params, int nparams)
     return CMD_OK;
 }
 
-int obc_get_os_memory(char *fmt, char *params, int nparams)
+int obc_get_os_memory(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
+    cmd_print_pool_stats();
 
     #ifdef LINUX
         int c;
@@ -131,10 +138,101 @@ int obc_get_os_memory(char *fmt, char *params, int nparams)
     #endif
 }
 
-int obc_set_time(char* fmt, char* params,int nparams)
+int obc_get_lane_stats(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    int time_to_set;
-    if(sscanf(params, fmt, &time_to_set) == nparams){
+    const char *names[CMD_LANE_LAST] = {"critical", "ground", "fp", "hk"};
+    dispatcher_lane_stats_t stats;
+    int lane;
+
+    printf("%10s %8s %10s %10s %10s %10s %10s %8s\n", "lane", "count", "mean (us)", "min (us)",
+           "p99 (us)", "max (us)", "last (us)", "queued");
+    for(lane=0; lane<CMD_LANE_LAST; lane++)
+    {
+        dispatcher_get_lane_stats(lane, &stats);
+        printf("%10s %8u %10u %10u %10u %10u %10u %8d\n", names[lane], (unsigned int)stats.count,
+               stats.count ? (unsigned int)(stats.total_us/stats.count) : 0,
+               (unsigned int)stats.min_us, (unsigned int)dispatcher_lane_percentile(&stats, 99),
+               (unsigned int)stats.max_us, (unsigned int)stats.last_us,
+               cmd_lane_size(lane));
+    }
+
+    // Jitter of the dispatcher and executer path, ground commands
+    dispatcher_get_lane_stats(CMD_LANE_GROUND, &stats);
+    printf("Ground lane jitter (p99 - min): %u us, real-time mode: %d\n",
+           (unsigned int)(dispatcher_lane_percentile(&stats, 99) - stats.min_us), SCH_OS_RT_MODE);
+
+    cmd_send_stats_t send_stats;
+    cmd_get_send_stats(&send_stats);
+    printf("Coalesced commands: %u, dropped commands: %u\n",
+           (unsigned int)send_stats.coalesced, (unsigned int)send_stats.dropped);
+
+    // Optionally start a new measurement
+    if(args->argc == nparams && args->argv[0].i != 0)
+        dispatcher_reset_lane_stats();
+
+    return CMD_OK;
+}
+
+int obc_get_os_stats(char *fmt, char *params, int nparams, cmd_args_t *args)
+{
+    osTaskStats stats;
+    int i;
+
+    printf("%15s %5s %10s %8s %10s %10s %8s %10s %10s\n", "task", "alive", "cpu (ms)",
+           "wakeups", "mean (us)", "max (us)", "overruns", "stack", "stack used");
+    for(i=0; osTaskGetStats(i, &stats); i++)
+    {
+        printf("%15s %5d %10u %8u %10u %10u %8u %10u %10u\n", stats.name, stats.alive,
+               (unsigned int)(stats.cpu_us/1000), (unsigned int)stats.wakeups,
+               stats.latency_count ? (unsigned int)(stats.latency_total_us/stats.latency_count) : 0,
+               (unsigned int)stats.latency_max_us, (unsigned int)stats.overruns,
+               (unsigned int)stats.stack_size, (unsigned int)stats.stack_used);
+    }
+
+    // Optionally start a new measurement
+    if(args->argc == nparams && args->argv[0].i != 0)
+        osTaskResetStats();
+
+    return CMD_OK;
+}
+
+int obc_get_lock_stats(char *fmt, char *params, int nparams, cmd_args_t *args)
+{
+#if SCH_OS_LOCK_PROFILE
+    osLockProfile prof;
+    int i;
+
+    printf("%15s %10s %10s %7s %9s %9s %9s %9s %9s %9s\n", "lock", "takes",
+           "contended", "waiters", "wait p50", "wait p99", "wait max",
+           "hold mean", "hold p99", "hold max");
+    for(i=0; osLockProfileGet(i, &prof); i++)
+    {
+        printf("%15s %10u %10u %7u %9u %9u %9u %9u %9u %9u\n", prof.name,
+               (unsigned int)prof.acquisitions, (unsigned int)prof.contended,
+               (unsigned int)prof.max_waiters,
+               (unsigned int)osLockProfilePercentile(prof.wait_hist, prof.wait_max_us, 50),
+               (unsigned int)osLockProfilePercentile(prof.wait_hist, prof.wait_max_us, 99),
+               (unsigned int)prof.wait_max_us,
+               prof.acquisitions ? (unsigned int)(prof.hold_total_us/prof.acquisitions) : 0,
+               (unsigned int)osLockProfilePercentile(prof.hold_hist, prof.hold_max_us, 99),
+               (unsigned int)prof.hold_max_us);
+    }
+
+    // Optionally start a new measurement
+    if(args->argc == nparams && args->argv[0].i != 0)
+        osLockProfileReset();
+
+    return CMD_OK;
+#else
+    LOGW(tag, "Lock profiler disabled, build with SCH_OS_LOCK_PROFILE 1");
+    return CMD_FAIL;
+#endif
+}
+
+int obc_set_time(char *fmt, char *params, int nparams, cmd_args_t *args)
+{
+    if(args->argc == nparams){
+        int time_to_set = args->argv[0].i;
         int rc = dat_set_time(time_to_set);
         if (rc == 0)
             return CMD_OK;
@@ -148,11 +246,11 @@ int obc_set_time(char* fmt, char* params,int nparams)
     }
 }
 
-int obc_show_time(char* fmt, char* params,int nparams)
+int obc_show_time(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    int format;
-    if(sscanf(params, fmt, &format) == nparams)
+    if(args->argc == nparams)
     {
+        int format = args->argv[0].i;
         int rc = dat_show_time(format);
         if (rc == 0)
             return CMD_OK;
@@ -166,12 +264,12 @@ int obc_show_time(char* fmt, char* params,int nparams)
     }
 }
 
-int obc_system(char* fmt, char* params, int nparams)
+int obc_system(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
 #ifdef LINUX
-    if(params != NULL)
+    if(args->argc == nparams)
     {
-        int rc = system(params);
+        int rc = system(args->argv[0].s);
         if(rc < 0)
         {
             LOGE(tag, "Call to system failed! (%d)", rc)
@@ -194,13 +292,13 @@ int obc_system(char* fmt, char* params, int nparams)
 #endif
 }
 
-int obc_set_pwm_duty(char* fmt, char* params, int nparams)
+int obc_set_pwm_duty(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
 #ifdef NANOMIND
-    int channel;
-    int duty;
-    if(sscanf(params, fmt, &channel, &duty) == nparams)
+    if(args->argc == nparams)
     {
+        int channel = args->argv[0].i;
+        int duty = args->argv[1].i;
         LOGI(tag, "Setting duty %d to Channel %d", duty, channel);
         gs_pwm_enable(channel);
         gs_pwm_set_duty(channel, duty);
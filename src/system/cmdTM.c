@@ -24,23 +24,19 @@ static const char *tag = "cmdTM";
 
 void cmd_tm_init(void)
 {
-    cmd_add("send_status", tm_send_status, "%d", 1);
-    cmd_add("tm_parse_status", tm_parse_status, "", 0);
-    cmd_add("send_payload", tm_send_pay_data, "%u %d", 2);
+    cmd_add("send_status", tm_send_status, "%d", 1, CMD_DOMAIN_COM);
+    cmd_add("tm_parse_status", tm_parse_status, "%p", 1, CMD_DOMAIN_COM);
+    cmd_add("send_os_stats", tm_send_os_stats, "%d", 1, CMD_DOMAIN_COM);
+    cmd_add("tm_parse_os_stats", tm_parse_os_stats, "%p", 1, CMD_DOMAIN_COM);
+    cmd_add("send_payload", tm_send_pay_data, "%u %d", 2, CMD_DOMAIN_COM);
 }
 
-int tm_send_status(char *fmt, char *params, int nparams)
+int tm_send_status(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    if(params == NULL)
-    {
-        LOGE(tag, "params is null!");
-        return CMD_ERROR;
-    }
-
-    int dest_node;
     //Format: <node>
-    if(nparams == sscanf(params, fmt, &dest_node))
+    if(args->argc == nparams)
     {
+        int dest_node = args->argv[0].i;
         com_data_t data;
         memset(&data, 0, sizeof(data));
         data.node = (uint8_t)dest_node;
@@ -60,7 +56,8 @@ int tm_send_status(char *fmt, char *params, int nparams)
         assert(sizeof(status) < sizeof(data.frame.data));
         memcpy(data.frame.data.data8, &status, sizeof(status));
 
-        return com_send_data("", (char *)&data, 0);
+        cmd_args_t data_args = {.argc = 1, .argv[0].p = &data};
+        return com_send_data("%p", NULL, 1, &data_args);
     }
     else
     {
@@ -69,29 +66,94 @@ int tm_send_status(char *fmt, char *params, int nparams)
     }
 }
 
-int tm_parse_status(char *fmt, char *params, int nparams)
+int tm_parse_status(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    if(params == NULL)
+    if(args->argc != 1 || args->argv[0].p == NULL)
         return CMD_ERROR;
 
-    dat_status_t *status = (dat_status_t *)params;
+    dat_status_t *status = (dat_status_t *)args->argv[0].p;
     dat_print_status(status);
     return CMD_OK;
 }
 
-int tm_send_pay_data(char *fmt, char *params, int nparams)
+int tm_send_os_stats(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    if(params == NULL)
+    //Format: <node>
+    if(args->argc != nparams)
+    {
+        LOGW(tag, "Invalid args!");
+        return CMD_FAIL;
+    }
+
+    int dest_node = args->argv[0].i;
+    com_data_t data;
+    osTaskStats stats;
+    tm_os_stats_t *records = (tm_os_stats_t *)&data.frame.data.data32[1];
+    int index = 0, frame = 0, rc = CMD_OK;
+    uint32_t n;
+
+    assert(TM_OS_STATS_PER_FRAME > 0);
+    do
     {
-        LOGE(tag, "params is null!");
+        memset(&data, 0, sizeof(data));
+        data.node = (uint8_t)dest_node;
+        data.frame.frame = (uint16_t)frame++;
+        data.frame.type = TM_TYPE_OS_STATS;
+
+        // Pack up to TM_OS_STATS_PER_FRAME tasks in this frame
+        for(n=0; n<TM_OS_STATS_PER_FRAME && osTaskGetStats(index, &stats); n++, index++)
+        {
+            strncpy(records[n].name, stats.name, sizeof(records[n].name)-1);
+            records[n].cpu_ms = (uint32_t)(stats.cpu_us/1000);
+            records[n].wakeups = stats.wakeups;
+            records[n].latency_max_us = stats.latency_max_us;
+            records[n].overruns = stats.overruns;
+            records[n].stack_used = stats.stack_used;
+        }
+        data.frame.data.data32[0] = n;
+
+        if(n > 0 || frame == 1)
+        {
+            cmd_args_t data_args = {.argc = 1, .argv[0].p = &data};
+            if(com_send_data("%p", NULL, 1, &data_args) != CMD_OK)
+                rc = CMD_FAIL;
+        }
+    }
+    while(n == TM_OS_STATS_PER_FRAME);
+
+    return rc;
+}
+
+int tm_parse_os_stats(char *fmt, char *params, int nparams, cmd_args_t *args)
+{
+    if(args->argc != 1 || args->argv[0].p == NULL)
         return CMD_ERROR;
+
+    uint32_t *data32 = (uint32_t *)args->argv[0].p;
+    tm_os_stats_t *records = (tm_os_stats_t *)&data32[1];
+    uint32_t n = data32[0], i;
+    if(n > TM_OS_STATS_PER_FRAME)
+        return CMD_ERROR;
+
+    printf("%8s %10s %8s %10s %8s %10s\n", "task", "cpu (ms)", "wakeups", "max (us)", "overruns", "stack used");
+    for(i=0; i<n; i++)
+    {
+        records[i].name[sizeof(records[i].name)-1] = '\0';
+        printf("%8s %10u %8u %10u %8u %10u\n", records[i].name,
+               (unsigned int)records[i].cpu_ms, (unsigned int)records[i].wakeups,
+               (unsigned int)records[i].latency_max_us, (unsigned int)records[i].overruns,
+               (unsigned int)records[i].stack_used);
     }
+    return CMD_OK;
+}
 
-    int dest_node;
-    uint32_t payload;
-    //Format: <node>
-    if(nparams == sscanf(params, fmt, &payload, &dest_node))
+int tm_send_pay_data(char *fmt, char *params, int nparams, cmd_args_t *args)
+{
+    //Format: <payload> <node>
+    if(args->argc == nparams)
     {
+        uint32_t payload = args->argv[0].u;
+        int dest_node = args->argv[1].i;
         com_data_t data;
         memset(&data, 0, sizeof(data));
         data.node = (uint8_t)dest_node;
@@ -119,7 +181,8 @@ int tm_send_pay_data(char *fmt, char *params, int nparams)
                 break;
         }
 
-        return com_send_data("", (char *)&data, 0);
+        cmd_args_t data_args = {.argc = 1, .argv[0].p = &data};
+        return com_send_data("%p", NULL, 1, &data_args);
     }
     else
     {
@@ -55,9 +55,10 @@ void cmd_com_init(void);
  * @param fmt Str. Parameters format "%d"
  * @param param Str. Parameters as string: <node>. Ex: "10"
  * @param nparams Int. Number of parameters 1
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int com_ping(char *fmt, char *param, int nparams);
+int com_ping(char *fmt, char *param, int nparams, cmd_args_t *args);
 
 /**
  * Send a message using the digi-repeater port, so its expect to receive the
@@ -66,9 +67,10 @@ int com_ping(char *fmt, char *param, int nparams);
  * @param fmt Str. Parameters format "%d %s"
  * @param param Str. Parameters as string: "<node> <message>". Ex: "10 Hi!"
  * @param nparams Int. Number of parameters 2
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int com_send_rpt(char *fmt, char *param, int nparams);
+int com_send_rpt(char *fmt, char *param, int nparams, cmd_args_t *args);
 
 /**
  * Send a command to node using the port assigned to console commands. It
@@ -77,9 +79,10 @@ int com_send_rpt(char *fmt, char *param, int nparams);
  * @param fmt Str. Parameters format "%d %s"
  * @param param Str. Parameters as string: "<node> <command> [parameters]". Ex: "10 help"
  * @param nparams Int. Number of parameters 2
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int com_send_cmd(char *fmt, char *param, int nparams);
+int com_send_cmd(char *fmt, char *param, int nparams, cmd_args_t *args);
 
 /**
  * Sends telemetry data using CSP. Data is received in @params as binary, packed
@@ -89,6 +92,7 @@ int com_send_cmd(char *fmt, char *param, int nparams);
  * @param fmt Str. Parameters format: "" (not used)
  * @param params com_data_t *. Pointer to a com_data_t structure.
  * @param nparams int. Number of parameters: 1
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK if executed correctly (data was sent and confirmed)
  * or CMD_FAIL in case of errors.
  *
@@ -107,16 +111,17 @@ int com_send_cmd(char *fmt, char *param, int nparams);
  *      cmd_send(send_cmd);
  * @endcode
  */
-int com_send_data(char *fmt, char *params, int nparams);
+int com_send_data(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Show CSP debug information, currently the route table and interfaces
  * @param fmt Not used
  * @param params Not used
  * @param nparams Not used
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK
  */
-int com_debug(char *fmt, char *params, int nparams);
+int com_debug(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Reset the TRX GND Watchdog timer at @node node by sending a CSP command to the
@@ -127,6 +132,7 @@ int com_debug(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format: "%d"
  * @param params Str. Parameters: [node], the TRX node number
  * @param nparams Str. Number of parameters: 0|1
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK if executed correctly or CMD_FAIL in case of errors.
  *
  * @code
@@ -145,7 +151,7 @@ int com_debug(char *fmt, char *params, int nparams);
  *
  * @endcode
  */
-int com_reset_wdt(char *fmt, char *params, int nparams);
+int com_reset_wdt(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Print TRX housekeeping information
@@ -154,9 +160,10 @@ int com_reset_wdt(char *fmt, char *params, int nparams);
  * @param fmt
  * @param params
  * @param nparams
+ * @param args cmd_args_t *. Parsed parameters
  * @return
  */
-int com_get_hk(char *fmt, char *params, int nparams);
+int com_get_hk(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Get TRX settings values. The TRX has a list of parameters to set and
@@ -167,6 +174,7 @@ int com_get_hk(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format: "%s"
  * @param params Str. Parameters: <param_name>, the parameter name
  * @param nparams Str. Number of parameters: 1
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK if executed correctly or CMD_FAIL in case of errors.
  *
  * @code
@@ -181,7 +189,7 @@ int com_get_hk(char *fmt, char *params, int nparams);
  * @endcode
  *
  */
-int com_get_config(char *fmt, char *params, int nparams);
+int com_get_config(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Set TRX settings values. The TRX has a list of parameters to set and
@@ -193,6 +201,7 @@ int com_get_config(char *fmt, char *params, int nparams);
  * @param params Str. Parameters: <param_name> <param_value>, the parameter name
  * and value as strings.
  * @param nparams Str. Number of parameters: 2
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK if executed correctly or CMD_FAIL in case of errors.
  *
  * @code
@@ -207,8 +216,8 @@ int com_get_config(char *fmt, char *params, int nparams);
  * @endcode
  *
  */
-int com_set_config(char *fmt, char *params, int nparams);
+int com_set_config(char *fmt, char *params, int nparams, cmd_args_t *args);
 
-int com_update_status_vars(char *fmt, char *params, int nparams);
+int com_update_status_vars(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 #endif /* CMD_COM_H */
@@ -25,9 +25,10 @@ void cmd_console_init(void);
  * @param fmt Str. Parameters format "%s"
  * @param params Str. Parameters as string "test"
  * @param nparams Int. Number of parameters 1
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int con_debug_msg(char *fmt, char *params, int nparams);
+int con_debug_msg(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Show the list of available commands, id and parameters format
@@ -35,8 +36,9 @@ int con_debug_msg(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int con_help(char *fmt, char *params, int nparams);
+int con_help(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 #endif /* CMD_CONSOLE_H */
@@ -47,9 +47,10 @@ void cmd_drp_init(void);
  * @param fmt Str. Parameters format: "%d"
  * @param params Str. Parameters as string: "<MAGIC_NUMBER>"
  * @param nparams Int. Number of parameters: 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int drp_execute_before_flight(char *fmt, char *params, int nparams);
+int drp_execute_before_flight(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Display system related variables. Variables are read from system variables
@@ -58,9 +59,10 @@ int drp_execute_before_flight(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int drp_print_system_vars(char *fmt, char *params, int nparams);
+int drp_print_system_vars(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Update a system status variable <value> by <index>
@@ -68,9 +70,10 @@ int drp_print_system_vars(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format "%d %d"
  * @param params Str. Parameters as string "<index> <value>"
  * @param nparams Int. Number of parameters 2
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int drp_update_sys_var_idx(char *fmt, char *params, int nparams);
+int drp_update_sys_var_idx(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Update current hours alive and hours without reset counters adding <value>
@@ -79,9 +82,10 @@ int drp_update_sys_var_idx(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format "%d"
  * @param params Str. Parameters as string "<value>"
  * @param nparams Int. Number of parameters 1
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int drp_update_hours_alive(char *fmt, char *params, int nparams);
+int drp_update_hours_alive(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Clear the GND watchdog timer counter to prevent the system reset. This
@@ -90,9 +94,10 @@ int drp_update_hours_alive(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int drp_clear_gnd_wdt(char *fmt, char *params, int nparams);
+int drp_clear_gnd_wdt(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Read OBC sensors, print the results and save the values to status repository.
@@ -101,9 +106,10 @@ int drp_clear_gnd_wdt(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int drp_sample_obc_sensors(char *fmt, char *params, int nparams);
+int drp_sample_obc_sensors(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Tests the data repository functioning, sets a value for every system status
@@ -111,8 +117,35 @@ int drp_sample_obc_sensors(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int drp_test_system_vars(char *fmt, char *params, int nparams);
+int drp_test_system_vars(char *fmt, char *params, int nparams, cmd_args_t *args);
+
+/**
+ * Commits the pending status variables writes to the storage (@relatesalso
+ * dat_flush). Use before a commanded reset or power cycle.
+ *
+ * @param fmt Str. Parameters format ""
+ * @param params Str. Parameters as string ""
+ * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
+ * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
+ */
+int drp_flush_system_vars(char *fmt, char *params, int nparams, cmd_args_t *args);
+
+/**
+ * Prints the status variables write statistics: variables written, writes
+ * coalesced in the cache, writes of volatile variables, values and commits
+ * sent to the storage, and the
+ * commits saved compared with committing every copy of every write.
+ *
+ * @param fmt Str. Parameters format "%d"
+ * @param params Str. Parameters as string "<reset>", 1 to reset the statistics
+ * @param nparams Int. Number of parameters 1
+ * @param args cmd_args_t *. Parsed parameters
+ * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
+ */
+int drp_get_flush_stats(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 #endif /* CMD_DRP_H */
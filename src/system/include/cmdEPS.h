@@ -32,9 +32,10 @@ void cmd_eps_init(void);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int eps_hard_reset(char *fmt, char *params, int nparams);
+int eps_hard_reset(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Get and pretty print EPS housekeeping information like voltage, current, etc.
@@ -42,9 +43,10 @@ int eps_hard_reset(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int eps_get_hk(char *fmt, char *params, int nparams);
+int eps_get_hk(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Get and pretty print EPS settings.
@@ -52,9 +54,10 @@ int eps_get_hk(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int eps_get_config(char *fmt, char *params, int nparams);
+int eps_get_config(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Set the the heater modes. NanoPower P31u can control the on-board heaters
@@ -64,6 +67,7 @@ int eps_get_config(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format "%d %d>"
  * @param params Str. Parameters as string "<heater> <mode>", ex: "1 1"
  * @param nparams Int. Number of parameters 2
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  *
  * @code
@@ -82,7 +86,7 @@ int eps_get_config(char *fmt, char *params, int nparams);
  *      cmd_send(send_cmd);
  * @endcode
  */
-int eps_set_heater(char *fmt, char *params, int nparams);
+int eps_set_heater(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Update EPS related status system vars.
@@ -91,8 +95,9 @@ int eps_set_heater(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int eps_update_status_vars(char *fmt, char *params, int nparams);
+int eps_update_status_vars(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 #endif //CMDEPS_H
@@ -32,9 +32,10 @@ void cmd_fp_init(void);
  * @param fmt Str. Parameters format "%d %d %d %d %d %d %s %s %d %d"
  * @param params Str. Parameters as string "<day> <month> <year> <hour> <min> <sec> <command> <args> <executions> <periodical>"
  * @param nparams Int. Number of parameters 10
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int fp_set(char *fmt, char *params, int nparams);
+int fp_set(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Delete a command in the flight plan by the execution time
@@ -42,9 +43,10 @@ int fp_set(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format "%d %d %d %d %d %d"
  * @param params Str. Parameters as string "<day> <month> <year> <hour> <min> <sec>"
  * @param nparams Int. Number of parameters 6
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int fp_delete(char* fmt, char* params, int nparams);
+int fp_delete(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Show all the commands presents in the flight plan
@@ -52,9 +54,10 @@ int fp_delete(char* fmt, char* params, int nparams);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int fp_show(char* fmt, char* params, int nparams);
+int fp_show(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Reset the current flight plan, in other words, create a new empty flight plan
@@ -62,9 +65,10 @@ int fp_show(char* fmt, char* params, int nparams);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int fp_reset(char* fmt, char* params, int nparams);
+int fp_reset(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Test that the command parameters are well read
@@ -72,8 +76,9 @@ int fp_reset(char* fmt, char* params, int nparams);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int test_fp_params(char* fmt, char* params,int nparams);
+int test_fp_params(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 #endif //CMD_FLIGHTPLAN_H
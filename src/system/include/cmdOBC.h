@@ -39,6 +39,7 @@
 
 #include "repoCommand.h"
 #include "os.h"
+#include "osThread.h"
 
 /**
  * Register on board computer related (OBC) commands
@@ -53,9 +54,10 @@ void cmd_obc_init(void);
  * @param fmt Str. Parameters format "d"
  * @param params Str. Parameters as string "1"
  * @param nparams Int. Number of parameters 1
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int obc_debug(char *fmt, char *params, int nparams);
+int obc_debug(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Reset the watchdog timer
@@ -63,9 +65,10 @@ int obc_debug(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int obc_reset_wdt(char *fmt, char *params, int nparams);
+int obc_reset_wdt(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Reset (reboot) the system.
@@ -77,21 +80,73 @@ int obc_reset_wdt(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format: "%s"
  * @param params Str. Parameters as string: "" or "reboot" in Linux to actually
  *                    reboot the system.
- * @param nparams Int. Number of parameters 0 or 1
+ * @param nparams Int. Number of parameters 1, the parameter is optional
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int obc_reset(char *fmt, char *params, int nparams);
+int obc_reset(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
- * Debug system memory
+ * Debug system memory. Prints the command pools statistics and the OS memory
  * @note: In POSIX just cat /proc/<id>/status file
  *
  * @param fmt Str. Parameters format ""
  * @param params Str. Parameters as string ""
  * @param nparams Int. Number of parameters 0
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int obc_get_os_memory(char *fmt, char *params, int nparams);
+int obc_get_os_memory(char *fmt, char *params, int nparams, cmd_args_t *args);
+
+/**
+ * Prints the queueing latency of each dispatcher lane, from cmd_send_lane
+ * until the command starts its execution. Use it to check that the critical
+ * lane (watchdog) is never starved by the other producers. The minimum and
+ * 99th percentile latency of the ground lane give the jitter of the
+ * dispatcher and executer path (@see SCH_OS_RT_MODE). Also prints the number
+ * of commands waiting in each lane and the number of coalesced and dropped
+ * commands (@see cmd_set_coalesce).
+ *
+ * @param fmt Str. Parameters format "%d"
+ * @param params Str. Parameters as string "[reset]", 1 to clear the statistics
+ * after printing them, optional
+ * @param nparams Int. Number of parameters 1
+ * @param args cmd_args_t *. Parsed parameters
+ * @return  CMD_OK
+ */
+int obc_get_lane_stats(char *fmt, char *params, int nparams, cmd_args_t *args);
+
+/**
+ * Prints the execution statistics of each task created with osCreateTask:
+ * CPU time, number of wake ups, mean and max. scheduling latency (from the
+ * time the task should wake up until it runs), osTaskDelayUntil and timer
+ * overruns, and the stack high water mark. Use it to find busy tasks and to
+ * size the task stacks. @see tm_send_os_stats to download the same data.
+ *
+ * @param fmt Str. Parameters format "%d"
+ * @param params Str. Parameters as string "[reset]", 1 to clear the wake up,
+ * latency and overrun counters after printing them, optional
+ * @param nparams Int. Number of parameters 1
+ * @param args cmd_args_t *. Parsed parameters
+ * @return  CMD_OK
+ */
+int obc_get_os_stats(char *fmt, char *params, int nparams, cmd_args_t *args);
+
+/**
+ * Prints the lock contention profile of the named semaphores (data and
+ * command repositories, dispatcher and log): takes, contended takes, max.
+ * waiting tasks, wait time percentiles and hold time in microseconds.
+ * Percentiles are the upper limit of a power of two bucket. Requires a build
+ * with SCH_OS_LOCK_PROFILE 1.
+ *
+ * @param fmt Str. Parameters format "%d"
+ * @param params Str. Parameters as string "[reset]", 1 to clear the profiles
+ * after printing them, optional
+ * @param nparams Int. Number of parameters 1
+ * @param args cmd_args_t *. Parsed parameters
+ * @return  CMD_OK, or CMD_FAIL if the profiler is disabled
+ */
+int obc_get_lock_stats(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Set the system time only if is not running Linux
@@ -99,9 +154,10 @@ int obc_get_os_memory(char *fmt, char *params, int nparams);
  * @param fmt Str. Parameters format "%d"
  * @param params Str. Parameters as string "<time to set>"
  * @param nparams Int. Number of parameters 1
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int obc_set_time(char* fmt, char* params,int nparams);
+int obc_set_time(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Show the system time in the format given. Param equal 0 is ISO format,
@@ -110,9 +166,10 @@ int obc_set_time(char* fmt, char* params,int nparams);
  * @param fmt Str. Parameters format "%d"
  * @param params Str. Parameters as string "<format>"
  * @param nparams Int. Number of parameters 1
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int obc_show_time(char* fmt, char* params,int nparams);
+int obc_show_time(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Execute a shell command by calling system(). No check are performed over the
@@ -122,9 +179,10 @@ int obc_show_time(char* fmt, char* params,int nparams);
  * @param fmt str. Parameters format: "%s"
  * @param params  str. Parameters, the system command to execute: eg: "echo hello world"
  * @param nparams int. Number of parameters: 1
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int obc_system(char* fmt, char* params, int nparams);
+int obc_system(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  *
@@ -133,9 +191,10 @@ int obc_system(char* fmt, char* params, int nparams);
  * @param fmt Str. Parameters format "%d %s %d"
  * @param params Str. Parameters as string "<int> <string> <int>"
  * @param nparams Int. Number of parameters 3
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int test_fp(char* fmt, char* params,int nparams);
+int test_fp(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Change duty cycle of pwm in channel
@@ -145,8 +204,9 @@ int test_fp(char* fmt, char* params,int nparams);
  * @param fmt str. Parameters format: "%d %d"
  * @param params  str. Parameters as string <int> <int>,
  * @param nparams int. Number of parameters: 2
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int obc_set_pwm_duty(char* fmt, char* params, int nparams);
+int obc_set_pwm_duty(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 #endif /* CMD_OBC_H */
@@ -17,11 +17,32 @@
 #include "repoCommand.h"
 #include "repoData.h"
 #include "cmdCOM.h"
+#include "osThread.h"
 
 #define TM_TYPE_GENERIC 0
 #define TM_TYPE_STATUS  1
+#define TM_TYPE_OS_STATS 2
 #define TM_TYPE_PAYLOAD 10
 
+/**
+ * Compact task statistics sent by tm_send_os_stats. Only 32 bits fields, the
+ * frame is sent as 32 bits words.
+ */
+typedef struct tm_os_stats_s {
+    char name[8];               ///< First 7 chars of the task name
+    uint32_t cpu_ms;            ///< CPU time (ms)
+    uint32_t wakeups;           ///< Number of wake ups
+    uint32_t latency_max_us;    ///< Max. scheduling latency (us)
+    uint32_t overruns;          ///< Delay until and timer overruns
+    uint32_t stack_used;        ///< Stack high water mark (bytes)
+} tm_os_stats_t;
+
+/**
+ * Task statistics per frame. The first word of the frame is the number of
+ * tasks in the frame.
+ */
+#define TM_OS_STATS_PER_FRAME ((COM_FRAME_MAX_LEN - sizeof(uint32_t))/sizeof(tm_os_stats_t))
+
 /**
  * Register TM commands
  */
@@ -35,9 +56,10 @@ void cmd_tm_init(void);
  * @param fmt Str. Parameters format: "%d"
  * @param param Str. Parameters as string, node to send TM: <node>. Ex: "10"
  * @param nparams Int. Number of parameters: 1
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int tm_send_status(char *fmt, char *params, int nparams);
+int tm_send_status(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Parses a status variables telemetry, @seealso tm_send_status.
@@ -46,17 +68,45 @@ int tm_send_status(char *fmt, char *params, int nparams);
  * @param param char *. Parameters as pointer to raw data. Receives a
  * status_t structure
  * @param nparams Int. Not used.
+ * @param args cmd_args_t *. Parsed parameters
+ * @return CMD_OK if executed correctly or CMD_FAIL in case of errors
+ */
+int tm_parse_status(char *fmt, char *params, int nparams, cmd_args_t *args);
+
+/**
+ * Send the execution statistics of the system tasks (@see osTaskGetStats) as
+ * telemetry. Tasks are packed as tm_os_stats_t records, TM_OS_STATS_PER_FRAME
+ * per frame, so several frames are sent if needed (frame number 0, 1, ...).
+ * To parse the data @seealso tm_parse_os_stats
+ *
+ * @param fmt Str. Parameters format: "%d"
+ * @param param Str. Parameters as string, node to send TM: <node>. Ex: "10"
+ * @param nparams Int. Number of parameters: 1
+ * @param args cmd_args_t *. Parsed parameters
  * @return CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int tm_parse_status(char *fmt, char *params, int nparams);
+int tm_send_os_stats(char *fmt, char *params, int nparams, cmd_args_t *args);
+
+/**
+ * Parses a task statistics telemetry frame, @seealso tm_send_os_stats.
+ *
+ * @param fmt Str. Not used.
+ * @param param char *. Parameters as pointer to raw data. Receives the frame
+ * data, the number of tasks and the tm_os_stats_t records
+ * @param nparams Int. Not used.
+ * @param args cmd_args_t *. Parsed parameters
+ * @return CMD_OK if executed correctly or CMD_ERROR in case of errors
+ */
+int tm_parse_os_stats(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Send data stored as payload. TODO: complete docs
  * @param fmt
  * @param params
  * @param nparams
+ * @param args cmd_args_t *. Parsed parameters
  * @return
  */
-int tm_send_pay_data(char *fmt, char *params, int nparams);
+int tm_send_pay_data(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 #endif //CMDTM_H
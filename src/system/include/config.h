@@ -67,6 +67,9 @@
 #define SCH_STORAGE_MODE        1    ///< Status repository location. (0) RAM, (1) Single external.
 #define SCH_STORAGE_TRIPLE_WR   1    ///< Tripled writing enabled (0 | 1)
 #define SCH_STORAGE_FILE        "/tmp/suchai.db"   ///< File to store the database, only if @SCH_STORAGE_MODE is 1
+#define SCH_STORAGE_CACHE       1                  ///< RAM copy of the status variables, reads do not access the storage (0 | 1). Only if @SCH_STORAGE_MODE is 1
+#define SCH_STORAGE_FLUSH_MS    (1000)             ///< Max. time (ms) written status variables wait in the cache before being committed to the storage in one transaction, 0 to write through. Only if @SCH_STORAGE_CACHE is 1
+#define SCH_STORAGE_FLUSH_WRITES (64)              ///< Number of written status variables that forces a commit before @SCH_STORAGE_FLUSH_MS
 
 #define SCH_SECTIONS_PER_PAYLOAD 2 /// TODO: Make configurable per payload
 #define SCH_SIZE_PER_SECTION 256*1024
@@ -91,11 +94,50 @@
 #define SCH_TASK_HKP_STACK        (5*256)   ///< Housekeeping task stack size in words
 #define SCH_TASK_CSP_STACK        (5*256)     ///< CSP route task stack size in words
 
+/**
+ * Real-time mode and CPU affinity (GNU/Linux only, ignored in FreeRTOS).
+ * In real-time mode the memory is locked (mlockall) and pre-faulted before
+ * the tasks are created, so tasks do not page fault after start up. Each task
+ * can be pinned to one CPU, -1 to let it run in any CPU. Executers share the
+ * same CPU setting. The watchdog and housekeeping work runs in the timer task
+ * (osTimer), their own tasks only start the timers and end.
+ */
+#define SCH_OS_RT_MODE            0         ///< Real-time mode enabled (0 | 1)
+#define SCH_OS_RT_HEAP_RESERVE    (1024*1024) ///< Heap bytes pre-faulted in real-time mode
+#define SCH_TASK_DIS_CPU          (-1)      ///< Dispatcher task CPU
+#define SCH_TASK_EXE_CPU          (-1)      ///< Executer tasks CPU
+#define SCH_TASK_INI_CPU          (-1)      ///< Init task CPU
+#define SCH_TASK_COM_CPU          (-1)      ///< Communications task CPU
+#define SCH_TASK_FPL_CPU          (-1)      ///< Flight plan task CPU
+#define SCH_TASK_CON_CPU          (-1)      ///< Console task CPU
+#define SCH_TASK_TMR_CPU          (-1)      ///< Timer task CPU (watchdog, housekeeping, storage flush)
+
 #define SCH_BUFF_MAX_LEN          (256)     ///< General buffers max length in bytes
 #define SCH_BUFFERS_CSP           (5)       ///< Number of available CSP buffers
+#define SCH_BUFFERS_CSP_FREE      (2)       ///< Min. free CSP buffers to execute TCs without copying the packet
 #define SCH_FP_MAX_ENTRIES        (25)      ///< Max number of flight plan entries
 #define SCH_CMD_MAX_ENTRIES       (50)      ///< Max number of commands in the repository
 #define SCH_CMD_MAX_STR_PARAMS    (64)      ///< Limit for the parameters length
+#define SCH_CMD_MAX_ARGS          (10)      ///< Max number of parameters of a command
+#define SCH_CMD_POOL_ENTRIES      (32)      ///< Number of commands pre-allocated in the command pool
+#define SCH_CMD_POOL_SMALL_PARAMS (32)      ///< Number of pre-allocated parameters buffers of SCH_CMD_MAX_STR_PARAMS bytes
+#define SCH_CMD_POOL_LARGE_PARAMS (8)       ///< Number of pre-allocated parameters buffers of SCH_BUFF_MAX_LEN bytes
+#define SCH_CMD_DELIMITER         (';')     ///< Separates several commands in a TC frame or console line
+#define SCH_CMD_MAX_BATCH         (16)      ///< Max number of commands in a TC frame or console line
+#define SCH_CMD_EXE_WORKERS       (4)       ///< Number of executer tasks, commands of different domains run concurrently
+#define SCH_CMD_LANE_CRITICAL_DEPTH (4)   ///< Commands queued in the critical dispatcher lane (watchdog)
+#define SCH_CMD_LANE_GROUND_DEPTH (16)    ///< Commands queued in the ground dispatcher lane (TCs and console)
+#define SCH_CMD_LANE_FP_DEPTH     (8)     ///< Commands queued in the flight plan dispatcher lane
+#define SCH_CMD_LANE_HK_DEPTH     (8)     ///< Commands queued in the housekeeping dispatcher lane
+#define SCH_CMD_LANE_GROUND_WEIGHT (4)    ///< Ground lane commands dispatched per turn, 0 for strict priority
+#define SCH_CMD_LANE_FP_WEIGHT    (2)     ///< Flight plan lane commands dispatched per turn, 0 for strict priority
+#define SCH_CMD_LANE_HK_WEIGHT    (1)     ///< Housekeeping lane commands dispatched per turn, 0 for strict priority
+#define SCH_CMD_COALESCE_ENTRIES  (8)     ///< Max number of pending coalescible commands tracked to merge duplicates
+#define SCH_OS_TIMER_MAX_ENTRIES  (16)    ///< Max number of osTimer timers running at the same time (Linux)
+#define SCH_OS_TASK_MAX_ENTRIES   (32)    ///< Max number of tasks in the osTaskGetStats registry
+#define SCH_OS_TASK_STACK_MIN     (256*1024) ///< Min. task stack size in bytes (Linux), stacks are painted to measure their use
+#define SCH_OS_LOCK_PROFILE       0       ///< Lock contention profiler in osSemaphoreTake/Given (0 | 1)
+#define SCH_OS_LOCK_MAX_ENTRIES   (16)    ///< Max number of named semaphores in the lock profiler
 
 
 #endif //SUCHAI_CONFIG_H
@@ -14,7 +14,6 @@
 
 osQueue dispatcher_queue;     ///< Commands queue
 osQueue executer_cmd_queue;   ///< Executer commands queue
-osQueue executer_stat_queue;  ///< Executer result queue
 osSemaphore repo_data_sem;    ///< Data repository mutex
 osSemaphore repo_cmd_sem;     ///< Command repository mutex
 
@@ -12,35 +12,34 @@
 #define CMD_REPO_H
 
 #include <stdarg.h>
+#include <stdint.h>
+#include <ctype.h>
 
 #include "utils.h"
 #include "globals.h"
-
-/* Add files with commands */
-#include "cmdOBC.h"
-#include "cmdDRP.h"
-#include "cmdConsole.h"
-#include "cmdEPS.h"
-
-#if SCH_FP_ENABLED
-    #include "cmdFP.h"
-#endif
-#if SCH_COMM_ENABLE
-    #include "cmdCOM.h"
-    #include "cmdTM.h"
-#endif
-#if SCH_TEST_ENABLED
-    #include "cmdTestCommand.h"
-#endif
+#include "osPool.h"
+#include "osDelay.h"
 
 /* Macros */
 /**
- * Send command to execution using dispatcherQueue (must be initialized). Blocks
- * if the queue is full
+ * Send command to execution using the ground lane of the dispatcher (must be
+ * initialized by cmd_repo_init). Blocks if the lane is full
+ * (@see cmd_send_lane).
  *
  * @param cmd *cmd_type, pointer to command
  */
-#define cmd_send(cmd) osQueueSend(dispatcher_queue, &cmd, portMAX_DELAY);
+#define cmd_send(cmd) cmd_send_lane(cmd, CMD_LANE_GROUND)
+
+/**
+ * Send several commands to execution at once using the ground lane of the
+ * dispatcher (must be initialized by cmd_repo_init). The lane is locked and
+ * the dispatcher is notified only once. Blocks if the lane is full.
+ *
+ * @param cmds cmd_t **, array of pointers to commands
+ * @param n Int. Number of commands in @cmds
+ * @return Int. Number of commands sent
+ */
+#define cmd_send_batch(cmds, n) cmd_send_lane_batch(cmds, n, CMD_LANE_GROUND)
 
 /* Command definitions */
 /**
@@ -50,10 +49,103 @@
 #define CMD_FAIL 0      ///< Command not executed as expected
 #define CMD_ERROR -1    ///< Command returned an error
 
+/**
+ * Value of a command parameter. The member to use depends on the conversion
+ * specifier of the parameter in the command format.
+ */
+typedef union cmd_arg{
+    int32_t i;                  ///< %d, %i
+    uint32_t u;                 ///< %u, %x
+    float f;                    ///< %f
+    char *s;                    ///< %s, NULL terminated string
+    void *p;                    ///< %p, raw data (@see cmd_add_params_raw)
+} cmd_arg_t;
+
+/**
+ * List of parameters already parsed according to the command format. Each
+ * command function receive its parameters this way, so it is not required to
+ * parse the parameters string again.
+ *
+ * @code
+ *      // Command foo with format "%d %s"
+ *      int foo(char *fmt, char *params, int nparams, cmd_args_t *args)
+ *      {
+ *          if(args->argc != nparams)
+ *              return CMD_FAIL;
+ *          printf("%d %s", args->argv[0].i, args->argv[1].s);
+ *          return CMD_OK;
+ *      }
+ * @endcode
+ */
+typedef struct cmd_args{
+    int argc;                           ///< Number of parameters parsed successfully
+    cmd_arg_t argv[SCH_CMD_MAX_ARGS];   ///< Parameters values
+} cmd_args_t;
+
+/**
+ * Resource domains. Commands of different domains are executed concurrently
+ * by the executer tasks, while commands of the same domain are executed one
+ * at a time in the order they were sent.
+ */
+typedef enum cmd_domain{
+    CMD_DOMAIN_OBC = 0,         ///< On board computer: debug, time, system calls, resets
+    CMD_DOMAIN_WDT,             ///< Watchdog timer, never waits for other commands
+    CMD_DOMAIN_COM,             ///< Communications system and telemetry
+    CMD_DOMAIN_EPS,             ///< Electrical power system
+    CMD_DOMAIN_STORAGE,         ///< Data repository and flight plan
+    CMD_DOMAIN_LAST             ///< Number of domains, not a valid domain
+} cmd_domain_t;
+
+/**
+ * Dispatcher priority lanes. Each producer sends its commands to its own lane
+ * (@see cmd_send_lane), so a burst of commands of one producer does not delay
+ * the commands of the others. The critical lane is always served first, the
+ * other lanes share the executers according to their weights
+ * (SCH_CMD_LANE_*_WEIGHT).
+ */
+typedef enum cmd_lane{
+    CMD_LANE_CRITICAL = 0,      ///< Watchdog and resets, never waits for other lanes
+    CMD_LANE_GROUND,            ///< Ground TCs and console, the default lane
+    CMD_LANE_FP,                ///< Flight plan
+    CMD_LANE_HK,                ///< Housekeeping
+    CMD_LANE_LAST               ///< Number of lanes, not a valid lane
+} cmd_lane_t;
+
 /**
  *  Defines the prototype of a command
  */
-typedef int (*cmdFunction)(char *fmt, char *params, int nparams);
+typedef int (*cmdFunction)(char *fmt, char *params, int nparams, cmd_args_t *args);
+
+/**
+ * Defines the prototype of a function that releases the storage of the
+ * parameters of a command (@see cmd_parse_from_buff)
+ */
+typedef void (*cmdRelease)(void *owner);
+
+/**
+ * Defines the prototype of a command completion callback. It is called by the
+ * executer after the command is executed, with the command result, or by the
+ * dispatcher with CMD_ERROR if the command was rejected (@see cmd_set_callback)
+ */
+struct cmd_type;
+typedef void (*cmdCallback)(struct cmd_type *cmd, int result, void *arg);
+
+/* Add files with commands, after the command prototype definition */
+#include "cmdOBC.h"
+#include "cmdDRP.h"
+#include "cmdConsole.h"
+#include "cmdEPS.h"
+
+#if SCH_FP_ENABLED
+    #include "cmdFP.h"
+#endif
+#if SCH_COMM_ENABLE
+    #include "cmdCOM.h"
+    #include "cmdTM.h"
+#endif
+#if SCH_TEST_ENABLED
+    #include "cmdTestCommand.h"
+#endif
 
 /**
  * Structure to store a command sent to
@@ -63,7 +155,18 @@ typedef struct cmd_type{
     int id;                     ///< Command id
     int nparams;                ///< Number of parameters
     char *fmt;                  ///< Format of parameters
-    char *params;               ///< List of parameters (use malloc)
+    char *schema;               ///< Format compiled by cmd_add, one conversion char per parameter
+    char *params;               ///< List of parameters (use cmd_add_params_*)
+    cmd_args_t args;            ///< Parameters parsed according to @schema
+    void *owner;                ///< Buffer holding @params, NULL if allocated by the repository
+    cmdRelease release;         ///< Function to release @owner (called by cmd_free)
+    cmd_domain_t domain;        ///< Resource domain
+    struct cmd_type *next;      ///< Next command waiting for the same domain (used by the dispatcher)
+    cmd_lane_t lane;            ///< Dispatcher lane (set by cmd_send_lane)
+    int coalesce;               ///< Merge with an identical pending command (@see cmd_set_coalesce)
+    portTick sent;              ///< Time the command was sent (set by cmd_send_lane)
+    cmdCallback callback;       ///< Completion callback, NULL if not required
+    void *callback_arg;         ///< Argument of @callback
     cmdFunction function;       ///< Command function
 } cmd_t;
 
@@ -74,32 +177,53 @@ typedef struct cmd_type{
 typedef struct cmd_list_type{
     int nparams;                ///< Number of parameters
     char *fmt;                  ///< Format of parameters
+    char *schema;               ///< Format compiled by cmd_add (use malloc)
     char *name;                 ///< Command name (use malloc)
+    unsigned int hash;          ///< Hash of the command name (name index)
+    cmd_domain_t domain;        ///< Resource domain
     cmdFunction function;       ///< Command function
 } cmd_list_t;
 
+/**
+ * Statistics of the commands sent with cmd_send_lane
+ */
+typedef struct cmd_send_stats{
+    uint32_t coalesced;         ///< Commands merged with an identical pending command
+    uint32_t dropped;           ///< Commands dropped because the lane was full (coalescible or cmd_try_send_lane)
+} cmd_send_stats_t;
+
 /* Function definitions */
 
 /**
- * Registers a command in the system
+ * Registers a command in the system. The parameters format is compiled once
+ * here, so the parameters of every new command are parsed only once when they
+ * are added (@see cmd_args_t). Supported conversions are %d, %i, %u, %x, %f,
+ * %s and %p. If the last parameter is %s it takes the rest of the parameters
+ * string, including spaces.
+ *
+ * The resource domain declares what the command uses, commands of different
+ * domains may be executed at the same time (@see cmd_domain_t).
  *
  * @param function Pointer to command function
  * @param fparams Str. defines format of parameters, separated by spaces
  * @param nparam Int. number of parameters, according to @fparams
+ * @param domain cmd_domain_t. Resource domain of the command
  * @return Int. Length of command list in case of success or CMD_ERROR (-1) if
- * an error occurred.
+ * an error occurred or the repository is sealed (@see cmd_repo_seal).
  *
  * @code
  *      // Adds command foo with 2 params: integer and string
- *      cmd_add("foo", foo, "%d %s", 2);
+ *      cmd_add("foo", foo, "%d %s", 2, CMD_DOMAIN_OBC);
  *      // Adds command bar with 3 params: integers and double
- *      cmd_add("bar", bar, "&d %d %f", 3);
+ *      cmd_add("bar", bar, "&d %d %f", 3, CMD_DOMAIN_COM);
  * @endcode
  */
-int cmd_add(char *name, cmdFunction function, char *fmt, int nparams);
+int cmd_add(char *name, cmdFunction function, char *fmt, int nparams, cmd_domain_t domain);
 
 /**
- * Create a new command by name
+ * Create a new command by name. The command is found using the name index
+ * built by @cmd_add, so the lookup cost does not depend on the number of
+ * registered commands.
  *
  * @param name Str. Command name
  * @return cmd_t * Pointer to command structure already initialized. Null if
@@ -127,7 +251,8 @@ char * cmd_get_name(int idx);
 
 /**
  * Fills command parameters as raw data using memcpy.@len bytes will be copied
- * from @params to @cmd->params.
+ * from @params to @cmd->params. The data is received by the command as a single
+ * %p parameter (args->argv[0].p).
  *
  * @note make sure that @params contains at least @len bytes.
  *
@@ -144,8 +269,10 @@ char * cmd_get_name(int idx);
 void cmd_add_params_raw(cmd_t *cmd, void *params, int len);
 
 /**
- * Fills command parameters as string
- * @note does not check the parameters format or if the command requires param.
+ * Fills command parameters as string. The string is copied and parsed
+ * according to the command format, args->argc has the number of parameters
+ * parsed successfully.
+ * @note does not check if the command requires param.
  *
  * @param cmd cmd_t. Command to fill parameters
  * @param params Str. String with parameters
@@ -163,7 +290,8 @@ void cmd_add_params_str(cmd_t *cmd, char *params);
 
 /**
  * Fills command parameters by variables using the registered parameters format.
- * @note variables are converted to string
+ * @note variables are stored directly as parsed parameters (strings are
+ * copied), float parameters are received as double.
  *
  * @param cmd cmd_t. Command to fill parameters
  * @param ... List of variables to fill as parameters
@@ -181,6 +309,25 @@ void cmd_add_params_str(cmd_t *cmd, char *params);
  */
 void cmd_add_params_var(cmd_t *cmd, ...);
 
+/**
+ * Parses a parameters string according to a format, as done by
+ * @cmd_add_params_str. The string is split in place, so @args points inside
+ * @params.
+ *
+ * @param fmt Str. Parameters format, ex. "%d %s"
+ * @param params Str. Writable parameters string, ex. "1 abc"
+ * @param args cmd_args_t *. Structure to store the parsed parameters
+ * @return Int. Number of parameters parsed successfully
+ *
+ * @code
+ *      char params[] = "26 01 2018 12 35 00";
+ *      cmd_args_t args;
+ *      cmd_parse_args("%d %d %d %d %d %d", params, &args);
+ *      fp_delete("%d %d %d %d %d %d", params, 6, &args);
+ * @endcode
+ */
+int cmd_parse_args(char *fmt, char *params, cmd_args_t *args);
+
 /**
  * Returns a new command with parameters form a string with the format:
  * <command> [parameters]. The [parameters] field is optional. Returns NULL if
@@ -198,22 +345,230 @@ void cmd_add_params_var(cmd_t *cmd, ...);
 cmd_t *cmd_parse_from_str(char *buff);
 
 /**
- * Destroys a command and frees the allocated memory
+ * Returns a new command with parameters from a string with the format:
+ * <command> [parameters], without copying it. The string is split in place and
+ * the command keeps pointers inside @buff, so @buff must be valid until the
+ * command is released with @cmd_free, that calls @release(@owner).
+ *
+ * If the command is not found NULL is returned and the caller still owns
+ * @owner.
+ *
+ * @param buff str. A writable null terminated string with the format
+ * <command> [parameters]
+ * @param owner Pointer to the buffer that holds @buff, ex. a CSP packet
+ * @param release cmdRelease. Function to release @owner, or NULL if @buff is
+ * not owned by the command
+ * @return cmd_t. A new command or NULL in case of errors.
+ *
+ * @code
+ *      packet->data[packet->length] = '\0';
+ *      cmd_t *cmd = cmd_parse_from_buff((char *)packet->data, packet, csp_buffer_free);
+ *      if(cmd != NULL)
+ *          cmd_send(cmd);  // The packet is released after the execution
+ *      else
+ *          csp_buffer_free(packet);
+ * @endcode
+ */
+cmd_t *cmd_parse_from_buff(char *buff, void *owner, cmdRelease release);
+
+/**
+ * Returns several new commands from a string with the format:
+ * <command> [parameters][;<command> [parameters]...]. Commands are separated
+ * by SCH_CMD_DELIMITER, use a backslash to escape the delimiter (ex. to send
+ * several commands to another node: "send_cmd 10 get_mem\;show_time 0").
+ * @buff is modified, each command has its own copy of the parameters.
+ * Invalid commands are discarded.
+ *
+ * @param buff str. A writable null terminated string with commands
+ * @param cmds cmd_t **. Array to store the new commands
+ * @param max_cmds Int. Size of @cmds
+ * @return Int. Number of commands stored in @cmds
+ *
+ * @code
+ *      char buff[] = "debug_obc 1;get_mem";
+ *      cmd_t *cmds[SCH_CMD_MAX_BATCH];
+ *      int n = cmd_parse_batch_from_str(buff, cmds, SCH_CMD_MAX_BATCH);
+ *      cmd_send_batch(cmds, n);
+ * @endcode
+ */
+int cmd_parse_batch_from_str(char *buff, cmd_t **cmds, int max_cmds);
+
+/**
+ * Sends a command to execution using a dispatcher priority lane. The lane
+ * queue and the dispatcher_queue are created by cmd_repo_init, with
+ * SCH_CMD_LANE_*_DEPTH commands per lane. Blocks if the lane is full.
+ *
+ * @param cmd cmd_t *. Command to execute, released after the execution
+ * @param lane cmd_lane_t. Priority lane, invalid lanes use CMD_LANE_GROUND
+ * @return pdPASS if the command was sent, 0 otherwise (also if @cmd is NULL)
+ *
+ * @code
+ *      cmd_t *rst_wdt = cmd_get_str("reset_wdt");
+ *      cmd_send_lane(rst_wdt, CMD_LANE_CRITICAL);
+ * @endcode
+ */
+int cmd_send_lane(cmd_t *cmd, cmd_lane_t lane);
+
+/**
+ * Sends a command to a dispatcher priority lane without blocking, for senders
+ * that must not wait, like timer callbacks (@see osTimerCreate). If the lane
+ * is full the command is dropped and freed, and counted in the dropped
+ * commands (@see cmd_get_send_stats).
+ *
+ * @param cmd cmd_t *. Command to execute, released after the execution
+ * @param lane cmd_lane_t. Priority lane, invalid lanes use CMD_LANE_GROUND
+ * @return pdPASS if the command was sent, 0 if it was dropped
+ *
+ * @code
+ *      cmd_t *cmd_1h = cmd_get_str("update_hours_alive");
+ *      cmd_add_params_var(cmd_1h, 1);
+ *      cmd_try_send_lane(cmd_1h, CMD_LANE_HK);   // Never blocks
+ * @endcode
+ */
+int cmd_try_send_lane(cmd_t *cmd, cmd_lane_t lane);
+
+/**
+ * Sends several commands to execution at once using a dispatcher priority
+ * lane (@see cmd_send_lane). The lane is locked and the dispatcher is
+ * notified only once. Blocks if the lane is full.
+ *
+ * @param cmds cmd_t **. Array of pointers to commands
+ * @param n Int. Number of commands in @cmds
+ * @param lane cmd_lane_t. Priority lane, invalid lanes use CMD_LANE_GROUND
+ * @return Int. Number of commands sent
+ */
+int cmd_send_lane_batch(cmd_t **cmds, int n, cmd_lane_t lane);
+
+/**
+ * Marks a command as coalescible, for periodic commands where only the latest
+ * request matters. When a coalescible command is sent and an identical one
+ * (same command and parameters) is still waiting for execution, the new one
+ * is merged with it and freed. If the lane is full the command is dropped
+ * instead of blocking the sender. Up to SCH_CMD_COALESCE_ENTRIES pending
+ * commands are tracked, see @cmd_get_send_stats for the counters.
+ *
+ * Commands with a completion callback or raw parameters (%p) are never
+ * merged.
+ *
+ * @param cmd cmd_t *. The command
+ * @param coalesce Int. 1 to merge the command with identical pending ones
+ *
+ * @code
+ *      cmd_t *cmd_dbg = cmd_get_str("debug_obc");
+ *      cmd_add_params_var(cmd_dbg, 0);
+ *      cmd_set_coalesce(cmd_dbg, 1);
+ *      cmd_send_lane(cmd_dbg, CMD_LANE_HK);   // Never blocks
+ * @endcode
+ */
+void cmd_set_coalesce(cmd_t *cmd, int coalesce);
+
+/**
+ * Called by the executer when a command starts its execution. A coalescible
+ * command is not pending anymore, so new identical commands are executed
+ * again (@see cmd_set_coalesce).
+ *
+ * @param cmd cmd_t *. The command that starts
+ */
+void cmd_coalesce_remove(cmd_t *cmd);
+
+/**
+ * Gets the counters of merged coalescible commands and dropped commands
+ *
+ * @param stats cmd_send_stats_t *. Structure to store the counters
+ */
+void cmd_get_send_stats(cmd_send_stats_t *stats);
+
+/**
+ * Takes the oldest command of a dispatcher lane without blocking. Used by the
+ * dispatcher after reading a notification from dispatcher_queue.
+ *
+ * @param lane cmd_lane_t. Priority lane
+ * @return cmd_t *. The command or NULL if the lane is empty
+ */
+cmd_t *cmd_lane_receive(cmd_lane_t lane);
+
+/**
+ * Number of commands waiting in a dispatcher lane. Does not block.
+ *
+ * @param lane cmd_lane_t. Priority lane
+ * @return Int. Number of commands in the lane
+ */
+int cmd_lane_size(cmd_lane_t lane);
+
+/**
+ * Sets a function to be called when the command finishes, so the result is
+ * delivered to whoever sent the command without waiting for it. The callback
+ * runs in the executer task, so it must be short and must not block.
+ *
+ * @param cmd cmd_t *. The command
+ * @param callback cmdCallback. Function to call with the command result
+ * @param arg Pointer passed to @callback
+ *
+ * @code
+ *      // Wait for the result of a command
+ *      osQueue result_queue = osQueueCreate(1, sizeof(int));
+ *      cmd_t *cmd = cmd_get_str("get_mem");
+ *      cmd_set_callback(cmd, cmd_callback_queue, result_queue);
+ *      cmd_send(cmd);
+ *      int result;
+ *      osQueueReceive(result_queue, &result, portMAX_DELAY);
+ * @endcode
+ */
+void cmd_set_callback(cmd_t *cmd, cmdCallback callback, void *arg);
+
+/**
+ * Completion callback that sends the command result (int) to the osQueue
+ * passed as @arg, without blocking. Use it to wait for the result of a
+ * command (@see cmd_set_callback).
+ *
+ * @param cmd cmd_t *. The finished command
+ * @param result Int. Command result
+ * @param arg osQueue. Queue of int items to send the result
+ */
+void cmd_callback_queue(cmd_t *cmd, int result, void *arg);
+
+/**
+ * Destroys a command and frees the allocated memory. Commands and parameters
+ * are allocated from memory pools (@see cmd_print_pool_stats), so always use
+ * this function instead of free.
+ * Parameters stored in an external buffer are released calling the release
+ * function given to @cmd_parse_from_buff.
  */
 void cmd_free(cmd_t *cmd);
 
+/**
+ * Print the commands and parameters memory pools statistics
+ */
+void cmd_print_pool_stats(void);
+
 /**
 * Print the list of registered commands
 */
 void cmd_print_all(void);
 
 /**
- * Initializes the command buffer adding null_cmd
+ * Initializes the command buffer adding null_cmd. After this call the
+ * repository is sealed (@see cmd_repo_seal), so commands must be registered
+ * by the cmd_*_init functions called here. The dispatcher lanes and
+ * dispatcher_queue are also created here the first time.
  *
  * @return 1
  */
 int cmd_repo_init(void);
 
+/**
+ * Seals or unseals the command repository. A sealed repository does not accept
+ * new commands (@cmd_add returns CMD_ERROR) and lookups (@cmd_get_str,
+ * @cmd_get_idx, @cmd_get_name, @cmd_get_fmt) read the command list without
+ * taking repo_cmd_sem, so they are wait-free.
+ *
+ * @note Only unseal the repository when no other task is using it
+ * (ex. before the tasks are created or in tests).
+ *
+ * @param seal Int. 1 to seal the repository, 0 to allow new commands
+ */
+void cmd_repo_seal(int seal);
+
 /**
  * Cleans the repo buffer. Frees allocated memories
  */
@@ -225,9 +580,10 @@ void cmd_repo_close(void);
  * @params fmt Not used
  * @params param Not used
  * @params nparams Not Used
+ * @params args Not Used
  * @return 1, allways successful
  */
-int cmd_null(char *fmt, char *params, int nparams);
+int cmd_null(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  *
@@ -244,7 +600,7 @@ int cmd_print(cmd_t* cmd);
  *
  * @param name *char. Pointer to char variable. The function allocates memory so
  * make sure to free the array after use.
- * @return char* with the command's format
+ * @return char* with the command's format, NULL if the command does not exist
  */
 char* cmd_get_fmt(char* name);
 
@@ -252,6 +608,8 @@ char* cmd_get_fmt(char* name);
  * Fix the format to be used in the set function of the flight plan.
  * The function allocates memory so make sure to free the array after use.
  *
+ * The result is truncated to SCH_CMD_MAX_STR_PARAMS-1 chars.
+ *
  * @param fmt *char. pointer to the format string to fix
  * @return char* with the command's format
  */
@@ -14,6 +14,8 @@
 #define DATA_REPO_H
 
 #include "osSemphr.h"
+#include "osEvent.h"
+#include "osTimer.h"
 
 #include "config.h"
 #include "globals.h"
@@ -22,6 +24,9 @@
 #if SCH_STORAGE_MODE
     #include "data_storage.h"
 #endif
+#ifdef SIM
+    #include "osSim.h"
+#endif
 
 typedef union fvalue{
     float f;
@@ -35,9 +40,15 @@ typedef union fvalue{
 
 #define DAT_REPO_SYSTEM "dat_system"    ///< Status variables table name
 
+#define DAT_EVENT_FP    (1<<0)  ///< Flight plan changed (entry set, deleted or reset)
+#define DAT_EVENT_TIME  (1<<1)  ///< System time changed
+
 /** Copy a system @var to a status strcture @st */
 #define DAT_CPY_SYSTEM_VAR(st, var) st->var = dat_get_system_var(var)
 #define DAT_CPY_SYSTEM_VAR_F(st, var) {fvalue_t v; v.i = (float)dat_get_system_var(var); st->var = v.f;}
+/** Copy a system @var from a snapshot of all the variables @values (@relatesalso dat_get_system_vars) to a status structure @st */
+#define DAT_CPY_SNAPSHOT_VAR(st, values, var) st->var = values[var]
+#define DAT_CPY_SNAPSHOT_VAR_F(st, values, var) {fvalue_t v; v.i = values[var]; st->var = v.f;}
 /** Print the name and vale of a integer system status variable */
 #define DAT_PRINT_SYSTEM_VAR(st, var) printf("\t%s: %d\n", #var, st->var)
 /** Print the name and vale of a float system status variable */
@@ -197,6 +208,32 @@ typedef struct ads_data {
     float mag_z;            ///< Magnetometer z axis
 } ads_data_t;
 
+/**
+ * Persistence tier of a status variable, tells when a written value is
+ * committed to the storage. Tiers are used with SCH_STORAGE_MODE 1 and
+ * SCH_STORAGE_CACHE 1, otherwise every write goes to the storage.
+ */
+typedef enum dat_tier_e {
+    DAT_TIER_CHECKPOINT = 0,    ///< Committed periodically with the other writes (SCH_STORAGE_FLUSH_MS)
+    DAT_TIER_VOLATILE,          ///< Only in RAM, starts from 0 after a reset
+    DAT_TIER_DURABLE            ///< Committed and synced to the storage device on every write
+} dat_tier_t;
+
+/**
+ * Write statistics of the status variables, to measure the storage writes
+ * and commits saved by the group commit (@relatesalso dat_flush). Without the
+ * group commit every copy of a written variable is committed on its own.
+ */
+typedef struct dat_flush_stats_s {
+    uint32_t writes;        ///< Status variables written (dat_set_system_var calls)
+    uint32_t coalesced;     ///< Writes replaced in the cache before being committed
+    uint32_t skipped;       ///< Writes of volatile variables, never committed
+    uint32_t rows;          ///< Values written to the storage, including copies
+    uint32_t commits;       ///< Storage commits
+    uint32_t synced;        ///< Commits synced to the storage device (durable writes)
+    uint32_t busy;          ///< Flush timer ticks skipped because the repository was in use
+} dat_flush_stats_t;
+
 /**
  * Initializes data repositories including buffers and mutexes
  */
@@ -210,11 +247,68 @@ void dat_repo_close(void);
 /**
  * Sets a status variable value
  *
+ * With the cache enabled, the persistence tier of the variable tells when the
+ * value is committed to the storage (@relatesalso dat_get_system_var_tier).
+ * Checkpoint variables are committed later together with the other written
+ * variables (every SCH_STORAGE_FLUSH_MS milliseconds or
+ * SCH_STORAGE_FLUSH_WRITES writes), use dat_flush to commit them at once.
+ *
  * @param index dat_system_t. Variable to set @sa dat_system_t
  * @param value Int. Value to set
  */
 void dat_set_system_var(dat_system_t index, int value);
 
+/**
+ * Adds @delta to a status variable. The variable is read and written with the
+ * repository locked once, so concurrent updates are not lost, and the new
+ * value and its copies are written in one storage transaction.
+ *
+ * @code
+ *      int count = dat_add_system_var(dat_com_count_tc, 1);
+ * @endcode
+ *
+ * @param index dat_system_t. Variable to update @sa dat_system_t
+ * @param delta Int. Value to add (can be negative)
+ * @return Int. The new value
+ */
+int dat_add_system_var(dat_system_t index, int delta);
+
+/**
+ * Compare and set. Sets a status variable to @value only if its current value
+ * is @expected, in one locked operation like dat_add_system_var.
+ *
+ * @param index dat_system_t. Variable to update @sa dat_system_t
+ * @param expected Int. Expected current value
+ * @param value Int. New value
+ * @return Int. 1 if the variable was set, 0 if its value was not @expected
+ */
+int dat_cas_system_var(dat_system_t index, int expected, int value);
+
+/**
+ * Commits the pending status variables writes to the storage in one
+ * transaction, synced to the storage device. Does nothing if there are no
+ * pending writes.
+ *
+ * @return 0 OK, -1 Error
+ */
+int dat_flush(void);
+
+/**
+ * Returns the persistence tier of a status variable
+ *
+ * @param index dat_system_t. Variable @sa dat_system_t
+ * @return dat_tier_t. Persistence tier
+ */
+dat_tier_t dat_get_system_var_tier(dat_system_t index);
+
+/**
+ * Copies the status variables write statistics
+ *
+ * @param stats dat_flush_stats_t *. Pointer to destination structure
+ * @param reset Int. 1 to reset the statistics after copying them
+ */
+void dat_get_flush_stats(dat_flush_stats_t *stats, int reset);
+
 /**
  * Returns a status variable's value
  *
@@ -224,7 +318,16 @@ void dat_set_system_var(dat_system_t index, int value);
 int dat_get_system_var(dat_system_t index);
 
 /**
- * Copy the list of status variables to a dat_status_t struct.
+ * Reads all the status variables at once (one lock, and one storage read if
+ * the storage cache is disabled) and votes their copies.
+ *
+ * @param values Int *. Destination array of dat_system_last_var values
+ */
+void dat_get_system_vars(int *values);
+
+/**
+ * Copy the list of status variables to a dat_status_t struct, from one
+ * snapshot of the variables (@relatesalso dat_get_system_vars).
  * This function can be useful to debug status variables @seealso dat_print_status
  * and to pack the variables prior to send it using libcsp @seealso tm_send_status.
  *
@@ -253,6 +356,16 @@ void dat_print_status(dat_status_t *status);
  */
 int dat_get_fp(int elapsed_sec, char* command, char* args, int* executions, int* periodical);
 
+/**
+ * Time of the next flight plan entry, so the flight plan task can sleep until
+ * it is due instead of checking every second
+ *
+ * @param from Int. Start time (unix time), entries at @from are included
+ * @return Int. Time of the first entry at or after @from, -1 if there are no
+ * entries
+ */
+int dat_get_fp_next(int from);
+
 /**
  * Set a command with its args, executions (how many times will be executed)
  * and periodical (seconds to be executed again) to be executed at a certain time
@@ -262,7 +375,8 @@ int dat_get_fp(int elapsed_sec, char* command, char* args, int* executions, int*
  * @param args Str. command arguments
  * @param executions Int. times to execute the command
  * @param periodical Int. periodical value (in seconds)
- * @return 0 OK, -1 Error
+ * @return 0 OK, -1 Error (also if @command or @args are longer than
+ * SCH_CMD_MAX_STR_PARAMS-1 chars)
  */
 int dat_set_fp(int timetodo, char* command, char* args, int executions, int periodical);
 
@@ -289,6 +403,17 @@ int dat_reset_fp(void);
  */
 int dat_show_fp (void);
 
+/**
+ * Wait for data repository events (DAT_EVENT_*), set when the flight plan or
+ * the system time change. The returned events are cleared.
+ *
+ * @param events uint32_t. Events to wait for
+ * @param timeout uint32_t. Max. time to wait in milliseconds (portMAX_DELAY
+ * to wait forever)
+ * @return uint32_t. Events received, 0 if the timeout expired
+ */
+uint32_t dat_wait_events(uint32_t events, uint32_t timeout);
+
 /**
  * Get the system time
  *
@@ -8,6 +8,14 @@
  * This task implements the dispatcher. Reads commands from queue, determines
  * if the commands is executable, asks to command repository the function to
  * send to taskExecuter. It's an event driven task.
+ *
+ * Commands are executed by several executer tasks. The dispatcher only sends
+ * a command if no other command of the same resource domain is running, so
+ * commands of the same domain are executed one at a time and in order.
+ *
+ * Commands arrive through priority lanes (@see cmd_lane_t). The dispatcher
+ * waits for dispatcher_queue, that has one notification per command sent to
+ * any lane, and then takes the next command by lane priority.
  */
 
 #ifndef T_DISPATCHER_H
@@ -18,7 +26,70 @@
 #include "repoCommand.h"
 #include "repoData.h"
 
+/**
+ * Number of buckets of the latency histogram. Bucket 0 counts latencies of
+ * 0 us, bucket i counts latencies from 2^(i-1) to 2^i - 1 us, the last bucket
+ * also counts longer latencies.
+ */
+#define DISPATCHER_HIST_BUCKETS 24
+
+/**
+ * Queueing latency of a dispatcher lane, from cmd_send_lane until the command
+ * starts its execution
+ */
+typedef struct dispatcher_lane_stats{
+    uint32_t count;         ///< Commands executed
+    uint32_t last_us;       ///< Latency of the last command in microseconds
+    uint32_t min_us;        ///< Min. latency in microseconds
+    uint32_t max_us;        ///< Max. latency in microseconds
+    uint64_t total_us;      ///< Sum of latencies in microseconds, to get the mean
+    uint32_t hist[DISPATCHER_HIST_BUCKETS]; ///< Latency histogram, to get percentiles
+} dispatcher_lane_stats_t;
+
 void taskDispatcher(void *param);
 int check_if_executable(cmd_t *newCmd);
 
+/**
+ * Called by the executer when a command finishes. Returns the next command
+ * waiting for the same domain, that the executer must run before taking new
+ * commands, or NULL and the domain is released.
+ *
+ * @param domain cmd_domain_t. Domain of the finished command
+ * @return cmd_t *. Next command of the domain or NULL
+ */
+cmd_t *dispatcher_cmd_done(cmd_domain_t domain);
+
+/**
+ * Called by the executer just before running a command. Updates the
+ * queueing latency statistics of the command lane.
+ *
+ * @param cmd cmd_t *. Command to run
+ */
+void dispatcher_cmd_start(cmd_t *cmd);
+
+/**
+ * Gets the queueing latency statistics of a lane
+ *
+ * @param lane cmd_lane_t. Lane
+ * @param stats dispatcher_lane_stats_t *. Structure to store the statistics
+ */
+void dispatcher_get_lane_stats(cmd_lane_t lane, dispatcher_lane_stats_t *stats);
+
+/**
+ * Latency percentile of a lane from its histogram, rounded up to the upper
+ * limit of the histogram bucket. Use it to measure the jitter of the
+ * dispatcher and executer path, for example the difference between the 99th
+ * percentile and the minimum latency.
+ *
+ * @param stats dispatcher_lane_stats_t *. Lane statistics
+ * @param percent Int. Percentile, from 1 to 100
+ * @return uint32_t. Latency in microseconds, 0 if there are no samples
+ */
+uint32_t dispatcher_lane_percentile(dispatcher_lane_stats_t *stats, int percent);
+
+/**
+ * Clears the queueing latency statistics of all lanes
+ */
+void dispatcher_reset_lane_stats(void);
+
 #endif
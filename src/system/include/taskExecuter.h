@@ -6,8 +6,12 @@
  * @copyright GNU GPL v3
  *
  * This task implements the executer module. Waits a message from dispatcher to
- * obtain the function and parameter to execute. When the function ends, send a
- * message to dispatcher with the result of the execution
+ * obtain the function and parameter to execute. When the function ends, call the
+ * command completion callback (@see cmd_set_callback), notify the dispatcher
+ * and execute the next command waiting for the same resource
+ * domain, if any, interleaved with the new commands sent by the dispatcher.
+ * Several executer tasks (SCH_CMD_EXE_WORKERS) run commands of different
+ * domains at the same time.
  */
 
 #ifndef T_EXECUTER_H
@@ -20,6 +24,7 @@
 #include "osQueue.h"
 
 #include "repoCommand.h"
+#include "taskDispatcher.h"
 
 void taskExecuter(void *param);
 
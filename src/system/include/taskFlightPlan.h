@@ -16,6 +16,8 @@
 #include <stdlib.h>
 #include "config.h"
 #include "osDelay.h"
+#include "osEvent.h"
+#include "osThread.h"
 #include "repoCommand.h"
 #include "repoData.h"
 
@@ -32,6 +34,14 @@
     #include <time.h>
 #endif
 
+/**
+ * Sends the commands of the flight plan to the flight plan lane when they are
+ * due. The task sleeps until the next entry, or until the flight plan or the
+ * system time change (DAT_EVENT_FP, DAT_EVENT_TIME), instead of checking the
+ * flight plan every second.
+ *
+ * @param param Not used
+ */
 void taskFlightPlan(void *param);
 
 /**
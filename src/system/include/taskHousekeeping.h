@@ -31,9 +31,18 @@
 
 #include "osQueue.h"
 #include "osDelay.h"
+#include "osTimer.h"
+#include "osThread.h"
 
 #include "repoCommand.h"
 
+/**
+ * Starts the housekeeping timers and ends. There is one periodic timer for
+ * each housekeeping period (1 s, 2 s, 10 s, 10 min and 1 h), each one sends
+ * its commands to the housekeeping lane.
+ *
+ * @param param Not used
+ */
 void taskHousekeeping(void *param);
 
 #endif //T_HOUSEKEEPING_H
@@ -18,10 +18,19 @@
 
 #include "osQueue.h"
 #include "osDelay.h"
+#include "osTimer.h"
+#include "osThread.h"
 
 #include "repoCommand.h"
 #include "repoData.h"
 
+/**
+ * Starts the watchdog timer and ends. Every second the timer increases the
+ * software watchdog counter (reset if not cleared by a ground command) and
+ * periodically sends the reset_wdt command to the critical lane.
+ *
+ * @param param Not used
+ */
 void taskWatchdog(void *param);
 
 #endif //T_WDT_H
@@ -53,7 +53,9 @@ osSemaphore log_mutex;  ///< Sync logging functions, require initialization
  */
 static inline int log_init(void)
 {
-    return osSemaphoreCreate(&log_mutex);
+    int rc = osSemaphoreCreate(&log_mutex);
+    osSemaphoreSetName(&log_mutex, "log");
+    return rc;
 }
 
 /// Logging functions @see log_level_t
@@ -26,25 +26,124 @@ const static char *tag = "repoCmd";
 cmd_list_t cmd_list[SCH_CMD_MAX_ENTRIES];
 int cmd_index = 0;
 
-int cmd_add(char *name, cmdFunction function, char *fparams, int nparam)
+/**
+ * Command name index. Open addressing hash table (linear probing) that maps a
+ * command name to its position in cmd_list. Entries are added by cmd_add so
+ * lookups by name do not need to scan the whole command list.
+ */
+#define CMD_HASH_SIZE   (2*SCH_CMD_MAX_ENTRIES+1)
+#define CMD_HASH_EMPTY  (-1)
+static int cmd_hash_table[CMD_HASH_SIZE];
+static int cmd_slots = 0;   ///< Number of cmd_list slots already filled
+
+/**
+ * Sealed repository flag. After cmd_repo_init the command list does not change
+ * anymore, so lookups can read it without taking repo_cmd_sem.
+ */
+static volatile int cmd_repo_sealed = 0;
+
+/**
+ * Memory pools for commands and parameters buffers. Parameters use two size
+ * classes, if a pool is exhausted the heap is used instead.
+ */
+static osPool cmd_pool = NULL;          ///< cmd_t blocks
+static osPool cmd_params_small = NULL;  ///< SCH_CMD_MAX_STR_PARAMS bytes blocks
+static osPool cmd_params_large = NULL;  ///< SCH_BUFF_MAX_LEN bytes blocks
+static uint32_t cmd_heap_allocs = 0;    ///< Allocations that fall back to heap
+
+/**
+ * Dispatcher lanes queues (@see cmd_lane_t). Every command sent to a lane is
+ * notified to the dispatcher with an item in dispatcher_queue, so the
+ * dispatcher waits for one queue only.
+ */
+static osQueue cmd_lane_queue[CMD_LANE_LAST];
+static const int cmd_lane_depth[CMD_LANE_LAST] = {
+    SCH_CMD_LANE_CRITICAL_DEPTH,
+    SCH_CMD_LANE_GROUND_DEPTH,
+    SCH_CMD_LANE_FP_DEPTH,
+    SCH_CMD_LANE_HK_DEPTH
+};
+
+/**
+ * Coalescible commands sent and not started yet (@see cmd_set_coalesce) and
+ * the send counters, protected by cmd_pending_sem
+ */
+static osSemaphore cmd_pending_sem;
+static cmd_t *cmd_pending[SCH_CMD_COALESCE_ENTRIES];
+static cmd_send_stats_t cmd_send_stats;
+
+static unsigned int cmd_hash(const char *name);
+static int cmd_hash_find(const char *name);
+static void cmd_hash_insert(int idx);
+static void cmd_hash_rebuild(void);
+static cmd_t *cmd_new_from_list(int idx, cmd_list_t *cmd_found);
+static int cmd_repo_lock(void);
+static void cmd_repo_unlock(int locked);
+static void *cmd_params_alloc(size_t size);
+static void cmd_params_free(void *params);
+static int cmd_fmt_to_schema(const char *fmt, char *schema);
+static int cmd_args_parse(const char *schema, char *params, cmd_args_t *args);
+static int cmd_send_lane_timeout(cmd_t **cmds, int n, cmd_lane_t lane, uint32_t timeout);
+static int cmd_lane_send(cmd_t **cmds, int n, cmd_lane_t lane, uint32_t timeout);
+static void cmd_drop(cmd_t *cmd, cmd_lane_t lane);
+static int cmd_is_coalescible(cmd_t *cmd);
+static int cmd_params_equal(cmd_t *a, cmd_t *b);
+static int cmd_coalesce_send(cmd_t *cmd, cmd_lane_t lane);
+
+int cmd_add(char *name, cmdFunction function, char *fparams, int nparam, cmd_domain_t domain)
 {
+    if(cmd_repo_sealed)
+    {
+        LOGW(tag, "Unable to add cmd: %s. Repository sealed", name);
+        return CMD_ERROR;
+    }
+
+    if(domain < 0 || domain >= CMD_DOMAIN_LAST)
+    {
+        LOGW(tag, "Unable to add cmd: %s. Invalid domain (%d)", name, domain);
+        return CMD_ERROR;
+    }
+
     if (cmd_index < SCH_CMD_MAX_ENTRIES)
     {
         // Create new command
         size_t l_name = strlen(name);
         size_t l_fparams = strlen(fparams);
+        char schema[SCH_CMD_MAX_ARGS+1];
+        int n_schema = cmd_fmt_to_schema(fparams, schema);
+        if(n_schema != nparam)
+        {
+            LOGW(tag, "Cmd %s format '%s' has %d parameters, expected %d",
+                 name, fparams, n_schema, nparam);
+        }
+
         cmd_list_t cmd_new;
         cmd_new.fmt = (char *)malloc(sizeof(char)*(l_fparams+1));
         strncpy(cmd_new.fmt, fparams, l_fparams+1);
+        cmd_new.schema = (char *)malloc(sizeof(char)*(n_schema+1));
+        strncpy(cmd_new.schema, schema, (size_t)n_schema+1);
         cmd_new.function = function;
         cmd_new.name = (char *)malloc(sizeof(char)*(l_name+1));
         strncpy(cmd_new.name, name, l_name+1);
         cmd_new.nparams = nparam;
+        cmd_new.domain = domain;
+        cmd_new.hash = cmd_hash(name);
 
-        // Copy to command buffer
+        // Copy to command buffer and update the name index
         osSemaphoreTake(&repo_cmd_sem, portMAX_DELAY);
         {
             cmd_list[cmd_index] = cmd_new;
+            if(cmd_index < cmd_slots)
+            {
+                // Replacing an used slot (ex. a null command), so the old
+                // name must be removed from the index
+                cmd_hash_rebuild();
+            }
+            else
+            {
+                cmd_hash_insert(cmd_index);
+                cmd_slots = cmd_index + 1;
+            }
             cmd_index++;
         }
         osSemaphoreGiven(&repo_cmd_sem);
@@ -60,24 +159,22 @@ int cmd_add(char *name, cmdFunction function, char *fparams, int nparam)
 cmd_t * cmd_get_str(char *name)
 {
     cmd_t *cmd_new = NULL;
+    cmd_list_t cmd_found;
+    int idx, locked;
 
-    //Find inside command buffer
-    int i, ok;
-    for(i=0; i<SCH_CMD_MAX_ENTRIES; i++)
-    {
-        osSemaphoreTake(&repo_cmd_sem, portMAX_DELAY);
-        ok = strcmp(name, cmd_list[i].name);
-        osSemaphoreGiven(&repo_cmd_sem);
+    // Find the command index using the name index
+    locked = cmd_repo_lock();
+    idx = cmd_hash_find(name);
+    if(idx != CMD_HASH_EMPTY)
+        cmd_found = cmd_list[idx];
+    cmd_repo_unlock(locked);
 
-        if(ok == 0)
-        {
-            // Create the command by index
-            cmd_new = cmd_get_idx(i);
-            break;
-        }
+    if(idx != CMD_HASH_EMPTY)
+    {
+        // Create the command by index
+        cmd_new = cmd_new_from_list(idx, &cmd_found);
     }
-
-    if(cmd_new == NULL)
+    else
     {
         LOGW(tag, "Command not found: %s", name);
     }
@@ -88,22 +185,15 @@ cmd_t * cmd_get_idx(int idx)
 {
     cmd_t *cmd_new = NULL;
 
-    if (idx < SCH_CMD_MAX_ENTRIES)
+    if (idx >= 0 && idx < SCH_CMD_MAX_ENTRIES)
     {
         // Get found command
-        osSemaphoreTake(&repo_cmd_sem, portMAX_DELAY);
+        int locked = cmd_repo_lock();
         cmd_list_t cmd_found = cmd_list[idx];
-        osSemaphoreGiven(&repo_cmd_sem);
+        cmd_repo_unlock(locked);
 
         // Creates a new command
-        cmd_new = (cmd_t *)malloc(sizeof(cmd_t));
-
-        // Fill parameters
-        cmd_new->id = idx;
-        cmd_new->fmt = cmd_found.fmt;
-        cmd_new->function = cmd_found.function;
-        cmd_new->nparams = cmd_found.nparams;
-        cmd_new->params = NULL;
+        cmd_new = cmd_new_from_list(idx, &cmd_found);
     }
     else
     {
@@ -116,12 +206,12 @@ cmd_t * cmd_get_idx(int idx)
 char * cmd_get_name(int idx)
 {
     char *name = NULL;
-    if (idx < SCH_CMD_MAX_ENTRIES)
+    if (idx >= 0 && idx < SCH_CMD_MAX_ENTRIES)
     {
         // Get found command
-        osSemaphoreTake(&repo_cmd_sem, portMAX_DELAY);
+        int locked = cmd_repo_lock();
         cmd_list_t cmd_found = cmd_list[idx];
-        osSemaphoreGiven(&repo_cmd_sem);
+        cmd_repo_unlock(locked);
 
         LOGV(tag, "Cmd name found: %s", cmd_found.name);
         name = (char *)malloc(strlen(cmd_found.name)+1);
@@ -148,108 +238,469 @@ void cmd_add_params_raw(cmd_t *cmd, void *params, int len)
     if(cmd != NULL && params != NULL)
     {
         LOGD(tag, "Copying %d bytes as parameters", len);
-        cmd->params = (char *)malloc((size_t)len);
+        cmd->params = (char *)cmd_params_alloc((size_t)len);
         memcpy(cmd->params, params, (size_t)len);
+
+        // Raw data is a single parameter
+        cmd->args.argc = 1;
+        cmd->args.argv[0].p = cmd->params;
     }
 }
 
 void cmd_add_params_str(cmd_t *cmd, char *params)
 {
-    size_t len_param = strlen(params);
-    if(len_param > SCH_CMD_MAX_STR_PARAMS)
-    {
-        LOGW(tag, "Parameters larger than CMD_MAX_STR_PARAMS will be shorted!( (%d > %d)",
-             (int)len_param, SCH_CMD_MAX_STR_PARAMS);
-        len_param = SCH_CMD_MAX_STR_PARAMS;
-    }
+    size_t len_param;
 
     // Check pointers
-    if(cmd != NULL && len_param)
+    if(cmd == NULL || params == NULL)
+        return;
+
+    len_param = strlen(params);
+    if(len_param)
     {
-        cmd->params = (char *)malloc(sizeof(char)*(len_param+1));
-        strncpy(cmd->params, params, len_param+1);
+        cmd->params = (char *)cmd_params_alloc(sizeof(char)*(len_param+1));
+        memcpy(cmd->params, params, len_param+1);
+
+        // Parse the parameters only once, the command receives the values
+        cmd_args_parse(cmd->schema, cmd->params, &cmd->args);
     }
 }
 
 void cmd_add_params_var(cmd_t *cmd, ...)
 {
     va_list args;
-    va_start(args, cmd);
+    size_t len_str = 0;
+    int i;
 
-    //Parsing arguments to string
-    char str_params[SCH_CMD_MAX_STR_PARAMS];
-    vsprintf(str_params, cmd->fmt, args);
+    if(cmd == NULL)
+        return;
 
+    // Store the values directly as parsed parameters
+    va_start(args, cmd);
+    for(i=0; cmd->schema[i] != 0; i++)
+    {
+        cmd_arg_t *arg = &(cmd->args.argv[i]);
+        switch(cmd->schema[i])
+        {
+            case 'd':
+            case 'i':
+                arg->i = (int32_t)va_arg(args, int);
+                break;
+            case 'u':
+            case 'x':
+                arg->u = (uint32_t)va_arg(args, unsigned int);
+                break;
+            case 'f':
+                arg->f = (float)va_arg(args, double);
+                break;
+            case 's':
+                arg->s = va_arg(args, char *);
+                len_str += strlen(arg->s) + 1;
+                break;
+            default:
+                arg->p = va_arg(args, void *);
+                break;
+        }
+    }
     va_end(args);
+    cmd->args.argc = i;
 
-    //Fill parameters as string
-    cmd_add_params_str(cmd, str_params);
+    // Strings are copied to the parameters buffer
+    if(len_str > 0)
+    {
+        char *str = (char *)cmd_params_alloc(len_str);
+        cmd->params = str;
+        for(i=0; i<cmd->args.argc; i++)
+        {
+            if(cmd->schema[i] == 's')
+            {
+                size_t len = strlen(cmd->args.argv[i].s) + 1;
+                memcpy(str, cmd->args.argv[i].s, len);
+                cmd->args.argv[i].s = str;
+                str += len;
+            }
+        }
+    }
+}
+
+int cmd_parse_args(char *fmt, char *params, cmd_args_t *args)
+{
+    char schema[SCH_CMD_MAX_ARGS+1];
+    cmd_fmt_to_schema(fmt, schema);
+    return cmd_args_parse(schema, params, args);
 }
 
 cmd_t *cmd_parse_from_str(char *buff)
 {
-    cmd_t *new_cmd = NULL;
+    // Copy the string once, the command keeps the copy as parameters storage
     size_t len = strlen(buff);
-    int ok = 0;
+    char *tmp_buff = (char *)cmd_params_alloc(len+1);
+    if(tmp_buff == NULL)
+    {
+        LOGE(tag, "Error allocating memory in cmd_parse_from_str");
+        return NULL;
+    }
+    memcpy(tmp_buff, buff, len+1);
+
+    cmd_t *new_cmd = cmd_parse_from_buff(tmp_buff, tmp_buff, cmd_params_free);
+    if(new_cmd == NULL)
+        cmd_params_free(tmp_buff);
+
+    // Return the command filled with parameters or a NULL pointer
+    return new_cmd;
+}
+
+cmd_t *cmd_parse_from_buff(char *buff, void *owner, cmdRelease release)
+{
+    cmd_t *new_cmd = NULL;
+    char *name = buff;
+    char *params;
+
+    // Split the command name in place: <command> [parameters]
+    LOGV(tag, "New TC: %s", buff);
+    while(*name != 0 && isspace((unsigned char)*name))
+        name++;
+    params = name;
+    while(*params != 0 && !isspace((unsigned char)*params))
+        params++;
+    if(*params != 0)
+        *params++ = 0;
+    while(*params != 0 && isspace((unsigned char)*params))
+        params++;
+    LOGV(tag, "Parsed cmd: %s, args: %s", name, params);
 
-    // Do not use sscanf in empty string
-    if(len > 0)
+    // Check that the command name was found and the command exist
+    if(*name != 0)
+        new_cmd = cmd_get_str(name);
+
+    if(new_cmd == NULL)
     {
-        int next;
-        char tmp_cmd[len + 1];
-        memset(tmp_cmd, '\0', (size_t)len+1);
+        LOGE(tag, "Error parsing command!");
+        return NULL;
+    }
 
-        // Scan a command and parameter string: <command> [parameters]
-        LOGV(tag, "New TC: %s (%d)", buff, (int)len);
-        ok = sscanf(buff, "%s %n", tmp_cmd, &next);
-        LOGV(tag, "Parsed cmd: %s (a: %d, n: %d)", tmp_cmd, ok, next);
+    // The parameters (optional) are parsed and kept inside the buffer
+    if(*params != 0)
+    {
+        new_cmd->params = params;
+        cmd_args_parse(new_cmd->schema, new_cmd->params, &new_cmd->args);
+    }
+    new_cmd->owner = owner;
+    new_cmd->release = release;
 
-        // Check that at least one str was found (the command name)
-        if (ok > 0)
+    return new_cmd;
+}
+
+int cmd_parse_batch_from_str(char *buff, cmd_t **cmds, int max_cmds)
+{
+    char *next = buff;
+    char *src, *dst;
+    int n_cmds = 0;
+
+    while(*next != 0)
+    {
+        // Find the end of the command and remove escape chars in place
+        src = dst = next;
+        while(*src != 0 && *src != SCH_CMD_DELIMITER)
         {
-            new_cmd = cmd_get_str(tmp_cmd);
+            if(src[0] == '\\' && src[1] == SCH_CMD_DELIMITER)
+                src++;
+            *dst++ = *src++;
+        }
+        next = (*src == 0) ? src : src + 1;
+        *dst = 0;
 
-            // Check if the command exist
-            if (new_cmd != NULL)
-            {
-                // Check if a parameter was found too (optional)
-                if (next < len)
-                {
-                    memset(tmp_cmd, '\0', (size_t)len+1);
-                    strncpy(tmp_cmd, buff + next, (size_t) (len - next));
-                    LOGV(tag, "Parsed args: %s", tmp_cmd);
-                    cmd_add_params_str(new_cmd, tmp_cmd);
-                }
-                else
-                {
-                    cmd_add_params_str(new_cmd, "");
-                }
-            }
-            else
+        // Skip empty commands, ex. "cmd1;;cmd2;"
+        while(isspace((unsigned char)*buff))
+            buff++;
+        if(*buff != 0)
+        {
+            if(n_cmds >= max_cmds)
             {
-                ok = 0;
+                LOGW(tag, "Too many commands, discarding: %s", buff);
+                break;
             }
+
+            cmd_t *new_cmd = cmd_parse_from_str(buff);
+            if(new_cmd != NULL)
+                cmds[n_cmds++] = new_cmd;
+        }
+        buff = next;
+    }
+
+    return n_cmds;
+}
+
+int cmd_send_lane(cmd_t *cmd, cmd_lane_t lane)
+{
+    if(cmd == NULL)
+        return 0;
+    return cmd_send_lane_timeout(&cmd, 1, lane, portMAX_DELAY) == 1 ? pdPASS : 0;
+}
+
+int cmd_try_send_lane(cmd_t *cmd, cmd_lane_t lane)
+{
+    if(cmd == NULL)
+        return 0;
+    return cmd_send_lane_timeout(&cmd, 1, lane, 0) == 1 ? pdPASS : 0;
+}
+
+int cmd_send_lane_batch(cmd_t **cmds, int n, cmd_lane_t lane)
+{
+    return cmd_send_lane_timeout(cmds, n, lane, portMAX_DELAY);
+}
+
+/**
+ * Sends commands to a lane, waiting up to @timeout ms if the lane is full.
+ * Regular commands that could not be sent are dropped (@see cmd_drop).
+ *
+ * @return Int. Number of commands sent
+ */
+static int cmd_send_lane_timeout(cmd_t **cmds, int n, cmd_lane_t lane, uint32_t timeout)
+{
+    int i, j, first, n_sent, sent = 0;
+
+    if(lane < 0 || lane >= CMD_LANE_LAST)
+    {
+        LOGW(tag, "Invalid dispatcher lane (%d), using ground lane", lane);
+        lane = CMD_LANE_GROUND;
+    }
+
+    portTick now = osTaskGetTickCount();
+    for(i=0; i<n; i++)
+    {
+        cmds[i]->lane = lane;
+        cmds[i]->sent = now;
+    }
+
+    // Regular commands are sent together, coalescible commands one by one
+    for(i=0, first=0; i<=n; i++)
+    {
+        if(i < n && !cmd_is_coalescible(cmds[i]))
+            continue;
+        if(i > first)
+        {
+            n_sent = cmd_lane_send(cmds+first, i-first, lane, timeout);
+            for(j=first+n_sent; j<i; j++)
+                cmd_drop(cmds[j], lane);
+            sent += n_sent;
         }
+        if(i < n)
+            sent += cmd_coalesce_send(cmds[i], lane);
+        first = i+1;
     }
+    return sent;
+}
+
+/**
+ * Sends commands to a lane and notifies the dispatcher. Commands are sent
+ * first, so the dispatcher always finds a command for each notification.
+ * dispatcher_queue fits all lanes, so it never blocks here. If the lane is
+ * full, the commands already sent are notified before waiting.
+ *
+ * @return Int. Number of commands sent
+ */
+static int cmd_lane_send(cmd_t **cmds, int n, cmd_lane_t lane, uint32_t timeout)
+{
+    int i, sent = 0;
 
-    if(ok <= 0)
+    while(sent < n)
     {
-        LOGE(tag, "Error parsing command!");
+        int n_sent = osQueueSendBatch(cmd_lane_queue[lane], cmds+sent, n-sent, 0);
+        if(n_sent == 0 && timeout > 0 &&
+           osQueueSend(cmd_lane_queue[lane], &cmds[sent], timeout) == pdPASS)
+            n_sent = 1;
+        if(n_sent == 0)
+            break;
+
+        int notifications[n_sent];
+        for(i=0; i<n_sent; i++)
+            notifications[i] = lane;
+        osQueueSendBatch(dispatcher_queue, notifications, n_sent, portMAX_DELAY);
+        sent += n_sent;
     }
+    return sent;
+}
 
-    // Return the command filled with parameters or a NULL pointer
-    return new_cmd;
+/**
+ * Checks if a command can be merged with identical pending commands
+ */
+static int cmd_is_coalescible(cmd_t *cmd)
+{
+    return cmd->coalesce && cmd->callback == NULL;
+}
+
+/**
+ * Compares the parameters of two commands of the same type, both the parsed
+ * values and the parameters string
+ */
+static int cmd_params_equal(cmd_t *a, cmd_t *b)
+{
+    int i;
+
+    if(a->args.argc != b->args.argc)
+        return 0;
+
+    for(i=0; i<a->args.argc; i++)
+    {
+        if(a->schema[i] == 's')
+        {
+            if(strcmp(a->args.argv[i].s, b->args.argv[i].s) != 0)
+                return 0;
+        }
+        else if(a->args.argv[i].u != b->args.argv[i].u)
+        {
+            return 0;
+        }
+    }
+
+    if(a->params == NULL || b->params == NULL)
+        return a->params == b->params;
+    return strcmp(a->params, b->params) == 0;
+}
+
+/**
+ * Sends a coalescible command. The command is freed if an identical command
+ * is pending, or if the lane is full.
+ *
+ * @return Int. 1 if the command was sent or merged, 0 if it was dropped
+ */
+static int cmd_coalesce_send(cmd_t *cmd, cmd_lane_t lane)
+{
+    cmd_t *pending;
+    int i, slot = -1;
+
+    osSemaphoreTake(&cmd_pending_sem, portMAX_DELAY);
+    for(i=0; i<SCH_CMD_COALESCE_ENTRIES; i++)
+    {
+        pending = cmd_pending[i];
+        if(pending == NULL)
+        {
+            if(slot < 0)
+                slot = i;
+            continue;
+        }
+
+        if(pending->id == cmd->id && cmd_params_equal(pending, cmd))
+        {
+            cmd_send_stats.coalesced++;
+            osSemaphoreGiven(&cmd_pending_sem);
+            LOGD(tag, "Command %d merged with a pending one", cmd->id);
+            cmd->coalesce = 0;
+            cmd_free(cmd);
+            return 1;
+        }
+    }
+
+    // Track the new pending command, if there is room
+    if(slot >= 0)
+        cmd_pending[slot] = cmd;
+    osSemaphoreGiven(&cmd_pending_sem);
+
+    if(cmd_lane_send(&cmd, 1, lane, 0) == 1)
+        return 1;
+
+    // The lane is full, drop the command instead of blocking the sender
+    cmd_drop(cmd, lane);
+    return 0;
+}
+
+/**
+ * Drops a command that did not fit in its lane. The completion callback, if
+ * any, receives CMD_ERROR as if the dispatcher rejected the command.
+ */
+static void cmd_drop(cmd_t *cmd, cmd_lane_t lane)
+{
+    osSemaphoreTake(&cmd_pending_sem, portMAX_DELAY);
+    cmd_send_stats.dropped++;
+    osSemaphoreGiven(&cmd_pending_sem);
+    LOGW(tag, "Command %d dropped, lane %d is full", cmd->id, lane);
+    if(cmd->callback != NULL)
+        cmd->callback(cmd, CMD_ERROR, cmd->callback_arg);
+    cmd_free(cmd);
+}
+
+void cmd_set_coalesce(cmd_t *cmd, int coalesce)
+{
+    if(cmd == NULL)
+        return;
+
+    if(coalesce && strchr(cmd->schema, 'p') != NULL)
+    {
+        LOGW(tag, "Commands with raw parameters can not be coalesced");
+        return;
+    }
+    cmd->coalesce = coalesce;
+}
+
+void cmd_coalesce_remove(cmd_t *cmd)
+{
+    int i;
+
+    if(cmd == NULL || !cmd->coalesce)
+        return;
+
+    osSemaphoreTake(&cmd_pending_sem, portMAX_DELAY);
+    for(i=0; i<SCH_CMD_COALESCE_ENTRIES; i++)
+    {
+        if(cmd_pending[i] == cmd)
+            cmd_pending[i] = NULL;
+    }
+    osSemaphoreGiven(&cmd_pending_sem);
+    cmd->coalesce = 0;
+}
+
+void cmd_get_send_stats(cmd_send_stats_t *stats)
+{
+    osSemaphoreTake(&cmd_pending_sem, portMAX_DELAY);
+    *stats = cmd_send_stats;
+    osSemaphoreGiven(&cmd_pending_sem);
+}
+
+cmd_t *cmd_lane_receive(cmd_lane_t lane)
+{
+    cmd_t *cmd = NULL;
+    if(osQueueReceive(cmd_lane_queue[lane], &cmd, 0) != pdPASS)
+        return NULL;
+    return cmd;
+}
+
+int cmd_lane_size(cmd_lane_t lane)
+{
+    return osQueueSize(cmd_lane_queue[lane]);
+}
+
+void cmd_set_callback(cmd_t *cmd, cmdCallback callback, void *arg)
+{
+    if(cmd != NULL)
+    {
+        cmd->callback = callback;
+        cmd->callback_arg = arg;
+    }
+}
+
+void cmd_callback_queue(cmd_t *cmd, int result, void *arg)
+{
+    if(osQueueSend((osQueue)arg, &result, 0) != pdPASS)
+        LOGW(tag, "Command %d result %d lost, queue full", cmd->id, result);
 }
 
 void cmd_free(cmd_t *cmd)
 {
     if(cmd != NULL)
     {
+        // A rejected coalescible command is not pending anymore
+        cmd_coalesce_remove(cmd);
         // Free the params if allocated, we don't need free cmd->fmt because
-        // it has not been copied with malloc (see cmd_get_idx)
-        free(cmd->params);
+        // it has not been copied with malloc (see cmd_get_idx). Params inside
+        // an external buffer are freed releasing the buffer owner.
+        if(cmd->release != NULL)
+            cmd->release(cmd->owner);
+        else
+            cmd_params_free(cmd->params);
         // Free the structure itself
-        free(cmd);
+        if(osPoolFree(cmd_pool, cmd) != pdPASS)
+            free(cmd);
     }
 }
 
@@ -257,7 +708,7 @@ void cmd_print_all(void)
 {
 
     LOGD(tag, "Command list");
-    osSemaphoreTake(&repo_cmd_sem, portMAX_DELAY);
+    int locked = cmd_repo_lock();
 
     //Make sure no LOG functions are used in this zone
     osSemaphoreTake(&log_mutex, portMAX_DELAY);
@@ -270,7 +721,7 @@ void cmd_print_all(void)
     osSemaphoreGiven(&log_mutex);
     //End log_mutex, can use LOG functions
 
-    osSemaphoreGiven(&repo_cmd_sem);
+    cmd_repo_unlock(locked);
 
 }
 
@@ -278,7 +729,36 @@ int cmd_repo_init(void)
 {
     // Init repository mutex
     osSemaphoreCreate(&repo_cmd_sem);
+    osSemaphoreSetName(&repo_cmd_sem, "repo_cmd");
+    cmd_repo_sealed = 0;
     cmd_index = 0;  // Reset registered command counter
+    cmd_slots = 0;
+    cmd_hash_rebuild();
+
+    // Init memory pools, only the first time because commands can be in use
+    if(cmd_pool == NULL)
+    {
+        cmd_pool = osPoolCreate(SCH_CMD_POOL_ENTRIES, sizeof(cmd_t));
+        cmd_params_small = osPoolCreate(SCH_CMD_POOL_SMALL_PARAMS, SCH_CMD_MAX_STR_PARAMS);
+        cmd_params_large = osPoolCreate(SCH_CMD_POOL_LARGE_PARAMS, SCH_BUFF_MAX_LEN);
+        if(cmd_pool == NULL || cmd_params_small == NULL || cmd_params_large == NULL)
+            LOGE(tag, "Error creating command pools, using heap");
+
+        // Dispatcher lanes, one notification per command in any lane
+        int lane, notifications = 0;
+        for(lane=0; lane<CMD_LANE_LAST; lane++)
+        {
+            cmd_lane_queue[lane] = osQueueCreate(cmd_lane_depth[lane], sizeof(cmd_t *));
+            if(cmd_lane_queue[lane] == 0)
+                LOGE(tag, "Error creating dispatcher lane %d", lane);
+            notifications += cmd_lane_depth[lane];
+        }
+        dispatcher_queue = osQueueCreate(notifications, sizeof(int));
+        if(dispatcher_queue == 0)
+            LOGE(tag, "Error creating dispatcher queue");
+        osSemaphoreCreate(&cmd_pending_sem);
+        osSemaphoreSetName(&cmd_pending_sem, "cmd_pending");
+    }
 
     // Init repos
 #if SCH_TEST_ENABLED
@@ -304,16 +784,55 @@ int cmd_repo_init(void)
     // Fill command buffer with cmd_null command
     do
     {
-        n_cmd = cmd_add("null", cmd_null, "", 0);
+        n_cmd = cmd_add("null", cmd_null, "", 0, CMD_DOMAIN_OBC);
     }
     while(n_cmd < SCH_CMD_MAX_ENTRIES);
 
     // Restore the number of not null commands
     cmd_index = last_cmd_index;
 
+    // Registration is frozen from now on, lookups do not need the mutex
+    cmd_repo_seal(1);
+
     return CMD_OK;
 }
 
+void cmd_print_pool_stats(void)
+{
+    osPoolStats stats[3];
+    char *names[3] = {"commands", "params small", "params large"};
+    osPool pools[3] = {cmd_pool, cmd_params_small, cmd_params_large};
+    int i;
+
+    for(i=0; i<3; i++)
+    {
+        memset(&stats[i], 0, sizeof(osPoolStats));
+        if(pools[i] != NULL)
+            osPoolGetStats(pools[i], &stats[i]);
+    }
+
+    //Make sure no LOG functions are used in this zone
+    osSemaphoreTake(&log_mutex, portMAX_DELAY);
+    printf("Pool\t\t size\t used\t peak\t capacity\t allocs\t fails\n");
+    for(i=0; i<3; i++)
+    {
+        printf("%s\t %u\t %u\t %u\t %u\t\t %u\t %u\n", names[i],
+               (unsigned)stats[i].block_size, (unsigned)stats[i].used,
+               (unsigned)stats[i].peak, (unsigned)stats[i].capacity,
+               (unsigned)stats[i].allocs, (unsigned)stats[i].fails);
+    }
+    printf("Heap allocations: %u\n", (unsigned)cmd_heap_allocs);
+    osSemaphoreGiven(&log_mutex);
+    //End log_mutex, can use LOG functions
+}
+
+void cmd_repo_seal(int seal)
+{
+    osSemaphoreTake(&repo_cmd_sem, portMAX_DELAY);
+    cmd_repo_sealed = seal;
+    osSemaphoreGiven(&repo_cmd_sem);
+}
+
 void cmd_repo_close(void)
 {
     int i;
@@ -321,10 +840,11 @@ void cmd_repo_close(void)
     {
         free(cmd_list[i].name);
         free(cmd_list[i].fmt);
+        free(cmd_list[i].schema);
     }
 }
 
-int cmd_null(char *fparams, char *params, int nparam)
+int cmd_null(char *fparams, char *params, int nparam, cmd_args_t *args)
 {
     LOGD(tag, "cmd_null was used with params format: %s and params string: %s", fparams, params);
     return CMD_ERROR;
@@ -339,19 +859,22 @@ int cmd_print(cmd_t* cmd)
 
 char* cmd_get_fmt(char* name)
 {
-    char* format = malloc(sizeof(char)*30);
-    int i, ok;
-    for(i=0; i<SCH_CMD_MAX_ENTRIES; i++)
+    char* format = NULL;
+    int idx, locked;
+
+    locked = cmd_repo_lock();
+    idx = cmd_hash_find(name);
+    if(idx != CMD_HASH_EMPTY)
     {
-        osSemaphoreTake(&repo_cmd_sem, portMAX_DELAY);
-        ok = strcmp(name, cmd_list[i].name);
-        osSemaphoreGiven(&repo_cmd_sem);
+        format = malloc(strlen(cmd_list[idx].fmt)+1);
+        if(format != NULL)
+            strcpy(format, cmd_list[idx].fmt);
+    }
+    cmd_repo_unlock(locked);
 
-        if(ok == 0)
-        {
-            strcpy(format,cmd_list[i].fmt);
-            break;
-        }
+    if(idx == CMD_HASH_EMPTY)
+    {
+        LOGW(tag, "Command not found: %s", name);
     }
     return format;
 }
@@ -360,7 +883,7 @@ char* fix_fmt(char* fmt)
 {
     char* new_fmt = malloc(sizeof(char)*SCH_CMD_MAX_STR_PARAMS);
     char* aux = new_fmt;
-    while(*fmt != 0)
+    while(*fmt != 0 && aux < new_fmt + SCH_CMD_MAX_STR_PARAMS - 1)
     {
         if(*fmt ==',')
         {
@@ -373,8 +896,328 @@ char* fix_fmt(char* fmt)
         fmt++;
         aux++;
     }
-    aux++;
     *aux = 0;
     return new_fmt;
 
 }
+
+/**
+ * Hash a command name (FNV-1a, 32 bits)
+ */
+static unsigned int cmd_hash(const char *name)
+{
+    unsigned int hash = 2166136261u;
+    while(*name != 0)
+    {
+        hash ^= (unsigned char)(*name);
+        hash *= 16777619u;
+        name++;
+    }
+    return hash;
+}
+
+/**
+ * Find a command index by name in the name index.
+ * @note repo_cmd_sem must be taken by the caller
+ *
+ * @param name Str. Command name
+ * @return Int. Index in cmd_list or CMD_HASH_EMPTY if not found
+ */
+static int cmd_hash_find(const char *name)
+{
+    unsigned int hash = cmd_hash(name);
+    unsigned int pos = hash % CMD_HASH_SIZE;
+    int idx;
+
+    if(cmd_slots == 0)
+        return CMD_HASH_EMPTY;
+
+    while((idx = cmd_hash_table[pos]) != CMD_HASH_EMPTY)
+    {
+        if(cmd_list[idx].hash == hash && strcmp(name, cmd_list[idx].name) == 0)
+            return idx;
+        pos = (pos + 1) % CMD_HASH_SIZE;
+    }
+    return CMD_HASH_EMPTY;
+}
+
+/**
+ * Add the command in cmd_list[idx] to the name index. If the name is already
+ * registered the first command added is kept.
+ * @note repo_cmd_sem must be taken by the caller
+ *
+ * @param idx Int. Index in cmd_list
+ */
+static void cmd_hash_insert(int idx)
+{
+    unsigned int pos = cmd_list[idx].hash % CMD_HASH_SIZE;
+    int curr;
+
+    while((curr = cmd_hash_table[pos]) != CMD_HASH_EMPTY)
+    {
+        if(cmd_list[curr].hash == cmd_list[idx].hash &&
+           strcmp(cmd_list[curr].name, cmd_list[idx].name) == 0)
+            return;
+        pos = (pos + 1) % CMD_HASH_SIZE;
+    }
+    cmd_hash_table[pos] = idx;
+}
+
+/**
+ * Clear the name index and add again all the filled cmd_list slots
+ * @note repo_cmd_sem must be taken by the caller
+ */
+static void cmd_hash_rebuild(void)
+{
+    int i;
+    for(i=0; i<CMD_HASH_SIZE; i++)
+        cmd_hash_table[i] = CMD_HASH_EMPTY;
+    for(i=0; i<cmd_slots; i++)
+        cmd_hash_insert(i);
+}
+
+/**
+ * Creates a new command from a copy of a cmd_list entry
+ *
+ * @param idx Int. Command index
+ * @param cmd_found cmd_list_t *. Copy of cmd_list[idx]
+ * @return cmd_t * New command (uses malloc)
+ */
+static cmd_t *cmd_new_from_list(int idx, cmd_list_t *cmd_found)
+{
+    cmd_t *cmd_new = NULL;
+
+    if(cmd_pool != NULL)
+        cmd_new = (cmd_t *)osPoolAlloc(cmd_pool);
+    if(cmd_new == NULL)
+    {
+        LOGW(tag, "Command pool exhausted, using heap");
+        cmd_new = (cmd_t *)malloc(sizeof(cmd_t));
+        cmd_heap_allocs++;
+    }
+
+    // Fill parameters
+    cmd_new->id = idx;
+    cmd_new->fmt = cmd_found->fmt;
+    cmd_new->schema = cmd_found->schema;
+    cmd_new->function = cmd_found->function;
+    cmd_new->nparams = cmd_found->nparams;
+    cmd_new->params = NULL;
+    cmd_new->args.argc = 0;
+    cmd_new->owner = NULL;
+    cmd_new->release = NULL;
+    cmd_new->domain = cmd_found->domain;
+    cmd_new->next = NULL;
+    cmd_new->callback = NULL;
+    cmd_new->callback_arg = NULL;
+    cmd_new->lane = CMD_LANE_GROUND;
+    cmd_new->sent = 0;
+    cmd_new->coalesce = 0;
+
+    return cmd_new;
+}
+
+/**
+ * Takes repo_cmd_sem only if the repository is not sealed
+ * @return Int. 1 if the mutex was taken, 0 otherwise. Pass it to
+ * cmd_repo_unlock.
+ */
+static int cmd_repo_lock(void)
+{
+    int locked = !cmd_repo_sealed;
+    if(locked)
+        osSemaphoreTake(&repo_cmd_sem, portMAX_DELAY);
+    return locked;
+}
+
+/**
+ * Releases repo_cmd_sem if it was taken by cmd_repo_lock
+ * @param locked Int. Value returned by cmd_repo_lock
+ */
+static void cmd_repo_unlock(int locked)
+{
+    if(locked)
+        osSemaphoreGiven(&repo_cmd_sem);
+}
+
+/**
+ * Allocates a parameters buffer from the smallest pool that fits @size bytes.
+ * Uses the heap if the buffer is too large or the pools are exhausted.
+ *
+ * @param size Size_t. Buffer size in bytes
+ * @return Pointer to the buffer, release with cmd_params_free
+ */
+static void *cmd_params_alloc(size_t size)
+{
+    void *params = NULL;
+
+    if(size <= SCH_CMD_MAX_STR_PARAMS && cmd_params_small != NULL)
+        params = osPoolAlloc(cmd_params_small);
+    if(params == NULL && size <= SCH_BUFF_MAX_LEN && cmd_params_large != NULL)
+        params = osPoolAlloc(cmd_params_large);
+
+    if(params == NULL)
+    {
+        if(size <= SCH_BUFF_MAX_LEN)
+        {
+            LOGW(tag, "Parameters pool exhausted, using heap (%d bytes)", (int)size);
+        }
+        params = malloc(size);
+        cmd_heap_allocs++;
+    }
+
+    return params;
+}
+
+/**
+ * Releases a parameters buffer allocated with cmd_params_alloc
+ *
+ * @param params Pointer to the buffer. Can be NULL
+ */
+static void cmd_params_free(void *params)
+{
+    if(params == NULL)
+        return;
+    if(osPoolFree(cmd_params_small, params) == pdPASS)
+        return;
+    if(osPoolFree(cmd_params_large, params) == pdPASS)
+        return;
+    free(params);
+}
+
+/**
+ * Compiles a parameters format to a schema, a string with one conversion
+ * char per parameter. Ex. "%d %s %f" is compiled to "dsf". Flags, width and
+ * length modifiers are ignored.
+ *
+ * @param fmt Str. Parameters format
+ * @param schema Str. Buffer to store the schema, at least SCH_CMD_MAX_ARGS+1
+ * @return Int. Number of parameters in the schema
+ */
+static int cmd_fmt_to_schema(const char *fmt, char *schema)
+{
+    int n = 0;
+
+    while(*fmt != 0)
+    {
+        if(*fmt++ != '%')
+            continue;
+
+        // Skip flags, width and length modifiers
+        while(*fmt != 0 && strchr("-+ #0123456789.lhzjt", *fmt) != NULL)
+            fmt++;
+
+        switch(*fmt)
+        {
+            case 'd': case 'i': case 'u': case 'x': case 'f': case 's': case 'p':
+                if(n < SCH_CMD_MAX_ARGS)
+                    schema[n++] = *fmt;
+                else
+                    LOGW(tag, "Too many parameters in format %s", fmt);
+                break;
+            case 'X':
+                if(n < SCH_CMD_MAX_ARGS)
+                    schema[n++] = 'x';
+                break;
+            case 'e': case 'g':
+                if(n < SCH_CMD_MAX_ARGS)
+                    schema[n++] = 'f';
+                break;
+            case '%':
+                break;
+            case 0:
+                continue;
+            default:
+                LOGW(tag, "Unsupported conversion %%%c", *fmt);
+                break;
+        }
+        fmt++;
+    }
+
+    schema[n] = 0;
+    return n;
+}
+
+/**
+ * Parses a parameters string according to a schema. The string is split in
+ * place and string parameters point inside @params. If the last parameter is
+ * a string (or raw data) it takes the rest of @params.
+ *
+ * @param schema Str. Compiled format (@see cmd_fmt_to_schema)
+ * @param params Str. Writable parameters string
+ * @param args cmd_args_t *. Structure to store the parsed parameters
+ * @return Int. Number of parameters parsed successfully
+ */
+static int cmd_args_parse(const char *schema, char *params, cmd_args_t *args)
+{
+    char *next = params;
+    char *token, *end;
+    int i;
+
+    args->argc = 0;
+    if(schema == NULL || params == NULL)
+        return 0;
+
+    for(i=0; schema[i] != 0; i++)
+    {
+        // Skip spaces before the parameter
+        while(*next != 0 && isspace((unsigned char)*next))
+            next++;
+        if(*next == 0)
+            break;
+        token = next;
+
+        if(schema[i+1] == 0 && (schema[i] == 's' || schema[i] == 'p'))
+        {
+            // The last string takes the rest of the line, without trailing
+            // spaces or new line
+            end = token + strlen(token);
+            while(end > token && isspace((unsigned char)end[-1]))
+                end--;
+            *end = 0;
+            next = end;
+        }
+        else
+        {
+            while(*next != 0 && !isspace((unsigned char)*next))
+                next++;
+            if(*next != 0)
+                *next++ = 0;
+        }
+
+        cmd_arg_t *arg = &(args->argv[i]);
+        switch(schema[i])
+        {
+            case 'd':
+                arg->i = (int32_t)strtol(token, &end, 10);
+                break;
+            case 'i':
+                arg->i = (int32_t)strtol(token, &end, 0);
+                break;
+            case 'u':
+                arg->u = (uint32_t)strtoul(token, &end, 10);
+                break;
+            case 'x':
+                arg->u = (uint32_t)strtoul(token, &end, 16);
+                break;
+            case 'f':
+                arg->f = strtof(token, &end);
+                break;
+            case 's':
+                arg->s = token;
+                end = token + strlen(token);
+                break;
+            default:
+                arg->p = token;
+                end = token + strlen(token);
+                break;
+        }
+
+        // Stop at the first invalid parameter, as sscanf does
+        if(end == token || *end != 0)
+            break;
+        args->argc++;
+    }
+
+    return args->argc;
+}
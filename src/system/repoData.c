@@ -29,6 +29,8 @@ char* table = "flightPlan";
 time_t sec = 0;
 #endif
 
+static osEvent dat_events = NULL;   ///< Flight plan and time change events
+
 
 #if SCH_STORAGE_MODE == 0
     #if SCH_STORAGE_TRIPLE_WR == 1
@@ -37,6 +39,201 @@ time_t sec = 0;
         int DAT_SYSTEM_VAR_BUFF[dat_system_last_var];
     #endif
     fp_entry_t data_base [SCH_FP_MAX_ENTRIES];
+#elif SCH_STORAGE_CACHE == 1
+    /* Write-through RAM copy of the status variables (voted values), loaded
+     * at dat_repo_init. Reads do not access the storage. */
+    static int dat_system_cache[dat_system_last_var];
+#endif
+
+/* Written variables are marked as dirty in the cache and committed together
+ * in one transaction, at once or later depending on their persistence tier */
+#if SCH_STORAGE_MODE == 1 && SCH_STORAGE_CACHE == 1
+    #define DAT_USE_CACHE 1
+    static uint8_t dat_system_dirty[dat_system_last_var];
+    static int dat_system_pending = 0;      ///< Writes since the last commit
+#else
+    #define DAT_USE_CACHE 0
+#endif
+
+/* Group commit: the flush timer commits the checkpoint tier variables */
+#if DAT_USE_CACHE && SCH_STORAGE_FLUSH_MS > 0
+    #define DAT_GROUP_COMMIT 1
+    static osTimer dat_flush_timer = NULL;
+    // Skipped flush ticks, only written by the timer task without the mutex
+    static volatile uint32_t dat_flush_busy = 0;
+    static uint32_t dat_flush_busy_reset = 0;
+#else
+    #define DAT_GROUP_COMMIT 0
+#endif
+
+/* Persistence tier of the status variables, DAT_TIER_CHECKPOINT if not listed */
+static const uint8_t dat_system_tier[dat_system_last_var] = {
+    [dat_obc_hrs_alive] = DAT_TIER_DURABLE,
+    [dat_obc_reset_counter] = DAT_TIER_DURABLE,
+    [dat_obc_sw_wdt] = DAT_TIER_VOLATILE,
+    [dat_dep_ant_deployed] = DAT_TIER_DURABLE,
+    [dat_dep_date_time] = DAT_TIER_DURABLE,
+    [dat_rtc_date_time] = DAT_TIER_VOLATILE,
+    [dat_com_count_tc] = DAT_TIER_VOLATILE,
+    [dat_ads_acc_x] = DAT_TIER_VOLATILE,
+    [dat_ads_acc_y] = DAT_TIER_VOLATILE,
+    [dat_ads_acc_z] = DAT_TIER_VOLATILE,
+    [dat_ads_mag_x] = DAT_TIER_VOLATILE,
+    [dat_ads_mag_y] = DAT_TIER_VOLATILE,
+    [dat_ads_mag_z] = DAT_TIER_VOLATILE,
+};
+
+#if SCH_STORAGE_TRIPLE_WR == 1
+    #define DAT_SYSTEM_COPIES 3
+#else
+    #define DAT_SYSTEM_COPIES 1
+#endif
+
+static dat_flush_stats_t dat_flush_stats;
+
+/**
+ * Majority vote of a status variable and its copies
+ */
+static int dat_vote_system_var(dat_system_t index, int value_1, int value_2, int value_3)
+{
+#if SCH_STORAGE_TRIPLE_WR == 1
+    //Compare value and its copies
+    if (value_1 == value_2 || value_1 == value_3)
+    {
+        return value_1;
+    }
+    else if (value_2 == value_3)
+    {
+        return value_2;
+    }
+    else
+    {
+        LOGE(tag, "Unable to get a correct value for index %d", index);
+        return value_1;
+    }
+#else
+    return value_1;
+#endif
+}
+
+/**
+ * Votes all the status variables at once. @copies has the variables followed
+ * by their copies (dat_system_last_var values each), like the storage.
+ */
+static void dat_vote_system_vars(const int *copies, int *values)
+{
+    int index;
+    for(index=0; index<dat_system_last_var; index++)
+    {
+    #if SCH_STORAGE_TRIPLE_WR == 1
+        values[index] = dat_vote_system_var((dat_system_t)index, copies[index],
+                                            copies[index + dat_system_last_var],
+                                            copies[index + dat_system_last_var * 2]);
+    #else
+        values[index] = copies[index];
+    #endif
+    }
+}
+
+#if SCH_STORAGE_MODE == 1
+/**
+ * Reads all the status variables and their copies from the storage at once
+ * and votes. Call with the repository mutex taken.
+ */
+static void dat_storage_get_system_vars(int *values)
+{
+    // Only used with the mutex taken
+    static int copies[dat_system_last_var * DAT_SYSTEM_COPIES];
+    storage_repo_get_values(copies, dat_system_last_var * DAT_SYSTEM_COPIES, DAT_REPO_SYSTEM);
+    dat_vote_system_vars(copies, values);
+}
+
+/**
+ * Reads a status variable and its copies from the storage and votes. Call
+ * with the repository mutex taken.
+ */
+static int dat_storage_get_system_var(dat_system_t index)
+{
+    int value_1 = 0;
+    int value_2 = 0;
+    int value_3 = 0;
+
+    value_1 = storage_repo_get_value_idx(index, DAT_REPO_SYSTEM);
+    //Uses tripled writing
+    #if SCH_STORAGE_TRIPLE_WR == 1
+        value_2 = storage_repo_get_value_idx(index + dat_system_last_var, DAT_REPO_SYSTEM);
+        value_3 = storage_repo_get_value_idx(index + dat_system_last_var * 2, DAT_REPO_SYSTEM);
+    #endif
+
+    return dat_vote_system_var(index, value_1, value_2, value_3);
+}
+
+/**
+ * Writes a status variable and its copies to the storage. Call with the
+ * repository mutex taken.
+ */
+static void dat_storage_set_system_var(dat_system_t index, int value)
+{
+    storage_repo_set_value_idx(index, value, DAT_REPO_SYSTEM);
+    //Uses tripled writing
+    #if SCH_STORAGE_TRIPLE_WR == 1
+        storage_repo_set_value_idx(index + dat_system_last_var, value, DAT_REPO_SYSTEM);
+        storage_repo_set_value_idx(index + dat_system_last_var * 2, value, DAT_REPO_SYSTEM);
+    #endif
+}
+#endif
+
+#if DAT_USE_CACHE
+/**
+ * Commits the dirty status variables of the cache to the storage in one
+ * transaction. Call with the repository mutex taken.
+ *
+ * @param sync Int. 1 to wait until the transaction is written to the storage
+ * device, 0 if it can be synced later (the transaction is not lost if the
+ * software crashes, but may be lost with a power failure)
+ */
+static int dat_flush_locked(int sync)
+{
+    int index;
+    int rc;
+
+    if(dat_system_pending == 0)
+        return 0;
+
+    storage_transaction_begin(sync);
+    for(index=0; index<dat_system_last_var; index++)
+    {
+        if(dat_system_dirty[index])
+        {
+            dat_storage_set_system_var((dat_system_t)index, dat_system_cache[index]);
+            dat_system_dirty[index] = 0;
+            dat_flush_stats.rows += DAT_SYSTEM_COPIES;
+        }
+    }
+    rc = storage_transaction_commit();
+    dat_flush_stats.commits++;
+    dat_flush_stats.synced += sync;
+    dat_system_pending = 0;
+    return rc;
+}
+#endif
+
+#if DAT_GROUP_COMMIT
+/**
+ * Flush timer callback, commits the pending writes periodically. Runs in the
+ * timer task, so it does not wait for the repository mutex: if it is taken
+ * the writes stay pending until the next tick.
+ */
+static void dat_flush_callback(void *arg)
+{
+    if(osSemaphoreTake(&repo_data_sem, 0) != CSP_SEMAPHORE_OK)
+    {
+        dat_flush_busy++;
+        return;
+    }
+    dat_flush_locked(0);
+    osSemaphoreGiven(&repo_data_sem);
+}
 #endif
 
 
@@ -47,6 +244,9 @@ void dat_repo_init(void)
     {
         LOGE(tag, "Unable to create data repository mutex");
     }
+    osSemaphoreSetName(&repo_data_sem, "repo_data");
+    if(dat_events == NULL)
+        dat_events = osEventCreate();
 
     LOGD(tag, "Initializing data repositories buffers...")
     /* TODO: Setup external memories */
@@ -84,21 +284,51 @@ void dat_repo_init(void)
         //Init system flight plan table
         rc=storage_table_flight_plan_init(0);
         assertf(rc==0, tag, "Unable to create flight plan table");
+
+    #if SCH_STORAGE_CACHE == 1
+        //Load the status variables cache, copies are voted only once here.
+        //Volatile variables are not stored, they start from 0
+        int index;
+        osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+        dat_storage_get_system_vars(dat_system_cache);
+        for(index=0; index<dat_system_last_var; index++)
+        {
+            if(dat_system_tier[index] == DAT_TIER_VOLATILE)
+                dat_system_cache[index] = 0;
+        }
+        osSemaphoreGiven(&repo_data_sem);
+    #endif
+
+    #if DAT_GROUP_COMMIT
+        //Commit the written variables periodically
+        if(dat_flush_timer == NULL)
+            dat_flush_timer = osTimerCreate("dat_flush", SCH_STORAGE_FLUSH_MS, 1, dat_flush_callback, NULL);
+        if(dat_flush_timer == NULL || osTimerStart(dat_flush_timer) != pdPASS)
+            LOGE(tag, "Unable to start the status variables flush timer");
+    #endif
     }
 #endif
 
     /* TODO: Initialize custom variables */
     LOGD(tag, "Initializing system variables values...")
     dat_set_system_var(dat_obc_hrs_wo_reset, 0);
-    dat_set_system_var(dat_obc_reset_counter, dat_get_system_var(dat_obc_reset_counter) + 1);
+    dat_add_system_var(dat_obc_reset_counter, 1);
     dat_set_system_var(dat_obc_sw_wdt, 0);  // Reset the gnd wdt on boot
+    dat_flush();  // Boot values must survive the next reset
 }
 
 void dat_repo_close(void)
 {
 #if SCH_STORAGE_MODE == 1
     {
+    #if DAT_GROUP_COMMIT
+        if(dat_flush_timer != NULL)
+            osTimerStop(dat_flush_timer);
+    #endif
+        dat_flush();
+        osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
         storage_close();
+        osSemaphoreGiven(&repo_data_sem);
     }
 #endif
 }
@@ -113,7 +343,16 @@ void _dat_set_system_var(dat_system_t index, int value)
         DAT_SYSTEM_VAR_BUFF[index] = value;
     //Uses external memory
     #else
+        //Commit pending writes first, so they do not overwrite this copy
+        #if DAT_USE_CACHE
+            dat_flush_locked(0);
+        #endif
         storage_repo_set_value_idx(index, value, DAT_REPO_SYSTEM);
+        //A copy changed, vote again the cached value
+        #if SCH_STORAGE_CACHE == 1
+            dat_system_t var = (dat_system_t)(index % dat_system_last_var);
+            dat_system_cache[var] = dat_storage_get_system_var(var);
+        #endif
     #endif
 
     //Exit critical zone
@@ -130,8 +369,11 @@ int _dat_get_system_var(dat_system_t index)
     //Use internal (volatile) memory
     #if SCH_STORAGE_MODE == 0
         value = DAT_SYSTEM_VAR_BUFF[index];
-    //Uses external (non-volatile) memory
+    //Uses external (non-volatile) memory, commit pending writes first
     #else
+        #if DAT_USE_CACHE
+            dat_flush_locked(0);
+        #endif
         value = storage_repo_get_value_idx(index, DAT_REPO_SYSTEM);
     #endif
 
@@ -141,11 +383,11 @@ int _dat_get_system_var(dat_system_t index)
         return value;
 }
 
-void dat_set_system_var(dat_system_t index, int value)
+/**
+ * Sets a status variable value. Call with the repository mutex taken.
+ */
+static void dat_set_system_var_locked(dat_system_t index, int value)
 {
-    //Enter critical zone
-    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
-
     //Uses internal memory
     #if SCH_STORAGE_MODE == 0
         DAT_SYSTEM_VAR_BUFF[index] = value;
@@ -154,113 +396,218 @@ void dat_set_system_var(dat_system_t index, int value)
             DAT_SYSTEM_VAR_BUFF[index + dat_system_last_var] = value;
             DAT_SYSTEM_VAR_BUFF[index + dat_system_last_var * 2] = value;
         #endif
-    //Uses external memory
+    //Uses the cache, the tier tells when the variable is committed
+    #elif DAT_USE_CACHE
+        dat_system_cache[index] = value;
+        if(dat_system_tier[index] == DAT_TIER_VOLATILE)
+        {
+            dat_flush_stats.skipped++;
+        }
+        else
+        {
+            if(dat_system_dirty[index])
+                dat_flush_stats.coalesced++;
+            dat_system_dirty[index] = 1;
+            dat_system_pending++;
+            // Durable variables are committed and synced at once, the
+            // checkpoint ones with the next group commit
+            if(dat_system_tier[index] == DAT_TIER_DURABLE)
+                dat_flush_locked(1);
+            else if(!DAT_GROUP_COMMIT || dat_system_pending >= SCH_STORAGE_FLUSH_WRITES)
+                dat_flush_locked(0);
+        }
+    //Uses external memory, the value and its copies in one transaction,
+    //synced at once for durable variables
     #else
-        storage_repo_set_value_idx(index, value, DAT_REPO_SYSTEM);
+        int sync = dat_system_tier[index] == DAT_TIER_DURABLE;
+        storage_transaction_begin(sync);
+        dat_storage_set_system_var(index, value);
+        storage_transaction_commit();
+        dat_flush_stats.rows += DAT_SYSTEM_COPIES;
+        dat_flush_stats.commits++;
+        dat_flush_stats.synced += sync;
+    #endif
+    dat_flush_stats.writes++;
+}
+
+/**
+ * Returns a status variable value. Call with the repository mutex taken.
+ */
+static int dat_get_system_var_locked(dat_system_t index)
+{
+    int value_1 = 0;
+
+    //Use internal (volatile) memory
+    #if SCH_STORAGE_MODE == 0
+        int value_2 = 0;
+        int value_3 = 0;
+        value_1 = DAT_SYSTEM_VAR_BUFF[index];
         //Uses tripled writing
         #if SCH_STORAGE_TRIPLE_WR == 1
-            storage_repo_set_value_idx(index + dat_system_last_var, value, DAT_REPO_SYSTEM);
-            storage_repo_set_value_idx(index + dat_system_last_var * 2, value, DAT_REPO_SYSTEM);
+            value_2 = DAT_SYSTEM_VAR_BUFF[index + dat_system_last_var];
+            value_3 = DAT_SYSTEM_VAR_BUFF[index + dat_system_last_var * 2];
         #endif
+        value_1 = dat_vote_system_var(index, value_1, value_2, value_3);
+    //Use the cache, already voted
+    #elif SCH_STORAGE_CACHE == 1
+        value_1 = dat_system_cache[index];
+    //Uses external (non-volatile) memory
+    #else
+        value_1 = dat_storage_get_system_var(index);
     #endif
 
+    return value_1;
+}
+
+void dat_set_system_var(dat_system_t index, int value)
+{
+    //Enter critical zone
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    dat_set_system_var_locked(index, value);
     //Exit critical zone
     osSemaphoreGiven(&repo_data_sem);
 }
 
 int dat_get_system_var(dat_system_t index)
 {
-    int value_1 = 0;
-    int value_2 = 0;
-    int value_3 = 0;
+    int value;
+    //Enter critical zone
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    value = dat_get_system_var_locked(index);
+    //Exit critical zone
+    osSemaphoreGiven(&repo_data_sem);
+    return value;
+}
+
+int dat_add_system_var(dat_system_t index, int delta)
+{
+    int value;
+    //Enter critical zone, read and write without releasing the lock
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    value = dat_get_system_var_locked(index) + delta;
+    dat_set_system_var_locked(index, value);
+    //Exit critical zone
+    osSemaphoreGiven(&repo_data_sem);
+    return value;
+}
+
+int dat_cas_system_var(dat_system_t index, int expected, int value)
+{
+    int swapped = 0;
+    //Enter critical zone, read and write without releasing the lock
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    if(dat_get_system_var_locked(index) == expected)
+    {
+        dat_set_system_var_locked(index, value);
+        swapped = 1;
+    }
+    //Exit critical zone
+    osSemaphoreGiven(&repo_data_sem);
+    return swapped;
+}
+
+int dat_flush(void)
+{
+    int rc = 0;
+#if DAT_USE_CACHE
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    rc = dat_flush_locked(1);
+    osSemaphoreGiven(&repo_data_sem);
+#endif
+    return rc;
+}
+
+void dat_get_system_vars(int *values)
+{
+    assert(values != NULL);
 
     //Enter critical zone
     osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
 
     //Use internal (volatile) memory
     #if SCH_STORAGE_MODE == 0
-        value_1 = DAT_SYSTEM_VAR_BUFF[index];
-        //Uses tripled writing
-        #if SCH_STORAGE_TRIPLE_WR == 1
-            value_2 = DAT_SYSTEM_VAR_BUFF[index + dat_system_last_var];
-            value_3 = DAT_SYSTEM_VAR_BUFF[index + dat_system_last_var * 2];
-        #endif
+        dat_vote_system_vars(DAT_SYSTEM_VAR_BUFF, values);
+    //Use the cache, already voted
+    #elif SCH_STORAGE_CACHE == 1
+        memcpy(values, dat_system_cache, sizeof(dat_system_cache));
     //Uses external (non-volatile) memory
     #else
-        value_1 = storage_repo_get_value_idx(index, DAT_REPO_SYSTEM);
-        //Uses tripled writing
-        #if SCH_STORAGE_TRIPLE_WR == 1
-            value_2 = storage_repo_get_value_idx(index + dat_system_last_var, DAT_REPO_SYSTEM);
-            value_3 = storage_repo_get_value_idx(index + dat_system_last_var * 2, DAT_REPO_SYSTEM);
-        #endif
+        dat_storage_get_system_vars(values);
     #endif
 
     //Exit critical zone
     osSemaphoreGiven(&repo_data_sem);
-    #if SCH_STORAGE_TRIPLE_WR == 1
-        //Compare value and its copies
-        if (value_1 == value_2 || value_1 == value_3)
-        {
-            return value_1;
-        }
-        else if (value_2 == value_3)
-        {
-            return value_2;
-        }
-        else
-        {
-            LOGE(tag, "Unable to get a correct value for index %d", index);
-            return value_1;
-        }
-    #else
-        return value_1;
-    #endif
+}
+
+dat_tier_t dat_get_system_var_tier(dat_system_t index)
+{
+    return (dat_tier_t)dat_system_tier[index];
+}
+
+void dat_get_flush_stats(dat_flush_stats_t *stats, int reset)
+{
+    assert(stats != NULL);
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    *stats = dat_flush_stats;
+#if DAT_GROUP_COMMIT
+    uint32_t busy = dat_flush_busy;
+    stats->busy = busy - dat_flush_busy_reset;
+    if(reset)
+        dat_flush_busy_reset = busy;
+#endif
+    if(reset)
+        memset(&dat_flush_stats, 0, sizeof(dat_flush_stats));
+    osSemaphoreGiven(&repo_data_sem);
 }
 
 void dat_status_to_struct(dat_status_t *status)
 {
+    int values[dat_system_last_var];
     assert(status != NULL);
-    DAT_CPY_SYSTEM_VAR(status, dat_obc_opmode);        ///< General operation mode
-    DAT_CPY_SYSTEM_VAR(status, dat_obc_last_reset);    ///< Last reset source
-    DAT_CPY_SYSTEM_VAR(status, dat_obc_hrs_alive);     ///< Hours since first boot
-    DAT_CPY_SYSTEM_VAR(status, dat_obc_hrs_wo_reset);  ///< Hours since last reset
-    DAT_CPY_SYSTEM_VAR(status, dat_obc_reset_counter); ///< Number of reset since first boot
-    DAT_CPY_SYSTEM_VAR(status, dat_obc_sw_wdt);        ///< Software watchdog timer counter
-    DAT_CPY_SYSTEM_VAR_F(status, dat_obc_temp_1);        ///< Temperature value of the first sensor
-    DAT_CPY_SYSTEM_VAR_F(status, dat_obc_temp_2);        ///< Temperature value of the second sensor
-    DAT_CPY_SYSTEM_VAR_F(status, dat_obc_temp_3);        ///< Temperature value of the gyroscope
-
-    DAT_CPY_SYSTEM_VAR(status, dat_dep_ant_deployed);  ///< Was the antenna deployed?
-    DAT_CPY_SYSTEM_VAR(status, dat_dep_date_time);     ///< Deployment unix
-
-    DAT_CPY_SYSTEM_VAR(status, dat_rtc_date_time);     /// RTC current unix time
-
-    DAT_CPY_SYSTEM_VAR(status, dat_com_count_tm);      ///< number of TM sent
-    DAT_CPY_SYSTEM_VAR(status, dat_com_count_tc);      ///< number of received TC
-    DAT_CPY_SYSTEM_VAR(status, dat_com_last_tc);       ///< Unix time of the last received tc
-    DAT_CPY_SYSTEM_VAR(status, dat_com_freq);          ///< Frequency [Hz]
-    DAT_CPY_SYSTEM_VAR(status, dat_com_tx_pwr);        ///< TX power (0: 25dBm, 1: 27dBm, 2: 28dBm, 3: 30dBm)
-    DAT_CPY_SYSTEM_VAR(status, dat_com_baud);          ///< Baudrate [bps]
-    DAT_CPY_SYSTEM_VAR(status, dat_com_mode);          ///< Framing mode (1: RAW, 2: ASM, 3: HDLC, 4: Viterbi, 5: GOLAY, 6: AX25)
-    DAT_CPY_SYSTEM_VAR(status, dat_com_bcn_period);    ///< Number of seconds between beacon packets
-
-    DAT_CPY_SYSTEM_VAR(status, dat_fpl_last);          ///< Last executed flight plan (unix time)
-    DAT_CPY_SYSTEM_VAR(status, dat_fpl_queue);         ///< Flight plan queue length
-
-    DAT_CPY_SYSTEM_VAR_F(status, dat_ads_acc_x);         ///< Gyroscope acceleration value along the x axis
-    DAT_CPY_SYSTEM_VAR_F(status, dat_ads_acc_y);         ///< Gyroscope acceleration value along the y axis
-    DAT_CPY_SYSTEM_VAR_F(status, dat_ads_acc_z);         ///< Gyroscope acceleration value along the z axis
-    DAT_CPY_SYSTEM_VAR_F(status, dat_ads_mag_x);         ///< Magnetometer x axis
-    DAT_CPY_SYSTEM_VAR_F(status, dat_ads_mag_y);         ///< Magnetometer y axis
-    DAT_CPY_SYSTEM_VAR_F(status, dat_ads_mag_z);         ///< Magnetometer z axis
-
-    DAT_CPY_SYSTEM_VAR(status, dat_eps_vbatt);         ///< Voltage of battery [mV]
-    DAT_CPY_SYSTEM_VAR(status, dat_eps_cur_sun);       ///< Current from boost converters [mA]
-    DAT_CPY_SYSTEM_VAR(status, dat_eps_cur_sys);       ///< Current out of battery [mA]
-    DAT_CPY_SYSTEM_VAR(status, dat_eps_temp_bat0);     ///< Battery temperature sensor
-
-    DAT_CPY_SYSTEM_VAR(status,  dat_mem_temp);
-    DAT_CPY_SYSTEM_VAR(status, dat_mem_ads);
+
+    // Read all the variables at once, then fill the structure
+    dat_get_system_vars(values);
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_obc_opmode);        ///< General operation mode
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_obc_last_reset);    ///< Last reset source
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_obc_hrs_alive);     ///< Hours since first boot
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_obc_hrs_wo_reset);  ///< Hours since last reset
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_obc_reset_counter); ///< Number of reset since first boot
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_obc_sw_wdt);        ///< Software watchdog timer counter
+    DAT_CPY_SNAPSHOT_VAR_F(status, values, dat_obc_temp_1);        ///< Temperature value of the first sensor
+    DAT_CPY_SNAPSHOT_VAR_F(status, values, dat_obc_temp_2);        ///< Temperature value of the second sensor
+    DAT_CPY_SNAPSHOT_VAR_F(status, values, dat_obc_temp_3);        ///< Temperature value of the gyroscope
+
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_dep_ant_deployed);  ///< Was the antenna deployed?
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_dep_date_time);     ///< Deployment unix
+
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_rtc_date_time);     /// RTC current unix time
+
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_com_count_tm);      ///< number of TM sent
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_com_count_tc);      ///< number of received TC
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_com_last_tc);       ///< Unix time of the last received tc
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_com_freq);          ///< Frequency [Hz]
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_com_tx_pwr);        ///< TX power (0: 25dBm, 1: 27dBm, 2: 28dBm, 3: 30dBm)
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_com_baud);          ///< Baudrate [bps]
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_com_mode);          ///< Framing mode (1: RAW, 2: ASM, 3: HDLC, 4: Viterbi, 5: GOLAY, 6: AX25)
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_com_bcn_period);    ///< Number of seconds between beacon packets
+
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_fpl_last);          ///< Last executed flight plan (unix time)
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_fpl_queue);         ///< Flight plan queue length
+
+    DAT_CPY_SNAPSHOT_VAR_F(status, values, dat_ads_acc_x);         ///< Gyroscope acceleration value along the x axis
+    DAT_CPY_SNAPSHOT_VAR_F(status, values, dat_ads_acc_y);         ///< Gyroscope acceleration value along the y axis
+    DAT_CPY_SNAPSHOT_VAR_F(status, values, dat_ads_acc_z);         ///< Gyroscope acceleration value along the z axis
+    DAT_CPY_SNAPSHOT_VAR_F(status, values, dat_ads_mag_x);         ///< Magnetometer x axis
+    DAT_CPY_SNAPSHOT_VAR_F(status, values, dat_ads_mag_y);         ///< Magnetometer y axis
+    DAT_CPY_SNAPSHOT_VAR_F(status, values, dat_ads_mag_z);         ///< Magnetometer z axis
+
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_eps_vbatt);         ///< Voltage of battery [mV]
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_eps_cur_sun);       ///< Current from boost converters [mA]
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_eps_cur_sys);       ///< Current out of battery [mA]
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_eps_temp_bat0);     ///< Battery temperature sensor
+
+    DAT_CPY_SNAPSHOT_VAR(status, values,  dat_mem_temp);
+    DAT_CPY_SNAPSHOT_VAR(status, values, dat_mem_ads);
 
 }
 
@@ -317,8 +664,10 @@ int dat_get_fp(int elapsed_sec, char* command, char* args, int* executions, int*
     {
         if(elapsed_sec == data_base[i].unixtime)
         {
-            strcpy(command, data_base[i].cmd);
-            strcpy(args,data_base[i].args);
+            strncpy(command, data_base[i].cmd, SCH_CMD_MAX_STR_PARAMS-1);
+            command[SCH_CMD_MAX_STR_PARAMS-1] = '\0';
+            strncpy(args, data_base[i].args, SCH_CMD_MAX_STR_PARAMS-1);
+            args[SCH_CMD_MAX_STR_PARAMS-1] = '\0';
             *executions = data_base[i].executions;
             *periodical = data_base[i].periodical;
 
@@ -333,12 +682,25 @@ int dat_get_fp(int elapsed_sec, char* command, char* args, int* executions, int*
     }
     return -1;
 #else
-     return storage_flight_plan_get(elapsed_sec, command, args, executions, periodical);
+    int rc;
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    storage_transaction_begin(1);   // Flight plan changes are always synced
+    rc = storage_flight_plan_get(elapsed_sec, command, args, executions, periodical);
+    storage_transaction_commit();
+    osSemaphoreGiven(&repo_data_sem);
+    return rc;
 #endif
 }
 
 int dat_set_fp(int timetodo, char* command, char* args, int executions, int periodical)
 {
+    // Entries are read back into SCH_CMD_MAX_STR_PARAMS buffers
+    if(strlen(command) >= SCH_CMD_MAX_STR_PARAMS || strlen(args) >= SCH_CMD_MAX_STR_PARAMS)
+    {
+        LOGE(tag, "Flight plan command or args too long (max. %d chars)", SCH_CMD_MAX_STR_PARAMS-1);
+        return -1;
+    }
+
 #if SCH_STORAGE_MODE == 0
     //TODO : agregar signal de segment para responder falla
     int i;
@@ -350,18 +712,25 @@ int dat_set_fp(int timetodo, char* command, char* args, int executions, int peri
             data_base[i].executions = executions;
             data_base[i].periodical = periodical;
 
-            data_base[i].cmd = malloc(sizeof(char)*50);
-            data_base[i].args = malloc(sizeof(char)*50);
+            data_base[i].cmd = malloc(sizeof(char)*(strlen(command)+1));
+            data_base[i].args = malloc(sizeof(char)*(strlen(args)+1));
 
             strcpy(data_base[i].cmd, command);
             strcpy(data_base[i].args,args);
 
+            osEventSet(dat_events, DAT_EVENT_FP);
             return 0;
         }
     }
     return 1;
 #else
-    return storage_flight_plan_set(timetodo, command, args, executions, periodical);
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    storage_transaction_begin(1);   // Flight plan changes are always synced
+    int rc = storage_flight_plan_set(timetodo, command, args, executions, periodical);
+    storage_transaction_commit();
+    osSemaphoreGiven(&repo_data_sem);
+    osEventSet(dat_events, DAT_EVENT_FP);
+    return rc;
 #endif
 }
 
@@ -378,12 +747,19 @@ int dat_del_fp(int timetodo)
             data_base[i].periodical = 0;
             free(data_base[i].args);
             free(data_base[i].cmd);
+            osEventSet(dat_events, DAT_EVENT_FP);
             return 0;
         }
     }
     return 1;
 #else
-    return storage_flight_plan_erase(timetodo);
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    storage_transaction_begin(1);   // Flight plan changes are always synced
+    int rc = storage_flight_plan_erase(timetodo);
+    storage_transaction_commit();
+    osSemaphoreGiven(&repo_data_sem);
+    osEventSet(dat_events, DAT_EVENT_FP);
+    return rc;
 #endif
 }
 
@@ -399,12 +775,45 @@ int dat_reset_fp(void)
         data_base[i].executions = 0;
         data_base[i].periodical = 0;
     }
+    osEventSet(dat_events, DAT_EVENT_FP);
     return 0;
 #else
-    return storage_table_flight_plan_init(1);
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    storage_transaction_begin(1);   // Flight plan changes are always synced
+    int rc = storage_table_flight_plan_init(1);
+    storage_transaction_commit();
+    osSemaphoreGiven(&repo_data_sem);
+    osEventSet(dat_events, DAT_EVENT_FP);
+    return rc;
+#endif
+}
+
+int dat_get_fp_next(int from)
+{
+#if SCH_STORAGE_MODE == 0
+    int i;
+    int next = -1;
+    for(i = 0;i < SCH_FP_MAX_ENTRIES;i++)
+    {
+        int t = data_base[i].unixtime;
+        if(t != 0 && t >= from && (next == -1 || t < next))
+            next = t;
+    }
+    return next;
+#else
+    int next;
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    next = storage_flight_plan_next(from);
+    osSemaphoreGiven(&repo_data_sem);
+    return next;
 #endif
 }
 
+uint32_t dat_wait_events(uint32_t events, uint32_t timeout)
+{
+    return osEventWait(dat_events, events, 0, 1, timeout) & events;
+}
+
 int dat_show_fp (void)
 {
 #if SCH_STORAGE_MODE ==0
@@ -430,7 +839,11 @@ int dat_show_fp (void)
 
     return 0;
 #else
-    return storage_show_table();
+    int rc;
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    rc = storage_show_table();
+    osSemaphoreGiven(&repo_data_sem);
+    return rc;
 #endif
 }
 
@@ -438,6 +851,8 @@ time_t dat_get_time(void)
 {
 #ifdef AVR32
     return sec;
+#elif defined(SIM)
+    return osSimGetTime();
 #else
     return time(NULL);
 #endif
@@ -457,6 +872,7 @@ int dat_set_time(int new_time)
 {
 #ifdef AVR32
     sec = (time_t)new_time;
+    osEventSet(dat_events, DAT_EVENT_TIME);
     return 0;
 #else
     return 0;
@@ -482,7 +898,7 @@ int dat_show_time(int format)
         return 1;
     }
 #else
-    time_t time_to_show = time(NULL);
+    time_t time_to_show = dat_get_time();
     if(format == 0)
     {
         printf("%s\n",ctime(&time_to_show));
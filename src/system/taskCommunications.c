@@ -22,7 +22,7 @@
 static const char *tag = "Communications";
 
 static void com_receive_tc(csp_packet_t *packet);
-static void com_receive_cmd(csp_packet_t *packet);
+static int com_packet_to_cmds(csp_packet_t *packet, cmd_t **cmds);
 static void com_receive_tm(csp_packet_t *packet);
 
 void taskCommunications(void *param)
@@ -52,8 +52,6 @@ void taskCommunications(void *param)
     rep_ok_tmp->data[0] = 200;
     rep_ok_tmp->length = 1;
 
-    int count_tc;
-
     while(1)
     {
         /* CSP SERVER */
@@ -64,16 +62,14 @@ void taskCommunications(void *param)
         /* Read packets. Timeout is 500 ms */
         while ((packet = csp_read(conn, 500)) != NULL)
         {
-            count_tc = dat_get_system_var(dat_com_count_tc) + 1;
-            dat_set_system_var(dat_com_count_tc, count_tc);
-            dat_set_system_var(dat_com_last_tc, (int) time(NULL));
+            dat_add_system_var(dat_com_count_tc, 1);
+            dat_set_system_var(dat_com_last_tc, (int) dat_get_time());
 
             switch (csp_conn_dport(conn))
             {
                 case SCH_TRX_PORT_TC:
                     /* Process incoming TC */
-                    com_receive_tc(packet);
-                    csp_buffer_free(packet);
+                    com_receive_tc(packet);  // The packet is released by the command
                     // Create a response packet and send
                     rep_ok = csp_buffer_clone(rep_ok_tmp);
                     csp_send(conn, rep_ok, 1000);
@@ -107,9 +103,8 @@ void taskCommunications(void *param)
                     break;
 
                 case SCH_TRX_PORT_CMD:
-                    /* Command port, executes console commands */
-                    com_receive_cmd(packet);
-                    csp_buffer_free(packet);
+                    /* Command port, executes console commands as TC */
+                    com_receive_tc(packet);  // The packet is released by the command
                     // Create a response packet and send
                     rep_ok = csp_buffer_clone(rep_ok_tmp);
                     csp_send(conn, rep_ok, 1000);
@@ -128,40 +123,62 @@ void taskCommunications(void *param)
 }
 
 /**
- * Parse TC frames and generates corresponding commands
+ * Parse TC frames and generates corresponding commands. Used by the TC and
+ * the command ports, both carry console commands.
  *
- * @param packet A csp buffer containing a null terminated string with the
- *               format <command> [parameters]
+ * @param packet A csp buffer containing a string with the format
+ *               <command> [parameters][;<command> [parameters]...]. The
+ *               packet is released by this function or after the command
+ *               execution.
  */
 static void com_receive_tc(csp_packet_t *packet)
 {
-    /* TODO: this function should receive several (cmd,args) pairs */
-    /* TODO: check com_receive_cmd implementation */
+    cmd_t *new_cmds[SCH_CMD_MAX_BATCH];
+    int n_cmds = com_packet_to_cmds(packet, new_cmds);
 
-    // Make sure the buffer is a null terminated string
-    packet->data[packet->length] = '\0';
-    cmd_t *new_cmd = cmd_parse_from_str((char *)(packet->data));
-
-    // Send command to execution if not null
-    if(new_cmd != NULL)
-        cmd_send(new_cmd);
+    // Send all the commands to execution at once
+    if(n_cmds > 0)
+        cmd_send_lane_batch(new_cmds, n_cmds, CMD_LANE_GROUND);
 }
 
 /**
- * Parse tc frame as console commands and execute the commands
+ * Creates the commands in a packet with the format
+ * <command> [parameters][;<command> [parameters]...].
+ *
+ * A single command is parsed in place and keeps the packet as its parameters
+ * buffer until it is freed, so the packet is not copied. If only a few CSP
+ * buffers remain, the parameters are copied and the packet is released to not
+ * starve the CSP stack while the command waits for execution. Packets with
+ * several commands are always copied, one copy per command.
  *
- * @param packet A csp buffer containing a null terminated string with the
- *               format <command> [parameters]
+ * @param packet A csp buffer containing a string. The packet is owned by the
+ *               returned command, or released by this function.
+ * @param cmds cmd_t **. Array of SCH_CMD_MAX_BATCH to store the new commands
+ * @return Int. Number of commands stored in @cmds
  */
-static void com_receive_cmd(csp_packet_t *packet)
+static int com_packet_to_cmds(csp_packet_t *packet, cmd_t **cmds)
 {
+    char *buff = (char *)(packet->data);
+
     // Make sure the buffer is a null terminated string
+    if(packet->length >= SCH_BUFF_MAX_LEN)
+        packet->length = SCH_BUFF_MAX_LEN - 1;
     packet->data[packet->length] = '\0';
-    cmd_t *new_cmd = cmd_parse_from_str((char *)(packet->data));
 
-    // Send command to execution if not null
-    if(new_cmd != NULL)
-        cmd_send(new_cmd);
+    if(strchr(buff, SCH_CMD_DELIMITER) == NULL &&
+       csp_buffer_remaining() >= SCH_BUFFERS_CSP_FREE)
+    {
+        cmds[0] = cmd_parse_from_buff(buff, packet, csp_buffer_free);
+        if(cmds[0] != NULL)
+            return 1;
+        csp_buffer_free(packet);
+        return 0;
+    }
+
+    LOGD(tag, "Copying TC (CSP buffers left: %d)", csp_buffer_remaining());
+    int n_cmds = cmd_parse_batch_from_str(buff, cmds, SCH_CMD_MAX_BATCH);
+    csp_buffer_free(packet);
+    return n_cmds;
 }
 
 /**
@@ -185,7 +202,12 @@ static void com_receive_tm(csp_packet_t *packet)
         case TM_TYPE_STATUS:
             cmd_parse_tm = cmd_get_str("tm_parse_status");
             cmd_add_params_raw(cmd_parse_tm, frame->data.data8, sizeof(frame->data));
-            cmd_send(cmd_parse_tm);
+            cmd_send_lane(cmd_parse_tm, CMD_LANE_GROUND);
+            break;
+        case TM_TYPE_OS_STATS:
+            cmd_parse_tm = cmd_get_str("tm_parse_os_stats");
+            cmd_add_params_raw(cmd_parse_tm, frame->data.data8, sizeof(frame->data));
+            cmd_send_lane(cmd_parse_tm, CMD_LANE_GROUND);
             break;
         default:
             LOGW(tag, "Undefined telemetry type %d!", frame->type);
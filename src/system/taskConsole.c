@@ -24,6 +24,8 @@
 
 static const char *tag = "Console";
 
+static void console_cmd_done(cmd_t *cmd, int result, void *arg);
+
 const char console_banner[] =
 "\n______________________________________________________________________________\n\
                      ___ _   _  ___ _  _   _   ___ \n\
@@ -40,7 +42,8 @@ void taskConsole(void *param)
     LOGI(tag, "Started");
 
     portTick delay_ms = 250;
-    cmd_t *new_cmd =  NULL;
+    cmd_t *new_cmds[SCH_CMD_MAX_BATCH];
+    int n_cmds, i;
     char buffer[SCH_BUFF_MAX_LEN];
 
     /* Initializing console */
@@ -57,17 +60,23 @@ void taskConsole(void *param)
         if(console_read(buffer, SCH_BUFF_MAX_LEN) != 0)
             continue;
 
-        new_cmd = cmd_parse_from_str(buffer);
+        /* Several commands can be entered in one line, ex. cmd1 1;cmd2 */
+        n_cmds = cmd_parse_batch_from_str(buffer, new_cmds, SCH_CMD_MAX_BATCH);
 
-        if(new_cmd != NULL)
+        if(n_cmds > 0)
         {
 #if LOG_LEVEL >= LOG_LVL_DEBUG
-            char *name = cmd_get_name(new_cmd->id);
-            LOGD(tag, "Command sent: %d (%s)", new_cmd->id, name);
-            free(name);
+            for(i=0; i<n_cmds; i++)
+            {
+                char *name = cmd_get_name(new_cmds[i]->id);
+                LOGD(tag, "Command sent: %d (%s)", new_cmds[i]->id, name);
+                free(name);
+            }
 #endif
-            /* Queue NewCmd - Blocking */
-            cmd_send(new_cmd);
+            /* Queue NewCmds - Blocking, results are printed when ready */
+            for(i=0; i<n_cmds; i++)
+                cmd_set_callback(new_cmds[i], console_cmd_done, NULL);
+            cmd_send_lane_batch(new_cmds, n_cmds, CMD_LANE_GROUND);
         }
         else
         {
@@ -76,6 +85,15 @@ void taskConsole(void *param)
     }
 }
 
+/**
+ * Console commands completion callback, shows failed commands to the user
+ */
+static void console_cmd_done(cmd_t *cmd, int result, void *arg)
+{
+    if(result != CMD_OK)
+        LOGW(tag, "Command %d failed (%d)", cmd->id, result);
+}
+
 int console_init(void)
 {
     LOGD(tag, "Init...\n");
@@ -22,35 +22,247 @@
 
 static const char *tag = "Dispatcher";
 
+/* Resource domains state, protected by dispatcher_sem */
+static osSemaphore dispatcher_sem;
+static int domain_busy[CMD_DOMAIN_LAST];        ///< A command of the domain is running
+static cmd_t *domain_first[CMD_DOMAIN_LAST];    ///< First command waiting for the domain
+static cmd_t *domain_last[CMD_DOMAIN_LAST];     ///< Last command waiting for the domain
+
+/* Lanes scheduling, weight 0 means strict priority (@see cmd_lane_t) */
+static const int lane_weight[CMD_LANE_LAST] = {
+    0,
+    SCH_CMD_LANE_GROUND_WEIGHT,
+    SCH_CMD_LANE_FP_WEIGHT,
+    SCH_CMD_LANE_HK_WEIGHT
+};
+static int lane_turn = CMD_LANE_GROUND;               ///< Weighted lane being served
+static int lane_credit = SCH_CMD_LANE_GROUND_WEIGHT;  ///< Commands left in the lane turn
+
+/* Lanes queueing latency, protected by dispatcher_sem */
+static dispatcher_lane_stats_t lane_stats[CMD_LANE_LAST];
+
+#ifdef LINUX
+    #define DISPATCHER_TICKS_TO_US(ticks) (ticks)
+#else
+    #define DISPATCHER_TICKS_TO_US(ticks) ((ticks)*portTICK_RATE_MS*1000)
+#endif
+
+/* Max. number of command notifications read at once */
+#define DISPATCHER_BATCH 8
+
+static cmd_t *dispatcher_next_cmd(void);
+static void dispatcher_send_cmd(cmd_t *new_cmd);
+
 void taskDispatcher(void *param)
 {
 	LOGI(tag, "Started");
 
-    int status; /* Status of cmd reading operation */
+    int n_notified;                  /* Number of notifications read */
+    int lanes[DISPATCHER_BATCH];     /* Lanes of the new commands notifications */
+    int i;
 
     cmd_t *new_cmd = NULL; /* The new cmd read */
-    int cmd_result;
+
+    osSemaphoreCreate(&dispatcher_sem);
+    osSemaphoreSetName(&dispatcher_sem, "dispatcher");
 
     while(1)
     {
-        /* Read new_cmd from Queue - Blocking */
-        status = osQueueReceive(dispatcher_queue, &new_cmd, portMAX_DELAY);
+        /* Wait for new commands in any lane, take all the notifications of a
+         * burst at once - Blocking */
+        n_notified = osQueueReceiveBatch(dispatcher_queue, lanes, DISPATCHER_BATCH, portMAX_DELAY);
 
-        if(status == pdPASS)
+        for(i=0; i<n_notified; i++)
         {
+            /* Take the next command by lane priority, not the notified one */
+            if((new_cmd = dispatcher_next_cmd()) == NULL)
+                continue;
+
             /* Check if command is executable */
             if (check_if_executable(new_cmd))
             {
+                /* Send the command to executer or wait for its domain */
+                LOGD(tag, "Cmd: %X, Param: %p, Domain: %d, Lane: %d", new_cmd->id, &(new_cmd->params), new_cmd->domain, new_cmd->lane);
+                dispatcher_send_cmd(new_cmd);
+            }
+            else
+            {
+                /* Notify the rejection to whoever sent the command */
+                if(new_cmd->callback != NULL)
+                    new_cmd->callback(new_cmd, CMD_ERROR, new_cmd->callback_arg);
+                cmd_free(new_cmd);
+            }
+        }
+    }
+}
 
-                /* Send the command to executer Queue - BLOCKING */
-                osQueueSend(executer_cmd_queue, &new_cmd, portMAX_DELAY);
-                LOGD(tag, "Cmd: %X, Param: %p, Orig: %X", new_cmd->id, &(new_cmd->params), -1);
+/**
+ * Takes the next command from the lanes. Strict priority lanes (weight 0) are
+ * served first, in order. The other lanes are served in turns of up to
+ * lane_weight commands, so a busy lane can not starve the others.
+ *
+ * @return cmd_t *. Next command or NULL if all lanes are empty
+ */
+static cmd_t *dispatcher_next_cmd(void)
+{
+    cmd_t *cmd;
+    int lane, i;
 
-                /* Get the result from Executer Stat Queue - BLOCKING */
-                osQueueReceive(executer_stat_queue, &cmd_result, portMAX_DELAY);
-            }
+    for(lane=0; lane<CMD_LANE_LAST; lane++)
+    {
+        if(lane_weight[lane] == 0 && (cmd = cmd_lane_receive(lane)) != NULL)
+            return cmd;
+    }
+
+    // Visit every lane once, plus the current one again with a new turn
+    for(i=0; i<=CMD_LANE_LAST; i++)
+    {
+        if(lane_weight[lane_turn] > 0 && lane_credit > 0 &&
+           (cmd = cmd_lane_receive(lane_turn)) != NULL)
+        {
+            lane_credit--;
+            return cmd;
         }
+        lane_turn = (lane_turn + 1) % CMD_LANE_LAST;
+        lane_credit = lane_weight[lane_turn];
     }
+
+    LOGW(tag, "Notified command not found in lanes");
+    return NULL;
+}
+
+/**
+ * Sends a command to the executer tasks if no other command of the same domain
+ * is running, otherwise the command waits until the domain is released
+ * (@see dispatcher_cmd_done). Waiting commands are sorted by lane, and by
+ * arrival within the same lane.
+ *
+ * @param new_cmd cmd_t *. Command to execute
+ */
+static void dispatcher_send_cmd(cmd_t *new_cmd)
+{
+    cmd_domain_t domain = new_cmd->domain;
+    int busy;
+
+    osSemaphoreTake(&dispatcher_sem, portMAX_DELAY);
+    busy = domain_busy[domain];
+    if(busy)
+    {
+        // Add to the domain waiting list, after the commands of the same or
+        // higher priority lanes
+        cmd_t *prev = NULL, *curr = domain_first[domain];
+        while(curr != NULL && curr->lane <= new_cmd->lane)
+        {
+            prev = curr;
+            curr = curr->next;
+        }
+        new_cmd->next = curr;
+        if(prev == NULL)
+            domain_first[domain] = new_cmd;
+        else
+            prev->next = new_cmd;
+        if(curr == NULL)
+            domain_last[domain] = new_cmd;
+    }
+    else
+    {
+        domain_busy[domain] = 1;
+    }
+    osSemaphoreGiven(&dispatcher_sem);
+
+    /* Send the command to executer Queue - BLOCKING if all executers are busy */
+    if(!busy)
+        osQueueSend(executer_cmd_queue, &new_cmd, portMAX_DELAY);
+}
+
+cmd_t *dispatcher_cmd_done(cmd_domain_t domain)
+{
+    cmd_t *next_cmd;
+
+    osSemaphoreTake(&dispatcher_sem, portMAX_DELAY);
+    next_cmd = domain_first[domain];
+    if(next_cmd != NULL)
+    {
+        // The domain is kept busy, the executer runs the next command
+        domain_first[domain] = next_cmd->next;
+        if(domain_first[domain] == NULL)
+            domain_last[domain] = NULL;
+        next_cmd->next = NULL;
+    }
+    else
+    {
+        domain_busy[domain] = 0;
+    }
+    osSemaphoreGiven(&dispatcher_sem);
+
+    return next_cmd;
+}
+
+void dispatcher_cmd_start(cmd_t *cmd)
+{
+    if(cmd->lane < 0 || cmd->lane >= CMD_LANE_LAST)
+        return;
+
+    portTick waited = osTaskGetTickCount() - cmd->sent;
+    uint32_t waited_us = (uint32_t)DISPATCHER_TICKS_TO_US(waited);
+    dispatcher_lane_stats_t *stats = &lane_stats[cmd->lane];
+
+    // Histogram bucket, number of bits of the latency
+    int bucket = waited_us == 0 ? 0 : 32 - __builtin_clz(waited_us);
+    if(bucket >= DISPATCHER_HIST_BUCKETS)
+        bucket = DISPATCHER_HIST_BUCKETS - 1;
+
+    osSemaphoreTake(&dispatcher_sem, portMAX_DELAY);
+    if(stats->count == 0 || waited_us < stats->min_us)
+        stats->min_us = waited_us;
+    stats->count++;
+    stats->total_us += waited_us;
+    stats->last_us = waited_us;
+    if(waited_us > stats->max_us)
+        stats->max_us = waited_us;
+    stats->hist[bucket]++;
+    osSemaphoreGiven(&dispatcher_sem);
+}
+
+uint32_t dispatcher_lane_percentile(dispatcher_lane_stats_t *stats, int percent)
+{
+    uint64_t target = ((uint64_t)stats->count*percent + 99)/100;
+    uint64_t seen = 0;
+    int bucket;
+
+    if(stats->count == 0)
+        return 0;
+
+    for(bucket=0; bucket<DISPATCHER_HIST_BUCKETS-1; bucket++)
+    {
+        seen += stats->hist[bucket];
+        if(seen >= target)
+            break;
+    }
+
+    // Upper limit of the bucket, but never more than the max. latency
+    uint32_t limit = bucket == 0 ? 0 : (uint32_t)((1ULL << bucket) - 1);
+    return limit < stats->max_us ? limit : stats->max_us;
+}
+
+void dispatcher_get_lane_stats(cmd_lane_t lane, dispatcher_lane_stats_t *stats)
+{
+    if(lane < 0 || lane >= CMD_LANE_LAST)
+    {
+        memset(stats, 0, sizeof(dispatcher_lane_stats_t));
+        return;
+    }
+
+    osSemaphoreTake(&dispatcher_sem, portMAX_DELAY);
+    *stats = lane_stats[lane];
+    osSemaphoreGiven(&dispatcher_sem);
+}
+
+void dispatcher_reset_lane_stats(void)
+{
+    osSemaphoreTake(&dispatcher_sem, portMAX_DELAY);
+    memset(lane_stats, 0, sizeof(lane_stats));
+    osSemaphoreGiven(&dispatcher_sem);
 }
 
 int check_if_executable(cmd_t *new_cmd)
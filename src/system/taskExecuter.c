@@ -27,6 +27,9 @@ void taskExecuter(void *param)
     LOGI(tag, "Started");
 
     cmd_t *run_cmd = NULL;
+    cmd_t *next_cmd = NULL;
+    cmd_t *pending_cmd = NULL;  /* Next command of a domain, delayed by a new command */
+    cmd_domain_t domain;
 
     int cmd_stat, queue_stat;
         
@@ -35,7 +38,8 @@ void taskExecuter(void *param)
         /* Read the CMD that Dispatcher sent - BLOCKING */
         queue_stat = osQueueReceive(executer_cmd_queue, &run_cmd, portMAX_DELAY);
 
-        if(queue_stat == pdPASS)
+        /* Run the command and then the commands waiting for the same domain */
+        while(queue_stat == pdPASS && run_cmd != NULL)
         {
 #if LOG_LEVEL >= LOG_LVL_INFO
             char *cmd_name = cmd_get_name(run_cmd->id);
@@ -47,16 +51,40 @@ void taskExecuter(void *param)
 
             /* Execute the command */
             // TODO: Check that we are dereferencing a valid function pointer
-            cmd_stat = run_cmd->function(run_cmd->fmt, run_cmd->params, run_cmd->nparams);
+            domain = run_cmd->domain;
+            dispatcher_cmd_start(run_cmd);
+            cmd_coalesce_remove(run_cmd);
+            cmd_stat = run_cmd->function(run_cmd->fmt, run_cmd->params, run_cmd->nparams, &run_cmd->args);
+
+            /* Deliver the result to whoever sent the command */
+            if(run_cmd->callback != NULL)
+                run_cmd->callback(run_cmd, cmd_stat, run_cmd->callback_arg);
             cmd_free(run_cmd);
-            run_cmd = NULL;
 
             /* Commands may take a long time, so reset the WDT */
             //ClrWdt();
             LOGI(tag, "Command result: %d", cmd_stat);
 
-            /* Send the result to Dispatcher - BLOCKING */
-            osQueueSend(executer_stat_queue, &cmd_stat, portMAX_DELAY);
+            /* Notify the Dispatcher and get the next command of the domain */
+            next_cmd = dispatcher_cmd_done(domain);
+
+            /* A long list of commands of the domain must not delay the new
+             * commands sent by the dispatcher (ex. the watchdog), so run one
+             * new command before continuing with the domain */
+            if(pending_cmd == NULL && next_cmd != NULL &&
+               osQueueReceive(executer_cmd_queue, &run_cmd, 0) == pdPASS)
+            {
+                pending_cmd = next_cmd;
+            }
+            else if(pending_cmd != NULL)
+            {
+                run_cmd = pending_cmd;
+                pending_cmd = next_cmd;
+            }
+            else
+            {
+                run_cmd = next_cmd;
+            }
         }
     }
 }
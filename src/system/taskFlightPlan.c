@@ -22,54 +22,92 @@
 
 static const char *tag = "FlightPlan"; 
 
-void taskFlightPlan(void *param)
-{
+/* Max. time to sleep between checks, bounds the delay if the system clock
+ * changes without DAT_EVENT_TIME (Linux wall clock) */
+#define FP_MAX_SLEEP_MS (10*60*1000)
 
-    LOGI(tag, "Started");
+static void fp_cmd_done(cmd_t *cmd, int result, void *arg);
 
-    portTick delay_ms = 1000;          //Task period in [ms]
-    portTick xLastWakeTime = osTaskGetTickCount();
+/**
+ * Sends the commands of the flight plan entry scheduled at @elapsed_sec
+ */
+static void fp_run_entry(int elapsed_sec)
+{
+    char command[SCH_CMD_MAX_STR_PARAMS];
+    char args[SCH_CMD_MAX_STR_PARAMS];
+    int executions;
+    int periodical;
 
-    time_t elapsed_sec;   // Seconds counter
+    int rc = dat_get_fp(elapsed_sec, command, args, &executions, &periodical);
 
-    while(1)
-    {
-        osTaskDelayUntil(&xLastWakeTime, delay_ms); //Suspend task
-
-#ifdef AVR32
-        elapsed_sec = dat_get_time();
-#else
-        elapsed_sec = time(NULL);
-#endif
+    if(rc == -1){
+        return;
+    }
 
-        char command[SCH_CMD_MAX_STR_PARAMS];
-        char args[SCH_CMD_MAX_STR_PARAMS];
-        int executions;
-        int periodical;
+    char* fixed_args = fix_fmt(args);
+    int i;
+    for(i=0; i < executions; i++)
+    {
+        cmd_t *new_cmd = cmd_get_str(command);
+        if(new_cmd == NULL)
+        {
+            LOGE(tag, "Unknown command in the flight plan: %s, entry dropped", command);
+            // A periodical entry was already scheduled again by dat_get_fp
+            if(periodical > 0)
+                dat_del_fp(elapsed_sec + periodical);
+            break;
+        }
+        cmd_add_params_str(new_cmd, fixed_args);
+
+        LOGD(tag, "Command: %s", command);
+        LOGD(tag, "Arguments: %s", fixed_args);
+        LOGD(tag, "Executions: %d", executions);
+        LOGD(tag, "Periodical: %d", periodical);
+        dat_set_system_var(dat_fpl_last, elapsed_sec);
+        cmd_set_callback(new_cmd, fp_cmd_done, NULL);
+        cmd_send_lane(new_cmd, CMD_LANE_FP);
+    }
+    free(fixed_args);
+}
 
-        int rc = dat_get_fp((int)elapsed_sec, command, args, &executions, &periodical);
+void taskFlightPlan(void *param)
+{
+    LOGI(tag, "Started");
 
-        if(rc == -1){
-            continue;
-        }
+    int last = (int)dat_get_time() - 1;    // Last second checked
+    int now, next;
+    uint32_t sleep_ms;
 
-        char* fixed_args = fix_fmt(args);
-        int i;
-        for(i=0; i < executions; i++)
+    while(1)
+    {
+        // Run the entries due since the last check, in order
+        now = (int)dat_get_time();
+        while((next = dat_get_fp_next(last + 1)) != -1 && next <= now)
         {
-            cmd_t *new_cmd = cmd_get_str(command);
-            cmd_add_params_str(new_cmd, fixed_args);
-
-            LOGD(tag, "Command: %s", command);
-            LOGD(tag, "Arguments: %s", fixed_args);
-            LOGD(tag, "Executions: %d", executions);
-            LOGD(tag, "Periodical: %d", periodical);
-            dat_set_system_var(dat_fpl_last, (int) elapsed_sec);
-            cmd_send(new_cmd);
+            fp_run_entry(next);
+            last = next;
         }
+        last = now;
+
+        // Sleep until the next entry or until the flight plan changes
+        sleep_ms = FP_MAX_SLEEP_MS;
+        if(next != -1 && (uint32_t)(next - now) < FP_MAX_SLEEP_MS/1000)
+            sleep_ms = (uint32_t)(next - now)*1000;
+
+        if(dat_wait_events(DAT_EVENT_FP | DAT_EVENT_TIME, sleep_ms) & DAT_EVENT_TIME)
+            last = (int)dat_get_time() - 1;
     }
 }
 
+/**
+ * Flight plan commands completion callback, reports failed commands
+ */
+static void fp_cmd_done(cmd_t *cmd, int result, void *arg)
+{
+    if(result != CMD_OK)
+        LOGW(tag, "Command %d failed (%d)", cmd->id, result);
+}
+
 int date_to_unixtime(int day, int month, int year, int hour, int min, int sec)
 {
     struct tm str_time;
@@ -22,64 +22,77 @@
 
 static const char *tag = "Housekeeping";
 
-void taskHousekeeping(void *param)
-{
-    LOGI(tag, "Started");
+/* The callbacks run in the timer task, so they never block sending commands.
+ * If the housekeeping lane is full the command is dropped (and counted) and
+ * sent again in the next period. */
 
-    portTick delay_ms    = 1000;            //Task period in [ms]
-
-    unsigned int elapsed_sec = 0;           // Seconds counter
-    unsigned int _10sec_check = 10;     //10[s] condition
-    unsigned int _10min_check = 10*60;  //10[m] condition
-    unsigned int _1hour_check = 60*60;  //01[h] condition
-
-    portTick xLastWakeTime = osTaskGetTickCount();
+/* 1 second actions */
+static void hk_1sec_callback(void *arg)
+{
+    // Debug command
+    cmd_t *cmd_dbg = cmd_get_str("debug_obc");
+    cmd_add_params_var(cmd_dbg, 0);
+    cmd_set_coalesce(cmd_dbg, 1);
+    cmd_try_send_lane(cmd_dbg, CMD_LANE_HK);
 
-    while(1)
-    {
+    dat_set_system_var(dat_rtc_date_time, (int) dat_get_time());
+}
 
-        osTaskDelayUntil(&xLastWakeTime, delay_ms); //Suspend task
-        elapsed_sec += delay_ms/1000; //Update seconds counts
+/* 2 seconds actions */
+static void hk_2sec_callback(void *arg)
+{
+    cmd_t *cmd_2s = cmd_get_str("sample_obc_sensors");
+    cmd_set_coalesce(cmd_2s, 1);
+    cmd_try_send_lane(cmd_2s, CMD_LANE_HK);
+}
 
-        // Debug command
-        cmd_t *cmd_dbg = cmd_get_str("debug_obc");
-        cmd_add_params_var(cmd_dbg, 0);
-        cmd_send(cmd_dbg);
+/* 10 seconds actions */
+static void hk_10sec_callback(void *arg)
+{
+    LOGD(tag, "10 sec tasks");
+    //cmd_t *cmd_10s = cmd_get_str("get_mem");
+    cmd_t *cmd_10s = cmd_get_str("test");
+    cmd_add_params_var(cmd_10s, "Task housekeeping running");
+    cmd_set_coalesce(cmd_10s, 1);
+    cmd_try_send_lane(cmd_10s, CMD_LANE_HK);
+}
 
-        dat_set_system_var(dat_rtc_date_time, (int) time(NULL));
+/* 10 minutes actions */
+static void hk_10min_callback(void *arg)
+{
+    LOGD(tag, "10 min tasks");
+    cmd_t *cmd_10m = cmd_get_str("get_mem");
+    cmd_add_params_var(cmd_10m, 0);
+    cmd_set_coalesce(cmd_10m, 1);
+    cmd_try_send_lane(cmd_10m, CMD_LANE_HK);
+}
 
-        if((elapsed_sec % 2) == 0)
-        {
-            cmd_t *cmd_2s = cmd_get_str("sample_obc_sensors");
-            cmd_send(cmd_2s);
-        }
+/* 1 hour actions */
+static void hk_1hour_callback(void *arg)
+{
+    LOGD(tag, "1 hour check");
+    cmd_t *cmd_1h = cmd_get_str("update_hours_alive");
+    cmd_add_params_var(cmd_1h, 1); // Add 1hr
+    cmd_try_send_lane(cmd_1h, CMD_LANE_HK);
+}
 
-        /* 10 seconds actions */
-        if((elapsed_sec % _10sec_check) == 0)
-        {
-            LOGD(tag, "10 sec tasks");
-            //cmd_t *cmd_10s = cmd_get_str("get_mem");
-            cmd_t *cmd_10s = cmd_get_str("test");
-            cmd_add_params_var(cmd_10s, "Task housekeeping running");
-            cmd_send(cmd_10s);
-        }
+void taskHousekeeping(void *param)
+{
+    LOGI(tag, "Started");
 
-        /* 10 minutes actions */
-        if((elapsed_sec % _10min_check) == 0)
-        {
-            LOGD(tag, "10 min tasks");
-            cmd_t *cmd_10m = cmd_get_str("get_mem");
-            cmd_add_params_var(cmd_10m, 0);
-            cmd_send(cmd_10m);
-        }
+    // One timer per period, the timer task only wakes up when an action is due
+    char *names[] = {"hk_1sec", "hk_2sec", "hk_10sec", "hk_10min", "hk_1hour"};
+    uint32_t periods_ms[] = {1000, 2*1000, 10*1000, 10*60*1000, 60*60*1000};
+    osTimerCallback callbacks[] = {hk_1sec_callback, hk_2sec_callback, hk_10sec_callback,
+                                   hk_10min_callback, hk_1hour_callback};
+    int i;
 
-        /* 1 hours actions */
-        if((elapsed_sec % _1hour_check) == 0)
-        {
-            LOGD(tag, "1 hour check");
-            cmd_t *cmd_1h = cmd_get_str("update_hours_alive");
-            cmd_add_params_var(cmd_1h, 1); // Add 1hr
-            cmd_send(cmd_1h);
-        }
+    for(i=0; i<sizeof(periods_ms)/sizeof(periods_ms[0]); i++)
+    {
+        osTimer timer = osTimerCreate(names[i], periods_ms[i], 1, callbacks[i], NULL);
+        if(timer == NULL || osTimerStart(timer) != pdPASS)
+            LOGE(tag, "Timer %s not started!", names[i]);
     }
+
+    osTaskDelete(NULL);
 }
@@ -81,20 +81,24 @@ void taskInit(void *param)
     os_thread thread_id[n_threads];
 
     /* Creating clients tasks */
-    t_ok = osCreateTask(taskConsole, "console", SCH_TASK_CON_STACK, NULL, 2, &(thread_id[0]));
+#ifndef SIM
+    /* In SIM builds tasks must block only in OS functions, the console input
+     * would stop the virtual clock */
+    t_ok = osCreateTaskAffinity(taskConsole, "console", SCH_TASK_CON_STACK, NULL, 2, SCH_TASK_CON_CPU, &(thread_id[0]));
     if(t_ok != 0) LOGE(tag, "Task console not created!");
+#endif
 
 #if SCH_HK_ENABLED
     t_ok = osCreateTask(taskHousekeeping, "housekeeping", SCH_TASK_HKP_STACK, NULL, 2, &(thread_id[1]));
     if(t_ok != 0) LOGE(tag, "Task housekeeping not created!");
 #endif
-#if SCH_COMM_ENABLE
+#if SCH_COMM_ENABLE && !defined(SIM)
     init_communications();
-    t_ok = osCreateTask(taskCommunications, "comm", SCH_TASK_COM_STACK, NULL, 2, &(thread_id[2]));
+    t_ok = osCreateTaskAffinity(taskCommunications, "comm", SCH_TASK_COM_STACK, NULL, 2, SCH_TASK_COM_CPU, &(thread_id[2]));
     if(t_ok != 0) LOGE(tag, "Task communications not created!");
 #endif
 #if SCH_FP_ENABLED
-    t_ok = osCreateTask(taskFlightPlan,"flightplan", SCH_TASK_FPL_STACK, NULL, 2, &(thread_id[3]));
+    t_ok = osCreateTaskAffinity(taskFlightPlan,"flightplan", SCH_TASK_FPL_STACK, NULL, 2, SCH_TASK_FPL_CPU, &(thread_id[3]));
     if(t_ok != 0) LOGE(tag, "Task flightplan not created!");
 #endif
 
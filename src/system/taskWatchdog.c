@@ -21,39 +21,49 @@
 
 static const char *tag = "WDT";
 
-void taskWatchdog(void *param)
-{
-    LOGI(tag, "Started");
+static unsigned int elapsed_obc_timer = 0; // OBC timer counter
 
-    portTick delay_ms    = 1000;        //Task period in [ms]
+/**
+ * Watchdog timer callback, runs every second. The commands are coalescible,
+ * so a full critical lane never blocks the timer task.
+ */
+static void wdt_timer_callback(void *arg)
+{
     unsigned int max_obc_wdt = SCH_MAX_WDT_TIMER;     // Seconds to send "reset_wdt" command
     unsigned int max_gnd_wdt = SCH_MAX_GND_WDT_TIMER; // Seconds to send "reset" command
-    unsigned int elapsed_obc_timer = 0; // OBC timer counter
     unsigned int elapsed_sw_timer = 0; // Software timer counter
-    portTick xLastWakeTime = osTaskGetTickCount();
-    
-    while(1)
+
+    elapsed_obc_timer++; // Increase timer to reset the obc wdt
+    elapsed_sw_timer = (unsigned  int)dat_add_system_var(dat_obc_sw_wdt, 1); //Increase software timer counter. Should be cleared by a gnd command
+
+    // Periodically reset the OBC watchdog
+    if(elapsed_obc_timer > max_obc_wdt)
     {
-        // Sleep task to count seconds
-        osTaskDelayUntil(&xLastWakeTime, delay_ms);
-        elapsed_obc_timer++; // Increase timer to reset the obc wdt
-        elapsed_sw_timer = (unsigned  int)dat_get_system_var(dat_obc_sw_wdt) + 1; //Increase software timer counter. Should be cleared by a gnd command
-        dat_set_system_var(dat_obc_sw_wdt, elapsed_sw_timer); // Save increased software timer
-
-        // Periodically reset the OBC watchdog
-        if(elapsed_obc_timer > max_obc_wdt)
-        {
+        cmd_t *rst_wdt = cmd_get_str("reset_wdt");
+        cmd_set_coalesce(rst_wdt, 1);
+        // Retry in the next second if the lane is full
+        if(cmd_try_send_lane(rst_wdt, CMD_LANE_CRITICAL) == pdPASS)
             elapsed_obc_timer = 0;
-            cmd_t *rst_wdt = cmd_get_str("reset_wdt");
-            cmd_send(rst_wdt);
-        }
-
-        // If nobody clears elapsed_gnd_timer, then reset the OBC
-        if(elapsed_sw_timer > max_gnd_wdt)
-        {
-            LOGW(tag, "Software watchdog overflow")
-            cmd_t *rst_obc = cmd_get_str("reset");
-            cmd_send(rst_obc);
-        }
     }
+
+    // If nobody clears elapsed_gnd_timer, then reset the OBC
+    if(elapsed_sw_timer > max_gnd_wdt)
+    {
+        LOGW(tag, "Software watchdog overflow")
+        cmd_t *rst_obc = cmd_get_str("reset");
+        cmd_set_coalesce(rst_obc, 1);
+        cmd_try_send_lane(rst_obc, CMD_LANE_CRITICAL);
+    }
+}
+
+void taskWatchdog(void *param)
+{
+    LOGI(tag, "Started");
+
+    // Count seconds in the timer task, this task is not needed anymore
+    osTimer wdt_timer = osTimerCreate("watchdog", 1000, 1, wdt_timer_callback, NULL);
+    if(wdt_timer == NULL || osTimerStart(wdt_timer) != pdPASS)
+        LOGE(tag, "Watchdog timer not started!");
+
+    osTaskDelete(NULL);
 }
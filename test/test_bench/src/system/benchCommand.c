@@ -0,0 +1,191 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchCommand.h"
+
+static const char *tag = "benchCommand";
+
+extern cmd_list_t cmd_list[SCH_CMD_MAX_ENTRIES];
+extern int cmd_index;
+
+/**
+ * Elapsed time between two time stamps in nanoseconds
+ */
+static double bench_elapsed_ns(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec)*1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+/**
+ * Former cmd_get_str implementation, a linear search taking the repository
+ * mutex for every slot. Used as reference.
+ */
+static cmd_t *bench_linear_get_str(char *name)
+{
+    int i, ok;
+    for(i=0; i<SCH_CMD_MAX_ENTRIES; i++)
+    {
+        osSemaphoreTake(&repo_cmd_sem, portMAX_DELAY);
+        ok = strcmp(name, cmd_list[i].name);
+        osSemaphoreGiven(&repo_cmd_sem);
+
+        if(ok == 0)
+            return cmd_get_idx(i);
+    }
+    return NULL;
+}
+
+/**
+ * Average cost in nanoseconds of looking up @name @iterations times
+ */
+static double bench_lookup_ns(char *name, int iterations, int linear)
+{
+    struct timespec start, end;
+    cmd_t *cmd;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i=0; i<iterations; i++)
+    {
+        cmd = linear ? bench_linear_get_str(name) : cmd_get_str(name);
+        cmd_free(cmd);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return bench_elapsed_ns(&start, &end)/iterations;
+}
+
+void bench_cmd_lookup(int iterations)
+{
+    char name[SCH_CMD_MAX_STR_PARAMS];
+    char last[SCH_CMD_MAX_STR_PARAMS];
+    char *first = cmd_list[0].name;
+    int next_report = 1;
+    int n_cmd;
+
+    LOGI(tag, "---- Command lookup benchmark (%d lookups) ----", iterations);
+    printf("%8s %14s %14s %14s %14s\n", "commands", "first (ns)", "last (ns)",
+           "first lin (ns)", "last lin (ns)");
+
+    // Grow the repository replacing the null commands with new ones
+    strncpy(last, cmd_list[cmd_index-1].name, SCH_CMD_MAX_STR_PARAMS-1);
+    last[SCH_CMD_MAX_STR_PARAMS-1] = '\0';
+    while(1)
+    {
+        n_cmd = cmd_index;
+        if(n_cmd >= next_report || n_cmd == SCH_CMD_MAX_ENTRIES)
+        {
+            // The first command is the best case for a linear search and the
+            // last command added is the worst case
+            printf("%8d %14.1f %14.1f %14.1f %14.1f\n", n_cmd,
+                   bench_lookup_ns(first, iterations, 0),
+                   bench_lookup_ns(last, iterations, 0),
+                   bench_lookup_ns(first, iterations, 1),
+                   bench_lookup_ns(last, iterations, 1));
+            while(next_report <= n_cmd)
+                next_report *= 2;
+        }
+
+        if(n_cmd == SCH_CMD_MAX_ENTRIES)
+            break;
+
+        // The repository is sealed after init, unseal to add new commands
+        snprintf(name, SCH_CMD_MAX_STR_PARAMS, "bench_cmd_%04d", n_cmd);
+        cmd_repo_seal(0);
+        n_cmd = cmd_add(name, cmd_null, "", 0, CMD_DOMAIN_OBC);
+        cmd_repo_seal(1);
+        if(n_cmd == CMD_ERROR)
+            break;
+        strcpy(last, name);
+    }
+}
+
+/**
+ * Lookup stress thread parameters
+ */
+typedef struct bench_lookup_arg{
+    char **names;       ///< Command names to look up
+    int n_names;        ///< Number of command names
+    int lookups;        ///< Number of lookups to execute
+} bench_lookup_arg_t;
+
+/**
+ * Lookup stress thread, gets and frees commands by name
+ */
+static void *bench_lookup_thread(void *param)
+{
+    bench_lookup_arg_t *arg = (bench_lookup_arg_t *)param;
+    int i;
+    for(i=0; i<arg->lookups; i++)
+    {
+        cmd_t *cmd = cmd_get_str(arg->names[i % arg->n_names]);
+        cmd_free(cmd);
+    }
+    return NULL;
+}
+
+/**
+ * Runs @n_threads lookup stress threads and returns the throughput in
+ * lookups per second
+ */
+static double bench_lookup_threads(bench_lookup_arg_t *arg, int n_threads)
+{
+    pthread_t threads[n_threads];
+    struct timespec start, end;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i=0; i<n_threads; i++)
+        pthread_create(&threads[i], NULL, bench_lookup_thread, arg);
+    for(i=0; i<n_threads; i++)
+        pthread_join(threads[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (double)arg->lookups*n_threads/(bench_elapsed_ns(&start, &end)/1e9);
+}
+
+void bench_cmd_contention(int max_threads, int lookups)
+{
+    bench_lookup_arg_t arg;
+    int n_threads, i;
+
+    // Look up all the registered commands in turns
+    arg.n_names = cmd_index;
+    arg.names = (char **)malloc(sizeof(char *)*arg.n_names);
+    for(i=0; i<arg.n_names; i++)
+        arg.names[i] = cmd_list[i].name;
+    arg.lookups = lookups;
+
+    LOGI(tag, "---- Command lookup stress benchmark (%d lookups per thread) ----", lookups);
+    printf("%8s %18s %18s %8s\n", "threads", "locked (op/s)", "sealed (op/s)", "speedup");
+
+    for(n_threads=1; n_threads<=max_threads; n_threads*=2)
+    {
+        double locked, sealed;
+
+        cmd_repo_seal(0);
+        locked = bench_lookup_threads(&arg, n_threads);
+        cmd_repo_seal(1);
+        sealed = bench_lookup_threads(&arg, n_threads);
+
+        printf("%8d %18.0f %18.0f %8.2f\n", n_threads, locked, sealed, sealed/locked);
+    }
+
+    free(arg.names);
+}
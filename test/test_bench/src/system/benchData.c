@@ -0,0 +1,413 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchData.h"
+
+static const char *tag = "benchData";
+
+/**
+ * Monotonic time stamp in nanoseconds
+ */
+static uint64_t bench_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec*1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+#if SCH_STORAGE_MODE == 1
+/**
+ * Former dat_get_system_var, reads the value and its copies from the storage
+ */
+static int bench_dat_get_storage(dat_system_t index)
+{
+    int value_1, value_2 = 0, value_3 = 0;
+
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    value_1 = storage_repo_get_value_idx(index, DAT_REPO_SYSTEM);
+#if SCH_STORAGE_TRIPLE_WR == 1
+    value_2 = storage_repo_get_value_idx(index + dat_system_last_var, DAT_REPO_SYSTEM);
+    value_3 = storage_repo_get_value_idx(index + dat_system_last_var * 2, DAT_REPO_SYSTEM);
+#endif
+    osSemaphoreGiven(&repo_data_sem);
+
+#if SCH_STORAGE_TRIPLE_WR == 1
+    if(value_1 == value_2 || value_1 == value_3)
+        return value_1;
+    if(value_2 == value_3)
+        return value_2;
+#endif
+    return value_1;
+}
+#endif
+
+#if SCH_STORAGE_MODE == 1
+/**
+ * Former dat_set_system_var, writes the value and its copies to the storage,
+ * each one committed on its own
+ */
+static void bench_dat_set_storage(dat_system_t index, int value)
+{
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    storage_repo_set_value_idx(index, value, DAT_REPO_SYSTEM);
+#if SCH_STORAGE_TRIPLE_WR == 1
+    storage_repo_set_value_idx(index + dat_system_last_var, value, DAT_REPO_SYSTEM);
+    storage_repo_set_value_idx(index + dat_system_last_var * 2, value, DAT_REPO_SYSTEM);
+#endif
+    osSemaphoreGiven(&repo_data_sem);
+}
+#endif
+
+void bench_dat_get(int reads)
+{
+    uint64_t start, end;
+    volatile int value;
+    int i;
+
+    LOGI(tag, "---- System variables read benchmark (%d reads, storage mode %d, triple write %d, cache %d) ----",
+         reads, SCH_STORAGE_MODE, SCH_STORAGE_TRIPLE_WR, SCH_STORAGE_CACHE);
+    printf("%20s %14s %12s\n", "read", "ops (op/s)", "mean (ns)");
+
+    // Store all the variables, a new database only has a few of them
+    for(i=0; i<dat_system_last_var; i++)
+        dat_set_system_var((dat_system_t)i, i);
+
+    start = bench_now_ns();
+    for(i=0; i<reads; i++)
+        value = dat_get_system_var((dat_system_t)(i % dat_system_last_var));
+    end = bench_now_ns();
+    double get_ns = (double)(end - start)/reads;
+    printf("%20s %14.0f %12.0f\n", "dat_get_system_var", 1e9/get_ns, get_ns);
+
+#if SCH_STORAGE_MODE == 1
+    start = bench_now_ns();
+    for(i=0; i<reads; i++)
+        value = bench_dat_get_storage((dat_system_t)(i % dat_system_last_var));
+    end = bench_now_ns();
+    double storage_ns = (double)(end - start)/reads;
+    printf("%20s %14.0f %12.0f\n", "storage (former)", 1e9/storage_ns, storage_ns);
+    printf("Speedup: %.1fx\n", storage_ns/get_ns);
+#endif
+    (void)value;
+}
+
+
+/**
+ * Writes the variables of one persistence tier (up to @vars of them) in turns
+ * and commits them. Returns the mean time per write in ns, or 0 if no
+ * variable has the tier.
+ */
+static double bench_dat_set_tier(dat_tier_t tier, int writes, int vars, dat_system_t *var_list)
+{
+    uint64_t start, end;
+    int n = 0;
+    int i;
+
+    for(i=0; i<dat_system_last_var && n<vars; i++)
+        if(dat_get_system_var_tier((dat_system_t)i) == tier)
+            var_list[n++] = (dat_system_t)i;
+    if(n == 0)
+        return 0;
+
+    start = bench_now_ns();
+    for(i=0; i<writes; i++)
+        dat_set_system_var(var_list[i % n], i);
+    dat_flush();
+    end = bench_now_ns();
+    return (double)(end - start)/writes;
+}
+
+void bench_dat_set(int writes, int vars)
+{
+    const char *tiers[] = {"checkpoint", "volatile", "durable"};
+    dat_system_t var_list[dat_system_last_var];
+    dat_flush_stats_t stats;
+    double set_ns[3];
+    int tier;
+
+    LOGI(tag, "---- System variables write benchmark (%d writes to %d variables, storage mode %d, flush %d ms) ----",
+         writes, vars, SCH_STORAGE_MODE, SCH_STORAGE_FLUSH_MS);
+    printf("%20s %14s %12s %10s %10s\n", "write", "ops (op/s)", "mean (ns)", "values", "commits");
+
+    dat_flush();
+    dat_get_flush_stats(&stats, 1);
+    for(tier=DAT_TIER_CHECKPOINT; tier<=DAT_TIER_DURABLE; tier++)
+    {
+        set_ns[tier] = bench_dat_set_tier((dat_tier_t)tier, writes, vars, var_list);
+        dat_get_flush_stats(&stats, 1);
+        if(set_ns[tier] > 0)
+            printf("%20s %14.0f %12.0f %10u %10u\n", tiers[tier], 1e9/set_ns[tier], set_ns[tier],
+                   (unsigned int)stats.rows, (unsigned int)stats.commits);
+    }
+
+#if SCH_STORAGE_MODE == 1
+    // The former implementation commits every copy on its own
+    uint64_t start, end;
+    int i;
+    int n = 0;
+    for(i=0; i<dat_system_last_var && n<vars; i++)
+        if(dat_get_system_var_tier((dat_system_t)i) == DAT_TIER_CHECKPOINT)
+            var_list[n++] = (dat_system_t)i;
+
+    start = bench_now_ns();
+    for(i=0; i<writes; i++)
+        bench_dat_set_storage(var_list[i % n], i);
+    end = bench_now_ns();
+    double storage_ns = (double)(end - start)/writes;
+    printf("%20s %14.0f %12.0f %10u %10u\n", "storage (former)", 1e9/storage_ns, storage_ns,
+           (unsigned int)(writes*(SCH_STORAGE_TRIPLE_WR ? 3 : 1)),
+           (unsigned int)(writes*(SCH_STORAGE_TRIPLE_WR ? 3 : 1)));
+    printf("Speedup (checkpoint): %.1fx\n", storage_ns/set_ns[DAT_TIER_CHECKPOINT]);
+#endif
+}
+
+
+/**
+ * Former dat_status_to_struct, reads the variables one by one
+ */
+static void bench_status_to_struct_vars(dat_status_t *status)
+{
+    int values[dat_system_last_var];
+    int i;
+    for(i=0; i<dat_system_last_var; i++)
+        values[i] = dat_get_system_var((dat_system_t)i);
+    memcpy(status, values, sizeof(values));
+}
+
+void bench_tm_status(int reps)
+{
+    uint64_t start, end;
+    dat_status_t status;
+    int i;
+
+    LOGI(tag, "---- TM status benchmark (%d status, storage mode %d, triple write %d, cache %d) ----",
+         reps, SCH_STORAGE_MODE, SCH_STORAGE_TRIPLE_WR, SCH_STORAGE_CACHE);
+    printf("%20s %14s %12s\n", "status", "ops (op/s)", "mean (ns)");
+
+    // Store all the variables, a new database only has a few of them
+    for(i=0; i<dat_system_last_var; i++)
+        dat_set_system_var((dat_system_t)i, i);
+    dat_flush();
+
+    start = bench_now_ns();
+    for(i=0; i<reps; i++)
+        dat_status_to_struct(&status);
+    end = bench_now_ns();
+    double snapshot_ns = (double)(end - start)/reps;
+    printf("%20s %14.0f %12.0f\n", "dat_status_to_struct", 1e9/snapshot_ns, snapshot_ns);
+
+    start = bench_now_ns();
+    for(i=0; i<reps; i++)
+        bench_status_to_struct_vars(&status);
+    end = bench_now_ns();
+    double vars_ns = (double)(end - start)/reps;
+    printf("%20s %14.0f %12.0f\n", "per variable (former)", 1e9/vars_ns, vars_ns);
+    printf("Speedup: %.1fx\n", vars_ns/snapshot_ns);
+}
+
+#if SCH_STORAGE_MODE == 1
+/*
+ * Former storage functions, building the SQL text and preparing the
+ * statement in every call. They use their own connection to the database.
+ */
+static sqlite3 *bench_db = NULL;
+static char *bench_fp_table = "flightPlan";
+
+static int bench_former_callback(void *data, int argc, char **argv, char **names)
+{
+    return 0;
+}
+
+static int bench_former_get_value_idx(int index, char *table)
+{
+    sqlite3_stmt* stmt = NULL;
+    char *sql = sqlite3_mprintf("SELECT value FROM %s WHERE idx=\"%d\";", table, index);
+    int value = -1;
+    if(sqlite3_prepare_v2(bench_db, sql, -1, &stmt, 0) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW)
+        value = sqlite3_column_int(stmt, 0);
+    sqlite3_finalize(stmt);
+    sqlite3_free(sql);
+    return value;
+}
+
+static int bench_former_set_value_idx(int index, int value, char *table)
+{
+    char *sql = sqlite3_mprintf("INSERT OR REPLACE INTO %s (idx, name, value) "
+                                "VALUES (%d, (SELECT name FROM %s WHERE idx = \"%d\"), %d);",
+                                table, index, table, index, value);
+    int rc = sqlite3_exec(bench_db, sql, bench_former_callback, 0, NULL);
+    sqlite3_free(sql);
+    return rc == SQLITE_OK ? 0 : -1;
+}
+
+static int bench_former_fp_set(int timetodo, char* command, char* args, int executions, int periodical)
+{
+    char *sql = sqlite3_mprintf("INSERT OR REPLACE INTO %s (time, command, args, executions, periodical)\n "
+                                "VALUES (%d, \"%s\", \"%s\", %d, %d);",
+                                bench_fp_table, timetodo, command, args, executions, periodical);
+    int rc = sqlite3_exec(bench_db, sql, bench_former_callback, 0, NULL);
+    sqlite3_free(sql);
+    return rc == SQLITE_OK ? 0 : -1;
+}
+
+static int bench_former_fp_erase(int timetodo)
+{
+    char *sql = sqlite3_mprintf("DELETE FROM %s\n WHERE time = %d", bench_fp_table, timetodo);
+    int rc = sqlite3_exec(bench_db, sql, bench_former_callback, 0, NULL);
+    sqlite3_free(sql);
+    return rc == SQLITE_OK ? 0 : -1;
+}
+
+static int bench_former_fp_get(int timetodo, char* command, char* args, int* executions, int* periodical)
+{
+    char **results;
+    int row = 0, col = 0;
+    char *sql = sqlite3_mprintf("SELECT * FROM %s WHERE time = %d", bench_fp_table, timetodo);
+    sqlite3_get_table(bench_db, sql, &results, &row, &col, NULL);
+    sqlite3_free(sql);
+    if(row == 0 || col == 0)
+    {
+        sqlite3_free_table(results);
+        return -1;
+    }
+
+    strcpy(command, results[6]);
+    strcpy(args, results[7]);
+    *executions = atoi(results[8]);
+    *periodical = atoi(results[9]);
+    sqlite3_free_table(results);
+    bench_former_fp_erase(timetodo);
+    return 0;
+}
+
+static int bench_former_fp_next(int from)
+{
+    sqlite3_stmt* stmt = NULL;
+    char *sql = sqlite3_mprintf("SELECT MIN(time) FROM %s WHERE time >= %d;", bench_fp_table, from);
+    int next = -1;
+    if(sqlite3_prepare_v2(bench_db, sql, -1, &stmt, 0) == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW &&
+       sqlite3_column_type(stmt, 0) != SQLITE_NULL)
+        next = sqlite3_column_int(stmt, 0);
+    sqlite3_finalize(stmt);
+    sqlite3_free(sql);
+    return next;
+}
+
+/**
+ * Prints one row of the storage benchmark
+ */
+static void bench_storage_print(const char *call, int ops, uint64_t former_ns, uint64_t prepared_ns)
+{
+    double former = (double)former_ns/ops;
+    double prepared = (double)prepared_ns/ops;
+    printf("%16s %14.0f %14.0f %10.1fx\n", call, 1e9/former, 1e9/prepared, former/prepared);
+}
+#endif
+
+void bench_storage(int ops)
+{
+#if SCH_STORAGE_MODE == 1
+    uint64_t start, former, prepared;
+    volatile int value;
+    char command[SCH_CMD_MAX_STR_PARAMS];
+    char args[SCH_CMD_MAX_STR_PARAMS];
+    int executions, periodical;
+    int i;
+    // Flight plan entries far in the future, removed by the get benchmark
+    int fp_time = 2000000000;
+
+    LOGI(tag, "---- Storage benchmark (%d ops per call, %s) ----", ops, SCH_STORAGE_FILE);
+    if(sqlite3_open(SCH_STORAGE_FILE, &bench_db) != SQLITE_OK)
+    {
+        LOGE(tag, "Can't open database: %s", sqlite3_errmsg(bench_db));
+        return;
+    }
+    printf("%16s %14s %14s %11s\n", "call", "former (op/s)", "prepared (op/s)", "speedup");
+
+    // The storage calls share the prepared statements with the flush timer
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+
+    // Store all the variables, a new database only has a few of them and the
+    // volatile ones are never stored
+    for(i=0; i<dat_system_last_var; i++)
+        storage_repo_set_value_idx(i, i, DAT_REPO_SYSTEM);
+
+    /* storage_repo_get_value_idx */
+    start = bench_now_ns();
+    for(i=0; i<ops; i++)
+        value = bench_former_get_value_idx(i % dat_system_last_var, DAT_REPO_SYSTEM);
+    former = bench_now_ns() - start;
+    start = bench_now_ns();
+    for(i=0; i<ops; i++)
+        value = storage_repo_get_value_idx(i % dat_system_last_var, DAT_REPO_SYSTEM);
+    prepared = bench_now_ns() - start;
+    bench_storage_print("get_value_idx", ops, former, prepared);
+
+    /* storage_repo_set_value_idx */
+    start = bench_now_ns();
+    for(i=0; i<ops; i++)
+        bench_former_set_value_idx(i % dat_system_last_var, ops - i, DAT_REPO_SYSTEM);
+    former = bench_now_ns() - start;
+    start = bench_now_ns();
+    for(i=0; i<ops; i++)
+        storage_repo_set_value_idx(i % dat_system_last_var, ops - i, DAT_REPO_SYSTEM);
+    prepared = bench_now_ns() - start;
+    bench_storage_print("set_value_idx", ops, former, prepared);
+
+    /* storage_flight_plan_set */
+    start = bench_now_ns();
+    for(i=0; i<ops; i++)
+        bench_former_fp_set(fp_time + i, "obc_get_mem", "", 1, 0);
+    former = bench_now_ns() - start;
+    start = bench_now_ns();
+    for(i=0; i<ops; i++)
+        storage_flight_plan_set(fp_time + ops + i, "obc_get_mem", "", 1, 0);
+    prepared = bench_now_ns() - start;
+    bench_storage_print("flight_plan_set", ops, former, prepared);
+
+    /* storage_flight_plan_next */
+    start = bench_now_ns();
+    for(i=0; i<ops; i++)
+        value = bench_former_fp_next(fp_time + i);
+    former = bench_now_ns() - start;
+    start = bench_now_ns();
+    for(i=0; i<ops; i++)
+        value = storage_flight_plan_next(fp_time + i);
+    prepared = bench_now_ns() - start;
+    bench_storage_print("flight_plan_next", ops, former, prepared);
+
+    /* storage_flight_plan_get, also erases the entries */
+    start = bench_now_ns();
+    for(i=0; i<ops; i++)
+        bench_former_fp_get(fp_time + i, command, args, &executions, &periodical);
+    former = bench_now_ns() - start;
+    start = bench_now_ns();
+    for(i=0; i<ops; i++)
+        storage_flight_plan_get(fp_time + ops + i, command, args, &executions, &periodical);
+    prepared = bench_now_ns() - start;
+    bench_storage_print("flight_plan_get", ops, former, prepared);
+    osSemaphoreGiven(&repo_data_sem);
+
+    sqlite3_close(bench_db);
+    bench_db = NULL;
+    (void)value;
+#else
+    LOGW(tag, "Storage benchmark requires SCH_STORAGE_MODE 1");
+#endif
+}
@@ -0,0 +1,357 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchExecuter.h"
+
+static const char *tag = "benchExecuter";
+
+/* Queues of the former lockstep dispatcher and executer */
+static osQueue lockstep_dispatcher_queue;
+static osQueue lockstep_cmd_queue;
+static osQueue lockstep_stat_queue;
+
+/**
+ * Elapsed time between two time stamps in nanoseconds
+ */
+static double bench_elapsed_ns(struct timespec *start, struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec)*1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+/**
+ * Former taskDispatcher implementation, waits the result of every command.
+ * Used as reference.
+ */
+static void bench_lockstep_dispatcher(void *param)
+{
+    cmd_t *new_cmd = NULL;
+    int cmd_result;
+
+    while(1)
+    {
+        if(osQueueReceive(lockstep_dispatcher_queue, &new_cmd, portMAX_DELAY) == pdPASS)
+        {
+            osQueueSend(lockstep_cmd_queue, &new_cmd, portMAX_DELAY);
+            osQueueReceive(lockstep_stat_queue, &cmd_result, portMAX_DELAY);
+        }
+    }
+}
+
+/**
+ * Former taskExecuter implementation, sends the result to the dispatcher.
+ * Used as reference. The result is also delivered to the sender with the
+ * command callback, as in the current implementation.
+ */
+static void bench_lockstep_executer(void *param)
+{
+    cmd_t *run_cmd = NULL;
+    int cmd_stat;
+
+    while(1)
+    {
+        if(osQueueReceive(lockstep_cmd_queue, &run_cmd, portMAX_DELAY) == pdPASS)
+        {
+#if LOG_LEVEL >= LOG_LVL_INFO
+            char *cmd_name = cmd_get_name(run_cmd->id);
+            LOGI(tag, "Running the command: %s...", cmd_name);
+            free(cmd_name);
+#endif
+            cmd_stat = run_cmd->function(run_cmd->fmt, run_cmd->params, run_cmd->nparams, &run_cmd->args);
+            if(run_cmd->callback != NULL)
+                run_cmd->callback(run_cmd, cmd_stat, run_cmd->callback_arg);
+            cmd_free(run_cmd);
+            LOGI(tag, "Command result: %d", cmd_stat);
+            osQueueSend(lockstep_stat_queue, &cmd_stat, portMAX_DELAY);
+        }
+    }
+}
+
+/**
+ * Slow command, sleeps the number of milliseconds in the first argument
+ */
+static int bench_sleep(char *fmt, char *params, int nparams, cmd_args_t *args)
+{
+    osDelay((uint32_t)args->argv[0].i);
+    return CMD_OK;
+}
+
+/**
+ * Sends commands to the lockstep dispatcher or to the current one
+ */
+static int bench_send(cmd_t **cmds, int n, int lockstep)
+{
+    if(lockstep)
+        return osQueueSendBatch(lockstep_dispatcher_queue, cmds, n, portMAX_DELAY);
+    return cmd_send_batch(cmds, n);
+}
+
+static int bench_cmp_double(const void *a, const void *b)
+{
+    double da = *(const double *)a, db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+/**
+ * Sends @iterations commands one by one, waiting for each result.
+ * Stores the mean and 99th percentile latency in @mean_us and @p99_us.
+ */
+static void bench_latency(int lockstep, osQueue result_queue, int iterations,
+                          double *mean_us, double *p99_us)
+{
+    struct timespec start, end;
+    double *latency = (double *)malloc(sizeof(double)*iterations);
+    double total = 0;
+    int i, result;
+
+    for(i=0; i<iterations; i++)
+    {
+        cmd_t *cmd = cmd_get_str("reset_wdt");
+        cmd_set_callback(cmd, cmd_callback_queue, result_queue);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        bench_send(&cmd, 1, lockstep);
+        osQueueReceive(result_queue, &result, portMAX_DELAY);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        latency[i] = bench_elapsed_ns(&start, &end)/1e3;
+        total += latency[i];
+    }
+
+    qsort(latency, (size_t)iterations, sizeof(double), bench_cmp_double);
+    *mean_us = total/iterations;
+    *p99_us = latency[(int)(iterations*0.99)];
+    free(latency);
+}
+
+/**
+ * Sends a slow command of other domain before each command of
+ * @bench_latency to measure the head of line blocking. Returns the mean
+ * latency in microseconds of the fast commands.
+ */
+static double bench_blocked(int lockstep, osQueue result_queue, int iterations, int sleep_ms)
+{
+    struct timespec start, end;
+    osQueue slow_queue = osQueueCreate(1, sizeof(int));
+    double total = 0;
+    int i, result;
+
+    for(i=0; i<iterations; i++)
+    {
+        cmd_t *slow = cmd_get_str("bench_sleep_com");
+        cmd_add_params_var(slow, sleep_ms);
+        cmd_set_callback(slow, cmd_callback_queue, slow_queue);
+        bench_send(&slow, 1, lockstep);
+
+        cmd_t *cmd = cmd_get_str("reset_wdt");
+        cmd_set_callback(cmd, cmd_callback_queue, result_queue);
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        bench_send(&cmd, 1, lockstep);
+        osQueueReceive(result_queue, &result, portMAX_DELAY);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        total += bench_elapsed_ns(&start, &end)/1e3;
+
+        osQueueReceive(slow_queue, &result, portMAX_DELAY);
+    }
+
+    return total/iterations;
+}
+
+/**
+ * Sends bursts of @burst commands and returns the throughput in
+ * commands per second, counting the results delivered to the sender
+ */
+static double bench_burst(int lockstep, osQueue result_queue, int iterations, int burst)
+{
+    struct timespec start, end;
+    cmd_t *cmds[burst];
+    int sent, i, result;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(sent=0; sent<iterations; sent+=burst)
+    {
+        for(i=0; i<burst; i++)
+        {
+            cmds[i] = cmd_get_str("reset_wdt");
+            cmd_set_callback(cmds[i], cmd_callback_queue, result_queue);
+        }
+        bench_send(cmds, burst, lockstep);
+        for(i=0; i<burst; i++)
+            osQueueReceive(result_queue, &result, portMAX_DELAY);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return sent/(bench_elapsed_ns(&start, &end)/1e9);
+}
+
+/**
+ * Registers the benchmark commands and starts the lockstep and the current
+ * dispatcher and executers, only once
+ */
+static void bench_exe_init(void)
+{
+    static int initialized = 0;
+    static os_thread threads[3+SCH_CMD_EXE_WORKERS];
+    char exe_name[16];
+    int i;
+
+    if(initialized)
+        return;
+    initialized = 1;
+
+    // The repository is sealed after init, unseal to add the slow commands
+    cmd_repo_seal(0);
+    cmd_add("bench_sleep_obc", bench_sleep, "%d", 1, CMD_DOMAIN_OBC);
+    cmd_add("bench_sleep_com", bench_sleep, "%d", 1, CMD_DOMAIN_COM);
+    cmd_add("bench_sleep_eps", bench_sleep, "%d", 1, CMD_DOMAIN_EPS);
+    cmd_add("bench_sleep_storage", bench_sleep, "%d", 1, CMD_DOMAIN_STORAGE);
+    cmd_repo_seal(1);
+
+    // Former lockstep dispatcher and executer
+    lockstep_dispatcher_queue = osQueueCreate(SCH_CMD_MAX_BATCH, sizeof(cmd_t *));
+    lockstep_cmd_queue = osQueueCreate(1, sizeof(cmd_t *));
+    lockstep_stat_queue = osQueueCreate(1, sizeof(int));
+    osCreateTask(bench_lockstep_dispatcher, "lockstep_dis", SCH_TASK_DIS_STACK, NULL, 3, &threads[0]);
+    osCreateTask(bench_lockstep_executer, "lockstep_exe", SCH_TASK_EXE_STACK, NULL, 4, &threads[1]);
+
+    // Current dispatcher and executers, lanes are created by cmd_repo_init
+    executer_cmd_queue = osQueueCreate(SCH_CMD_EXE_WORKERS, sizeof(cmd_t *));
+    osCreateTask(taskDispatcher, "invoker", SCH_TASK_DIS_STACK, NULL, 3, &threads[2]);
+    for(i=0; i<SCH_CMD_EXE_WORKERS; i++)
+    {
+        snprintf(exe_name, sizeof(exe_name), "receiver%d", i);
+        osCreateTask(taskExecuter, exe_name, SCH_TASK_EXE_STACK, NULL, 4, &threads[3+i]);
+    }
+}
+
+void bench_exe_handoff(int iterations, int burst)
+{
+    osQueue result_queue;
+    double mean_us, p99_us, throughput, blocked_us;
+
+    bench_exe_init();
+
+    // Results are sent without blocking, so the queue fits a whole burst
+    result_queue = osQueueCreate(burst, sizeof(int));
+
+    LOGI(tag, "---- Command handoff benchmark (%d commands, burst %d) ----", iterations, burst);
+    printf("%10s %12s %12s %14s %18s\n", "executer", "mean (us)", "p99 (us)",
+           "burst (c/s)", "behind 10 ms (us)");
+
+    bench_latency(1, result_queue, iterations, &mean_us, &p99_us);
+    throughput = bench_burst(1, result_queue, iterations, burst);
+    blocked_us = bench_blocked(1, result_queue, 100, 10);
+    printf("%10s %12.1f %12.1f %14.0f %18.1f\n", "lockstep", mean_us, p99_us, throughput, blocked_us);
+
+    bench_latency(0, result_queue, iterations, &mean_us, &p99_us);
+    throughput = bench_burst(0, result_queue, iterations, burst);
+    blocked_us = bench_blocked(0, result_queue, 100, 10);
+    printf("%10s %12.1f %12.1f %14.0f %18.1f\n", "async", mean_us, p99_us, throughput, blocked_us);
+}
+
+/**
+ * Sends a burst of @n_hk housekeeping like commands of 1 ms, of all the
+ * domains, followed by a watchdog command. Returns the mean latency of the
+ * watchdog command in microseconds and its max. latency in @max_us.
+ *
+ * @param lockstep Int. 1 to use the former lockstep dispatcher, with one FIFO
+ * @param wdt_lane cmd_lane_t. Lane of the watchdog command
+ */
+static double bench_wdt_latency(int lockstep, cmd_lane_t wdt_lane, int iterations,
+                                int n_hk, double *max_us)
+{
+    const char *sleep_cmds[4] = {"bench_sleep_obc", "bench_sleep_com",
+                                 "bench_sleep_eps", "bench_sleep_storage"};
+    struct timespec start, end;
+    osQueue hk_queue = osQueueCreate(n_hk, sizeof(int));
+    osQueue wdt_queue = osQueueCreate(1, sizeof(int));
+    cmd_t *hk_cmds[n_hk];
+    double total = 0, latency;
+    int i, j, result;
+
+    *max_us = 0;
+    for(i=0; i<iterations; i++)
+    {
+        for(j=0; j<n_hk; j++)
+        {
+            hk_cmds[j] = cmd_get_str((char *)sleep_cmds[j % 4]);
+            cmd_add_params_var(hk_cmds[j], 1);
+            cmd_set_callback(hk_cmds[j], cmd_callback_queue, hk_queue);
+        }
+
+        cmd_t *wdt = cmd_get_str("reset_wdt");
+        cmd_set_callback(wdt, cmd_callback_queue, wdt_queue);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if(lockstep)
+        {
+            for(j=0; j<n_hk; j++)
+                bench_send(&hk_cmds[j], 1, 1);
+            bench_send(&wdt, 1, 1);
+        }
+        else
+        {
+            cmd_send_lane_batch(hk_cmds, n_hk, CMD_LANE_HK);
+            cmd_send_lane(wdt, wdt_lane);
+        }
+        osQueueReceive(wdt_queue, &result, portMAX_DELAY);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        latency = bench_elapsed_ns(&start, &end)/1e3;
+        total += latency;
+        if(latency > *max_us)
+            *max_us = latency;
+
+        for(j=0; j<n_hk; j++)
+            osQueueReceive(hk_queue, &result, portMAX_DELAY);
+    }
+
+    return total/iterations;
+}
+
+void bench_exe_lanes(int iterations, int n_hk)
+{
+    const char *names[CMD_LANE_LAST] = {"critical", "ground", "fp", "hk"};
+    dispatcher_lane_stats_t stats;
+    double mean_us, max_us;
+    int lane;
+
+    bench_exe_init();
+
+    LOGI(tag, "---- Watchdog behind housekeeping benchmark (%d commands of 1 ms) ----", n_hk);
+    printf("%22s %12s %12s\n", "watchdog command", "mean (us)", "max (us)");
+
+    mean_us = bench_wdt_latency(1, CMD_LANE_HK, iterations, n_hk, &max_us);
+    printf("%22s %12.1f %12.1f\n", "lockstep, one fifo", mean_us, max_us);
+
+    mean_us = bench_wdt_latency(0, CMD_LANE_HK, iterations, n_hk, &max_us);
+    printf("%22s %12.1f %12.1f\n", "async, hk lane", mean_us, max_us);
+
+    dispatcher_reset_lane_stats();
+    mean_us = bench_wdt_latency(0, CMD_LANE_CRITICAL, iterations, n_hk, &max_us);
+    printf("%22s %12.1f %12.1f\n", "async, critical lane", mean_us, max_us);
+
+    printf("%10s %8s %10s %10s\n", "lane", "count", "mean (us)", "max (us)");
+    for(lane=0; lane<CMD_LANE_LAST; lane++)
+    {
+        dispatcher_get_lane_stats(lane, &stats);
+        printf("%10s %8u %10.1f %10u\n", names[lane], (unsigned int)stats.count,
+               stats.count ? (double)stats.total_us/stats.count : 0.0,
+               (unsigned int)stats.max_us);
+    }
+}
@@ -0,0 +1,149 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchQueue.h"
+
+static const char *tag = "benchQueue";
+
+#define BENCH_QUEUE_LENGTH 16
+
+/**
+ * Queue under test
+ */
+typedef enum bench_queue_type{
+    BENCH_QUEUE_PTHREAD = 0,    ///< Former osQueue implementation. Used as reference
+    BENCH_QUEUE_RING,           ///< Ring queue, multiple producers and consumers
+    BENCH_QUEUE_RING_SPSC,      ///< Ring queue, single producer and consumer
+} bench_queue_type_t;
+
+/**
+ * Queue benchmark parameters
+ */
+typedef struct bench_queue_arg{
+    bench_queue_type_t type;    ///< Queue implementation
+    void *queue;                ///< Queue under test
+    int items;                  ///< Number of items sent by each producer
+} bench_queue_arg_t;
+
+/**
+ * Monotonic time stamp in nanoseconds
+ */
+static uint64_t bench_now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec*1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static int bench_queue_send(bench_queue_arg_t *arg, uint64_t *value)
+{
+    if(arg->type == BENCH_QUEUE_PTHREAD)
+        return os_pthread_queue_send(arg->queue, value, portMAX_DELAY);
+    return os_ring_queue_send(arg->queue, value, portMAX_DELAY);
+}
+
+static int bench_queue_receive(bench_queue_arg_t *arg, uint64_t *value)
+{
+    if(arg->type == BENCH_QUEUE_PTHREAD)
+        return os_pthread_queue_receive(arg->queue, value, portMAX_DELAY);
+    return os_ring_queue_receive(arg->queue, value, portMAX_DELAY);
+}
+
+/**
+ * Producer thread, sends the current time stamp @items times
+ */
+static void *bench_queue_producer(void *param)
+{
+    bench_queue_arg_t *arg = (bench_queue_arg_t *)param;
+    uint64_t now;
+    int i;
+    for(i=0; i<arg->items; i++)
+    {
+        now = bench_now_ns();
+        bench_queue_send(arg, &now);
+    }
+    return NULL;
+}
+
+static int bench_cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+/**
+ * Runs @n_producers producer threads, receives all the items in this thread
+ * and prints the throughput and p99 latency
+ */
+static void bench_queue_run(bench_queue_type_t type, int n_producers, int items)
+{
+    pthread_t threads[n_producers];
+    bench_queue_arg_t arg;
+    int total = n_producers*items;
+    uint64_t *latency = (uint64_t *)malloc(sizeof(uint64_t)*total);
+    uint64_t start, end, value;
+    int i;
+
+    arg.type = type;
+    arg.items = items;
+    if(type == BENCH_QUEUE_PTHREAD)
+        arg.queue = os_pthread_queue_create(BENCH_QUEUE_LENGTH, sizeof(uint64_t));
+    else
+        arg.queue = os_ring_queue_create(BENCH_QUEUE_LENGTH, sizeof(uint64_t),
+                                         type == BENCH_QUEUE_RING_SPSC);
+
+    start = bench_now_ns();
+    for(i=0; i<n_producers; i++)
+        pthread_create(&threads[i], NULL, bench_queue_producer, &arg);
+    for(i=0; i<total; i++)
+    {
+        bench_queue_receive(&arg, &value);
+        latency[i] = bench_now_ns() - value;
+    }
+    end = bench_now_ns();
+    for(i=0; i<n_producers; i++)
+        pthread_join(threads[i], NULL);
+
+    qsort(latency, total, sizeof(uint64_t), bench_cmp_u64);
+    printf("%10d %12s %14.0f %12.1f\n", n_producers,
+           type == BENCH_QUEUE_PTHREAD ? "pthread" : type == BENCH_QUEUE_RING ? "ring" : "ring spsc",
+           total/((end - start)/1e9), latency[(total*99)/100]/1e3);
+
+    // Queues are never deleted in the system, they are not freed for the
+    // pthread queue either
+    if(type != BENCH_QUEUE_PTHREAD)
+        free(arg.queue);
+    free(latency);
+}
+
+void bench_os_queue(int max_producers, int items)
+{
+    int n_producers;
+
+    LOGI(tag, "---- Queue benchmark (%d items per producer, length %d) ----", items, BENCH_QUEUE_LENGTH);
+    printf("%10s %12s %14s %12s\n", "producers", "queue", "ops (op/s)", "p99 (us)");
+
+    for(n_producers=1; n_producers<=max_producers; n_producers*=2)
+    {
+        bench_queue_run(BENCH_QUEUE_PTHREAD, n_producers, items);
+        bench_queue_run(BENCH_QUEUE_RING, n_producers, items);
+        if(n_producers == 1)
+            bench_queue_run(BENCH_QUEUE_RING_SPSC, n_producers, items);
+    }
+}
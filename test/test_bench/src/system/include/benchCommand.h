@@ -0,0 +1,43 @@
+/**
+ * @file  benchCommand.h
+ * @author Carlos Gonzalez C - carlgonz@uchile.cl
+ * @date 2018
+ * @copyright GNU GPL v3
+ *
+ * Benchmarks for the command repository
+ */
+
+#ifndef BENCH_COMMAND_H
+#define BENCH_COMMAND_H
+
+#include <time.h>
+#include <pthread.h>
+
+#include "config.h"
+#include "globals.h"
+#include "utils.h"
+
+#include "repoCommand.h"
+
+/**
+ * Measures the cost of cmd_get_str while the command repository grows up to
+ * SCH_CMD_MAX_ENTRIES. The lookup cost is compared against a linear search of
+ * the command list (the former cmd_get_str implementation).
+ *
+ * @note increase SCH_CMD_MAX_ENTRIES to test hundreds of commands
+ *
+ * @param iterations Int. Number of lookups per measurement
+ */
+void bench_cmd_lookup(int iterations);
+
+/**
+ * Multi-threaded lookup stress test. Runs 1, 2, 4 .. @max_threads threads
+ * looking up commands by name at the same time, with the repository unsealed
+ * (lookups take repo_cmd_sem) and sealed (lookups without lock).
+ *
+ * @param max_threads Int. Max number of concurrent threads
+ * @param lookups Int. Number of lookups per thread
+ */
+void bench_cmd_contention(int max_threads, int lookups);
+
+#endif //BENCH_COMMAND_H
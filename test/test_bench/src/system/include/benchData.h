@@ -0,0 +1,63 @@
+/**
+ * @file  benchData.h
+ * @author Carlos Gonzalez C - carlgonz@uchile.cl
+ * @date 2018
+ * @copyright GNU GPL v3
+ *
+ * Benchmarks for the data repository
+ */
+
+#ifndef BENCH_DATA_H
+#define BENCH_DATA_H
+
+#include <time.h>
+
+#include "config.h"
+#include "globals.h"
+#include "utils.h"
+
+#include "repoData.h"
+
+/**
+ * Measures the cost of dat_get_system_var against the former implementation,
+ * that reads the variable and its copies from the storage in every call
+ * (storage_repo_get_value_idx and vote, SCH_STORAGE_MODE 1 only). With
+ * SCH_STORAGE_CACHE 1 the reads are served from the RAM copy.
+ *
+ * @param reads Int. Number of reads per measurement
+ */
+void bench_dat_get(int reads);
+
+/**
+ * Measures the cost of dat_set_system_var for each persistence tier, writing
+ * @vars variables of the tier in turns like the periodic tasks do, and the
+ * values and commits sent to the storage. Compares the checkpoint tier with
+ * the former implementation that commits every copy to the storage on its
+ * own (SCH_STORAGE_MODE 1 only).
+ *
+ * @param writes Int. Number of writes per measurement
+ * @param vars Int. Max. number of different variables written
+ */
+void bench_dat_set(int writes, int vars);
+
+/**
+ * Measures the latency of the TM status generation (dat_status_to_struct),
+ * that reads all the variables at once, against reading the variables one by
+ * one with dat_get_system_var (one lock and, without the storage cache, one
+ * storage read per copy for each variable).
+ *
+ * @param reps Int. Number of status structures generated per measurement
+ */
+void bench_tm_status(int reps);
+
+/**
+ * Measures the throughput (op/s) of each storage call type (variables get and
+ * set, flight plan set, next and get) using the prepared statements of the
+ * storage driver, against the former implementation that builds the SQL text
+ * and prepares the statement in every call (SCH_STORAGE_MODE 1 only).
+ *
+ * @param ops Int. Number of calls per call type
+ */
+void bench_storage(int ops);
+
+#endif //BENCH_DATA_H
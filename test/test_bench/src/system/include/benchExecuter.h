@@ -0,0 +1,55 @@
+/**
+ * @file  benchExecuter.h
+ * @author Carlos Gonzalez C - carlgonz@uchile.cl
+ * @date 2018
+ * @copyright GNU GPL v3
+ *
+ * Benchmarks for the dispatcher and executer tasks
+ */
+
+#ifndef BENCH_EXECUTER_H
+#define BENCH_EXECUTER_H
+
+#include <time.h>
+#include <pthread.h>
+
+#include "config.h"
+#include "globals.h"
+#include "utils.h"
+
+#include "osThread.h"
+#include "osQueue.h"
+#include "osDelay.h"
+#include "repoCommand.h"
+#include "taskDispatcher.h"
+#include "taskExecuter.h"
+
+/**
+ * Measures the command handoff latency, from cmd_send until the command result
+ * is delivered to the sender, and the throughput of bursts of commands. The
+ * current dispatcher and executers (asynchronous completion) are compared
+ * against the former lockstep implementation, where the dispatcher waited the
+ * result of every command in executer_stat_queue.
+ *
+ * @note Build with LOG_LEVEL < LOG_LVL_INFO, otherwise the executer logs
+ * dominate the measurement
+ *
+ * @param iterations Int. Number of commands to measure
+ * @param burst Int. Number of commands sent at once in the throughput test
+ */
+void bench_exe_handoff(int iterations, int burst);
+
+/**
+ * Measures the latency of a watchdog command sent just after a burst of
+ * housekeeping commands, with the former lockstep dispatcher (one FIFO queue)
+ * and with the dispatcher lanes, sending the watchdog command to the
+ * housekeeping lane or to the critical lane. Prints the lanes queueing
+ * latency statistics (@see dispatcher_get_lane_stats).
+ *
+ * @param iterations Int. Number of watchdog commands to measure
+ * @param n_hk Int. Number of housekeeping commands sent before each watchdog
+ * command
+ */
+void bench_exe_lanes(int iterations, int n_hk);
+
+#endif //BENCH_EXECUTER_H
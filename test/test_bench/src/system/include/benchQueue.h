@@ -0,0 +1,35 @@
+/**
+ * @file  benchQueue.h
+ * @author Carlos Gonzalez C - carlgonz@uchile.cl
+ * @date 2018
+ * @copyright GNU GPL v3
+ *
+ * Benchmarks for the Linux osQueue implementation
+ */
+
+#ifndef BENCH_QUEUE_H
+#define BENCH_QUEUE_H
+
+#include <time.h>
+#include <pthread.h>
+
+#include "config.h"
+#include "globals.h"
+#include "utils.h"
+
+#include "pthread_queue.h"
+#include "ring_queue.h"
+
+/**
+ * Measures the throughput and the p99 send to receive latency of a queue with
+ * 1, 2, 4... @max_producers sender tasks and one receiver task. The former
+ * osQueue implementation (mutex and condition variables) is compared against
+ * the lock-free ring queue, for multiple producers and, with one producer, for
+ * a single producer single consumer queue.
+ *
+ * @param max_producers Int. Max. number of sender tasks
+ * @param items Int. Number of items sent by each sender task
+ */
+void bench_os_queue(int max_producers, int items);
+
+#endif //BENCH_QUEUE_H
@@ -0,0 +1,72 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "init.h"
+#include "benchCommand.h"
+#include "benchData.h"
+#include "benchExecuter.h"
+#include "benchQueue.h"
+
+const char *tag = "main";
+
+/**
+ * Runs the benchmarks selected by name in the command line, or all of them if
+ * no name is given.
+ *
+ * @code
+ *      ./SUCHAI_Flight_Software_Bench              # Run all benchmarks
+ *      ./SUCHAI_Flight_Software_Bench cmd_lookup   # Run one benchmark
+ * @endcode
+ */
+int main(int argc, char **argv)
+{
+    char *bench = argc > 1 ? argv[1] : NULL;
+
+    /* On reset */
+    on_reset();
+
+    /* Init software subsystems */
+    log_init();      // Logging system
+    cmd_repo_init(); // Command repository initialization
+    dat_repo_init(); // Update status repository
+
+    if(bench == NULL || strcmp(bench, "cmd_contention") == 0)
+        bench_cmd_contention(8, 200000);
+    if(bench == NULL || strcmp(bench, "os_queue") == 0)
+        bench_os_queue(8, 100000);
+    if(bench == NULL || strcmp(bench, "exe_handoff") == 0)
+        bench_exe_handoff(20000, 16);
+    if(bench == NULL || strcmp(bench, "exe_lanes") == 0)
+        bench_exe_lanes(50, 24);
+    if(bench == NULL || strcmp(bench, "dat_get") == 0)
+        bench_dat_get(20000);
+    if(bench == NULL || strcmp(bench, "dat_set") == 0)
+        bench_dat_set(2000, 8);
+    if(bench == NULL || strcmp(bench, "tm_status") == 0)
+        bench_tm_status(2000);
+    if(bench == NULL || strcmp(bench, "storage") == 0)
+        bench_storage(2000);
+    // Run last, fills the command repository
+    if(bench == NULL || strcmp(bench, "cmd_lookup") == 0)
+        bench_cmd_lookup(100000);
+
+    cmd_repo_close();
+    dat_repo_close();
+    return 0;
+}
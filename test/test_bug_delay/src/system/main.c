@@ -41,13 +41,7 @@ int main(void)
     cmd_repo_init(); // Command repository initialization
     dat_repo_init(); // Update status repository
 
-    /* Initializing shared Queues */
-    dispatcher_queue = osQueueCreate(10,sizeof(cmd_t *));
-    if(dispatcher_queue == 0)
-        LOGE(tag, "Error creating dispatcher queue");
-    executer_stat_queue = osQueueCreate(1,sizeof(int));
-    if(executer_stat_queue == 0)
-        LOGE(tag, "Error creating executer stat queue");
+    /* Initializing shared Queues (dispatcher lanes are created by cmd_repo_init) */
     executer_cmd_queue = osQueueCreate(1,sizeof(cmd_t *));
     if(executer_cmd_queue == 0)
         LOGE(tag, "Error creating executer cmd queue");
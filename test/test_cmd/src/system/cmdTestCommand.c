@@ -14,42 +14,36 @@ static const char *tag = "cmdTest";
 void cmd_test_init(void)
 {
 
-    cmd_add("test_str_int", test_cmd_str_int, "%s %i", 2);
-    cmd_add("test_double_int", test_cmd_double_int, "%f %f %i %i", 4);
-    cmd_add("test_str_double_int", test_cmd_str_double_int, "%s %f %s %f %i", 5);
+    cmd_add("test_str_int", test_cmd_str_int, "%s %i", 2, CMD_DOMAIN_OBC);
+    cmd_add("test_double_int", test_cmd_double_int, "%f %f %i %i", 4, CMD_DOMAIN_OBC);
+    cmd_add("test_str_double_int", test_cmd_str_double_int, "%s %f %s %f %i", 5, CMD_DOMAIN_OBC);
 
 }
 
-int test_cmd_str_int(char *fmt, char *params, int nparams)
+int test_cmd_str_int(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    char msg[10];
-    int valor = 0;
-
-    errno = 0;
-    assertf(sscanf(params,fmt, msg, &valor) == nparams, tag, "The format of parameters are: %s and parameters used are: %s",fmt, params);
-    assertf(errno == 0, tag, "The format of parameters are: %s and parameters used are: %s",fmt, params);
+    assertf(args->argc == nparams, tag, "The format of parameters are: %s and parameters parsed are: %d",fmt, args->argc);
+    char *msg = args->argv[0].s;
+    int valor = args->argv[1].i;
     LOGI(tag, "%s: %s_%i","con_str_int", msg, valor);
     return CMD_OK;
 }
 
-int test_cmd_double_int(char *fmt, char *params, int nparams)
+int test_cmd_double_int(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    float v1 = 0, v2 = 0;
-    int v3 = 0,v4 = 0;
-
-    assertf(sscanf(params,fmt, &v1, &v2, &v3, &v4) == nparams, tag, "The format of parameters are: %s and parameters used are: %s",fmt, params);
+    assertf(args->argc == nparams, tag, "The format of parameters are: %s and parameters parsed are: %d",fmt, args->argc);
+    float v1 = args->argv[0].f, v2 = args->argv[1].f;
+    int v3 = args->argv[2].i, v4 = args->argv[3].i;
     LOGI(tag, "%s: %f_%f_%i_%i", "con_double_int",v1,v2,v3,v4);
     return CMD_OK;
 }
 
-int test_cmd_str_double_int(char *fmt, char *params, int nparams)
+int test_cmd_str_double_int(char *fmt, char *params, int nparams, cmd_args_t *args)
 {
-    char v1[10];
-    char v3[10];
-    float v2 = 0, v4 = 0;
-    int v5 = 0;
-
-    assertf( sscanf(params,fmt, v1, &v2, v3, &v4, &v5) == nparams, tag, "The format of parameters are: %s and parameters used are: %s",fmt, params);
+    assertf(args->argc == nparams, tag, "The format of parameters are: %s and parameters parsed are: %d",fmt, args->argc);
+    char *v1 = args->argv[0].s, *v3 = args->argv[2].s;
+    float v2 = args->argv[1].f, v4 = args->argv[3].f;
+    int v5 = args->argv[4].i;
     LOGI(tag, "%s: %s_%f_%s_%f_%i","str_double_int",v1,v2,v3,v4,v5);
     return CMD_OK;
 }
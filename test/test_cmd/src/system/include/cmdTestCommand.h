@@ -33,9 +33,10 @@ void cmd_test_init(void);
  * @param fparams Str. Parameters format "%s %i"
  * @param params Str. Parameters as string "abc 123"
  * @param nparam Int. Number of parameters 2
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int test_cmd_str_int(char *fmt, char *params, int nparams);
+int test_cmd_str_int(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Test commands with double and integers
@@ -43,9 +44,10 @@ int test_cmd_str_int(char *fmt, char *params, int nparams);
  * @param fparams Str. Parameters format "%f %f %i %i"
  * @param params Str. Parameters as string "1.2 3.4 5 6"
  * @param nparam Int. Number of parameters 4
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int test_cmd_double_int(char *fmt, char *params, int nparams);
+int test_cmd_double_int(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 /**
  * Test commands with string, double and integers
@@ -53,9 +55,10 @@ int test_cmd_double_int(char *fmt, char *params, int nparams);
  * @param fparams Str. Parameters format "%s %f %s %f %i"
  * @param params Str. Parameters as string "abc 12.3 cde 4.56 789"
  * @param nparam Int. Number of parameters 5
+ * @param args cmd_args_t *. Parsed parameters
  * @return  CMD_OK if executed correctly or CMD_FAIL in case of errors
  */
-int test_cmd_str_double_int(char *fmt, char *params, int nparams);
+int test_cmd_str_double_int(char *fmt, char *params, int nparams, cmd_args_t *args);
 
 
 #endif //CMD_TEST_COMMAND_H
@@ -39,10 +39,8 @@ int main(void)
 
     LOGI(tag, "Creating tasks...");
 
-    /* Initializing shared Queues */
-    dispatcher_queue = osQueueCreate(25,sizeof(cmd_t *));
+    /* Initializing shared Queues (dispatcher lanes are created by cmd_repo_init) */
     executer_cmd_queue = osQueueCreate(1,sizeof(cmd_t *));
-    executer_stat_queue = osQueueCreate(1,sizeof(int));
 
     int n_threads = 3;
     os_thread threads_id[n_threads];
@@ -1,15 +1,29 @@
 #ifndef TEST_H
 #define TEST_H
 
+#include <time.h>
+
 #include "config.h"
 #include "globals.h"
 
 #include "osQueue.h"
 #include "osDelay.h"
+#include "osSemphr.h"
 
 #include "repoCommand.h"
 
+/**
+ * Registers the load test commands, one per resource domain. Each command
+ * simulates a slow operation, ex. waiting a reply from a subsystem, sleeping
+ * the number of milliseconds received as parameter.
+ */
+void load_cmd_init(void);
+
+/**
+ * Load test task. Sends bursts of commands spread over all the domains and
+ * bursts of commands of a single domain, and reports the throughput. The
+ * number of executer tasks is received as parameter (int *).
+ */
 void taskTest(void *param);
 
 #endif
-
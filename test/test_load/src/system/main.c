@@ -22,17 +22,30 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include "main.h"
+#include "init.h"
+#include "osThread.h"
+#include "osScheduler.h"
+#include "taskDispatcher.h"
+#include "taskExecuter.h"
 #include "taskTest.h"
 
 const char *tag = "main";
 
-#ifdef ESP32
-void app_main()
-#else
-int main(void)
-#endif
+/**
+ * Commands load benchmark. Sends commands of several resource domains and
+ * measures the throughput of the executer.
+ *
+ * @code
+ *      ./SUCHAI_Flight_Software_Test       # Use SCH_CMD_EXE_WORKERS executers
+ *      ./SUCHAI_Flight_Software_Test 1     # Use one executer, as reference
+ * @endcode
+ */
+int main(int argc, char **argv)
 {
+    int n_workers = argc > 1 ? atoi(argv[1]) : SCH_CMD_EXE_WORKERS;
+    if(n_workers < 1)
+        n_workers = 1;
+
     /* On reset */
     on_reset();
 
@@ -40,73 +53,25 @@ int main(void)
     log_init();      // Logging system
     cmd_repo_init(); // Command repository initialization
     dat_repo_init(); // Update status repository
+    load_cmd_init(); // Load test commands
 
-    /* Initializing shared Queues */
-    dispatcher_queue = osQueueCreate(10,sizeof(cmd_t *));
-    if(dispatcher_queue == 0)
-        LOGE(tag, "Error creating dispatcher queue");
-    executer_stat_queue = osQueueCreate(1,sizeof(int));
-    if(executer_stat_queue == 0)
-        LOGE(tag, "Error creating executer stat queue");
-    executer_cmd_queue = osQueueCreate(1,sizeof(cmd_t *));
+    /* Initializing shared Queues (dispatcher lanes are created by cmd_repo_init) */
+    executer_cmd_queue = osQueueCreate(n_workers,sizeof(cmd_t *));
     if(executer_cmd_queue == 0)
         LOGE(tag, "Error creating executer cmd queue");
 
-    int n_threads = 4;
+    int n_threads = 2 + n_workers;
     os_thread threads_id[n_threads];
 
-    LOGI(tag, "Creating basic tasks...");
+    LOGI(tag, "Creating basic tasks (%d executers)...", n_workers);
     /* Crating system task (the others are created inside taskDeployment) */
     osCreateTask(taskDispatcher,"dispatcher", 2*configMINIMAL_STACK_SIZE,NULL,3, &threads_id[0]);
-    osCreateTask(taskExecuter, "executer", 5*configMINIMAL_STACK_SIZE, NULL, 4, &threads_id[1]);
-
-    osCreateTask(taskTest, "test1", 2*configMINIMAL_STACK_SIZE, "TEST 1", 2, &threads_id[2]);
-    osCreateTask(taskTest, "test2", 2*configMINIMAL_STACK_SIZE, "TEST 2", 2, &threads_id[2]);
+    osCreateTask(taskTest, "test", 2*configMINIMAL_STACK_SIZE, &n_workers, 2, &threads_id[1]);
+    int i;
+    for(i=0; i<n_workers; i++)
+        osCreateTask(taskExecuter, "executer", 5*configMINIMAL_STACK_SIZE, NULL, 4, &threads_id[2+i]);
 
-#ifndef ESP32
     /* Start the scheduler. Should never return */
     osScheduler(threads_id, n_threads);
     return 0;
-#endif
-
-}
-
-#ifdef FREERTOS
-#ifndef NANOMIND
-/**
- * Task idle handle function. Performs operations inside the idle task
- * configUSE_IDLE_HOOK must be set to 1
- */
-void vApplicationIdleHook(void)
-{
-    //Add hook code here
-}
-
-
-/**
- * Task idle handle function. Performs operations inside the idle task
- * configUSE_TICK_HOOK must be set to 1
- */
-void vApplicationTickHook(void)
-{
-#ifdef AVR32
-    LED_Toggle(LED0);
-#endif
-}
-
-/**
- * Stack overflow handle function.
- * configCHECK_FOR_STACK_OVERFLOW must be set to 1 or 2
- *
- * @param pxTask Task handle
- * @param pcTaskName Task name
- */
-void vApplicationStackOverflowHook(xTaskHandle* pxTask, signed char* pcTaskName)
-{
-    printf("[ERROR][-1][%s] Stack overflow!", (char *)pcTaskName);
-
-    /* Stack overflow handle */
-    while(1);
 }
-#endif
-#endif
\ No newline at end of file
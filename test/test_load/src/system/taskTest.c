@@ -1,31 +1,102 @@
 #include "include/taskTest.h"
 
 #define TEST_FAILS 0
+#define LOAD_CMD_DELAY_MS 20    ///< Duration of each load command
 
-//const static char *tag = "taskTest";
+static const char *tag = "taskTest";
+
+static osSemaphore load_sem;
+static int load_done = 0;       ///< Number of load commands executed
+
+static char *load_cmd_names[] = {"load_obc", "load_com", "load_eps", "load_storage"};
+static cmd_domain_t load_cmd_domains[] = {CMD_DOMAIN_OBC, CMD_DOMAIN_COM, CMD_DOMAIN_EPS, CMD_DOMAIN_STORAGE};
+#define LOAD_N_DOMAINS (sizeof(load_cmd_domains)/sizeof(load_cmd_domains[0]))
+
+/**
+ * Load command, sleeps the given milliseconds
+ */
+static int load_cmd(char *fmt, char *params, int nparams, cmd_args_t *args)
+{
+    if(args->argc != nparams)
+        return CMD_FAIL;
+
+    osDelay((uint32_t)args->argv[0].i);
+
+    osSemaphoreTake(&load_sem, portMAX_DELAY);
+    load_done++;
+    osSemaphoreGiven(&load_sem);
+    return CMD_OK;
+}
+
+void load_cmd_init(void)
+{
+    int i;
+    osSemaphoreCreate(&load_sem);
+
+    // The repository is sealed after init, unseal to add new commands
+    cmd_repo_seal(0);
+    for(i=0; i<LOAD_N_DOMAINS; i++)
+        cmd_add(load_cmd_names[i], load_cmd, "%d", 1, load_cmd_domains[i]);
+    cmd_repo_seal(1);
+}
+
+/**
+ * Sends @n_cmds load commands, using @n_domains domains in turns, waits until
+ * all of them are executed and returns the elapsed time in milliseconds.
+ */
+static double load_run(int n_cmds, int n_domains)
+{
+    struct timespec start, end;
+    int i, done;
+
+    osSemaphoreTake(&load_sem, portMAX_DELAY);
+    load_done = 0;
+    osSemaphoreGiven(&load_sem);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i=0; i<n_cmds; i++)
+    {
+        cmd_t *cmd = cmd_get_str(load_cmd_names[i % n_domains]);
+        cmd_add_params_var(cmd, LOAD_CMD_DELAY_MS);
+        cmd_send(cmd);
+    }
+
+    do
+    {
+        osDelay(1);
+        osSemaphoreTake(&load_sem, portMAX_DELAY);
+        done = load_done;
+        osSemaphoreGiven(&load_sem);
+    }
+    while(done < n_cmds);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    return (end.tv_sec - start.tv_sec)*1e3 + (end.tv_nsec - start.tv_nsec)/1e6;
+}
 
 void taskTest(void *param)
 {
-    char *tag = (char *)param;
+    int n_workers = *(int *)param;
     LOGI(tag, "Started");
-    LOGI(tag, "---- Commands load test ----");
+    LOGI(tag, "---- Commands load test (%d executers, %d ms per command) ----", n_workers, LOAD_CMD_DELAY_MS);
+
+    int test;
+    int n_start = 8;
+    int n_end = 64;
+    double all_ms, one_ms;
 
-    int test, curr;
-    int n_start = 5;
-    int n_end = 25;
-    char params[10];
+    printf("%8s %8s %14s %14s %14s %14s\n", "workers", "commands", "domains (ms)",
+           "domains (c/s)", "single (ms)", "single (c/s)");
 
-    for(test = n_start; test < n_end; test++)
+    for(test = n_start; test <= n_end; test *= 2)
     {
         osDelay(100);
-        LOGI(tag, "-- Sending %d commands --", test);
-        for (curr = 0; curr < test; curr++)
-        {
-            cmd_t *cmd = cmd_get_str("test");
-            sprintf(params, "%d", curr);
-            cmd_add_params_str(cmd, params);
-            cmd_send(cmd);
-        }
+        // Commands spread over all the domains can run concurrently, while
+        // commands of a single domain are always serialized
+        all_ms = load_run(test, LOAD_N_DOMAINS);
+        one_ms = load_run(test, 1);
+        printf("%8d %8d %14.1f %14.1f %14.1f %14.1f\n", n_workers, test,
+               all_ms, test/(all_ms/1e3), one_ms, test/(one_ms/1e3));
     }
 
     LOGI(tag, "----Sending final commands ----");
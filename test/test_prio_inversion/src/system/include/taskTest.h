@@ -0,0 +1,21 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <assert.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "config.h"
+#include "utils.h"
+
+#include "osDelay.h"
+#include "osSemphr.h"
+#include "osThread.h"
+
+#define TEST_CPU 0          ///< All the tasks run in the same CPU
+#define TEST_HOLD_MS 50     ///< Time the low priority task holds the mutex
+#define TEST_HOG_MS 200     ///< Time the medium priority task uses the CPU
+
+void taskTest(void *param);
+
+#endif
@@ -0,0 +1,42 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *      Copyright 2018, Camilo Rojas Milla, camrojas@uchile.cl
+ *      Copyright 2018, Tomas Opazo Toro, tomas.opazo.t@gmail.com
+ *      Copyright 2018, Matias Ramirez Martinez, nicoram.mt@gmail.com
+ *      Copyright 2018, Tamara Gutierrez Rojo TGR_93@hotmail.com
+ *      Copyright 2018, Ignacio Ibanez Aliaga, ignacio.ibanez@usach.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "osScheduler.h"
+#include "taskTest.h"
+
+const char *tag = "main";
+
+int main(void)
+{
+    log_init();      // Logging system
+
+    os_thread threads_id[1];
+
+    /* The test task has the highest priority, it creates the others */
+    osCreateTask(taskTest, "test", SCH_TASK_DEF_STACK, NULL, 5, &threads_id[0]);
+
+    /* Start the scheduler. Should never return */
+    osScheduler(threads_id, 1);
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include "include/taskTest.h"
+
+const static char *tag = "taskTest";
+
+static osSemaphore test_sem;
+static volatile uint32_t executer_wait_us;
+
+static uint64_t test_clock_us(clockid_t clock)
+{
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return (uint64_t)now.tv_sec*1000000ULL + (uint64_t)now.tv_nsec/1000;
+}
+
+static uint64_t test_now_us(void)
+{
+    return test_clock_us(CLOCK_MONOTONIC);
+}
+
+/**
+ * Uses @ms milliseconds of CPU time, the time the task is preempted does not
+ * count
+ */
+static void test_spin(uint32_t ms)
+{
+    uint64_t end = test_clock_us(CLOCK_THREAD_CPUTIME_ID) + (uint64_t)ms*1000;
+    while(test_clock_us(CLOCK_THREAD_CPUTIME_ID) < end);
+}
+
+/**
+ * Low priority task holding the mutex, as the housekeeping during a slow
+ * SQLite write holding repo_data_sem
+ */
+static void taskLow(void *param)
+{
+    osSemaphoreTake(&test_sem, portMAX_DELAY);
+    test_spin(TEST_HOLD_MS);
+    osSemaphoreGiven(&test_sem);
+}
+
+/**
+ * Medium priority task that only uses the CPU
+ */
+static void taskMedium(void *param)
+{
+    test_spin(TEST_HOG_MS);
+}
+
+/**
+ * High priority task, as an executer reading a status variable
+ */
+static void taskHigh(void *param)
+{
+    uint64_t start = test_now_us();
+    osSemaphoreTake(&test_sem, portMAX_DELAY);
+    executer_wait_us = (uint32_t)(test_now_us() - start);
+    osSemaphoreGiven(&test_sem);
+}
+
+/**
+ * Low takes the mutex, then medium starts using the CPU and high waits for
+ * the mutex, all in the same CPU
+ *
+ * @return Time the high priority task waited for the mutex (us)
+ */
+static uint32_t test_scenario(int protocol)
+{
+    os_thread low, medium, high;
+    osSemaphoreStats stats;
+
+    executer_wait_us = 0;
+    osSemaphoreCreateProtocol(&test_sem, protocol, 0);
+
+    osCreateTask(taskLow, "low", SCH_TASK_DEF_STACK, NULL, 1, &low);
+    osTaskSetAffinity(&low, TEST_CPU);
+    osDelay(TEST_HOLD_MS/5);
+
+    osCreateTask(taskMedium, "medium", SCH_TASK_DEF_STACK, NULL, 2, &medium);
+    osTaskSetAffinity(&medium, TEST_CPU);
+    osCreateTask(taskHigh, "executer", SCH_TASK_DEF_STACK, NULL, 4, &high);
+    osTaskSetAffinity(&high, TEST_CPU);
+
+    // Wait until all the tasks end
+    osDelay(TEST_HOLD_MS + TEST_HOG_MS + 100);
+
+    osSemaphoreGetStats(&test_sem, &stats);
+    LOGI(tag, "Protocol %d: executer waited %u us (takes %u, contended %u, max. wait %u us)",
+         protocol, (unsigned int)executer_wait_us, (unsigned int)stats.takes,
+         (unsigned int)stats.contended, (unsigned int)stats.wait_max_us);
+    return executer_wait_us;
+}
+
+/**
+ * Priority inversion scenario, with a plain mutex and with a priority
+ * inheritance mutex. Without priority inheritance the executer waits until
+ * the medium priority task ends, with priority inheritance it only waits for
+ * the low priority task to release the mutex.
+ */
+void taskTest(void *param)
+{
+    struct sched_param sched;
+    int policy;
+
+    // The scenario requires SCHED_FIFO priorities
+    pthread_getschedparam(pthread_self(), &policy, &sched);
+    if(policy != SCHED_FIFO)
+    {
+        LOGW(tag, "Test skipped, real time priorities not available (try as root)");
+        exit(0);
+    }
+    os_thread self = pthread_self();
+    osTaskSetAffinity(&self, TEST_CPU);
+
+    uint32_t plain_us = test_scenario(OS_SEMAPHORE_PLAIN);
+    uint32_t inherit_us = test_scenario(OS_SEMAPHORE_INHERIT);
+
+    LOGI(tag, "Executer latency without PI %u us, with PI %u us",
+         (unsigned int)plain_us, (unsigned int)inherit_us);
+    assert(plain_us >= TEST_HOG_MS*1000);
+    assert(inherit_us < TEST_HOG_MS*1000);
+    exit(0);
+}
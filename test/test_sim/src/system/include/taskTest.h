@@ -0,0 +1,23 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <assert.h>
+#include <string.h>
+
+#include "config.h"
+#include "globals.h"
+
+#include "osQueue.h"
+#include "osDelay.h"
+#include "osSim.h"
+#include "osThread.h"
+
+#include "repoCommand.h"
+#include "repoData.h"
+
+#define TEST_SIM_START 1514764800       ///< Scenario start, 2018-01-01 00:00:00 UTC
+#define TEST_SIM_DAYS 3                 ///< Scenario length in days
+
+void taskTest(void *param);
+
+#endif
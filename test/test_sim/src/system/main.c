@@ -0,0 +1,120 @@
+/*                                 SUCHAI
+ *                      NANOSATELLITE FLIGHT SOFTWARE
+ *
+ *      Copyright 2018, Carlos Gonzalez Cortes, carlgonz@uchile.cl
+ *      Copyright 2018, Camilo Rojas Milla, camrojas@uchile.cl
+ *      Copyright 2018, Tomas Opazo Toro, tomas.opazo.t@gmail.com
+ *      Copyright 2018, Matias Ramirez Martinez, nicoram.mt@gmail.com
+ *      Copyright 2018, Tamara Gutierrez Rojo TGR_93@hotmail.com
+ *      Copyright 2018, Ignacio Ibanez Aliaga, ignacio.ibanez@usach.cl
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "main.h"
+#include "taskTest.h"
+
+const char *tag = "main";
+
+#ifdef ESP32
+void app_main()
+#else
+int main(void)
+#endif
+{
+    /* On reset */
+    on_reset();
+
+    /* Init software subsystems */
+    log_init();      // Logging system
+    cmd_repo_init(); // Command repository initialization
+    dat_repo_init(); // Update status repository
+
+    /* Scenario start date, the virtual clock advances only when all tasks
+     * are blocked */
+    osSimSetTime(TEST_SIM_START);
+
+    /* Initializing shared Queues (dispatcher lanes are created by cmd_repo_init) */
+    executer_cmd_queue = osQueueCreate(SCH_CMD_EXE_WORKERS,sizeof(cmd_t *));
+    if(executer_cmd_queue == 0)
+        LOGE(tag, "Error creating executer cmd queue");
+
+    int n_threads = 5 + SCH_CMD_EXE_WORKERS;
+    os_thread threads_id[n_threads];
+    int i;
+
+    /* Hold the virtual clock until all the tasks are created */
+    osSimTaskAdd();
+
+    LOGI(tag, "Creating basic tasks...");
+    osCreateTask(taskDispatcher,"dispatcher", SCH_TASK_DIS_STACK, NULL, 3, &threads_id[0]);
+    for(i=0; i<SCH_CMD_EXE_WORKERS; i++)
+        osCreateTask(taskExecuter, "executer", SCH_TASK_EXE_STACK, NULL, 4, &threads_id[5+i]);
+
+    /* System tasks under test, both start timers and end */
+    osCreateTask(taskWatchdog, "watchdog", SCH_TASK_WDT_STACK, NULL, 2, &threads_id[1]);
+    osCreateTask(taskHousekeeping, "housekeeping", SCH_TASK_HKP_STACK, NULL, 2, &threads_id[2]);
+    /* Sleeps until the next flight plan entry */
+    osCreateTask(taskFlightPlan, "flightplan", SCH_TASK_FPL_STACK, NULL, 2, &threads_id[4]);
+
+    osCreateTask(taskTest, "test1", SCH_TASK_DEF_STACK, "TEST 1", 2, &threads_id[3]);
+    osSimTaskRemove();
+
+#ifndef ESP32
+    /* Start the scheduler. Should never return */
+    osScheduler(threads_id, n_threads);
+    return 0;
+#endif
+
+}
+
+#ifdef FREERTOS
+#ifndef NANOMIND
+/**
+ * Task idle handle function. Performs operations inside the idle task
+ * configUSE_IDLE_HOOK must be set to 1
+ */
+void vApplicationIdleHook(void)
+{
+    //Add hook code here
+}
+
+
+/**
+ * Task idle handle function. Performs operations inside the idle task
+ * configUSE_TICK_HOOK must be set to 1
+ */
+void vApplicationTickHook(void)
+{
+#ifdef AVR32
+    LED_Toggle(LED0);
+#endif
+}
+
+/**
+ * Stack overflow handle function.
+ * configCHECK_FOR_STACK_OVERFLOW must be set to 1 or 2
+ *
+ * @param pxTask Task handle
+ * @param pcTaskName Task name
+ */
+void vApplicationStackOverflowHook(xTaskHandle* pxTask, signed char* pcTaskName)
+{
+    printf("[ERROR][-1][%s] Stack overflow!", (char *)pcTaskName);
+
+    /* Stack overflow handle */
+    while(1);
+}
+#endif
+#endif
\ No newline at end of file
@@ -0,0 +1,76 @@
+#include "include/taskTest.h"
+
+const static char *tag = "taskTest";
+
+/**
+ * Mission scenario: the ground station clears the software watchdog once a
+ * day, for TEST_SIM_DAYS days of virtual time. The OBC must not reset (the
+ * ground watchdog expires after SCH_MAX_GND_WDT_TIMER) and the housekeeping
+ * must count the hours alive. The flight plan also clears the watchdog every
+ * hour, the flight plan task must sleep until each entry is due.
+ */
+void taskTest(void *param)
+{
+    char *tag = (char *)param;
+    LOGI(tag, "Started");
+
+    struct timespec real_start, real_end;
+    int hours_alive = dat_get_system_var(dat_obc_hrs_alive);
+    int day;
+
+    // Hourly flight plan entry, starting one minute after the scenario start
+    dat_set_fp(TEST_SIM_START + 60, "clear_gnd_wdt", "", 1, 3600);
+
+    clock_gettime(CLOCK_MONOTONIC, &real_start);
+    portTick xLastTime = osTaskGetTickCount();
+
+    for(day=0; day<TEST_SIM_DAYS; day++)
+    {
+        // One day, in 30 minutes steps (portTick wraps every ~71 minutes)
+        int step;
+        for(step=0; step<48; step++)
+            osTaskDelayUntil(&xLastTime, 1800*1000);
+
+        cmd_t *cmd = cmd_get_str("clear_gnd_wdt");
+        cmd_send(cmd);
+        LOGI(tag, "Day %d, virtual time %u, hours alive %d", day+1,
+             (unsigned int)osSimGetTime(),
+             dat_get_system_var(dat_obc_hrs_alive) - hours_alive);
+    }
+
+    // Let the last commands run
+    osDelay(1000);
+
+    clock_gettime(CLOCK_MONOTONIC, &real_end);
+    double real_sec = (real_end.tv_sec - real_start.tv_sec) + (real_end.tv_nsec - real_start.tv_nsec)/1e9;
+    int virtual_sec = (int)(osSimGetTime() - TEST_SIM_START);
+    hours_alive = dat_get_system_var(dat_obc_hrs_alive) - hours_alive;
+
+    LOGI(tag, "Test executed %d virtual seconds in %.2f s, hours alive %d, expected %d",
+         virtual_sec, real_sec, hours_alive, TEST_SIM_DAYS*24);
+    assert(virtual_sec == TEST_SIM_DAYS*24*3600 + 1);
+    assert(hours_alive == TEST_SIM_DAYS*24);
+
+    // This task only woke up from its delays, always on time
+    osTaskStats stats;
+    int i;
+    for(i=0; osTaskGetStats(i, &stats); i++)
+        if(strcmp(stats.name, "test1") == 0)
+            break;
+    LOGI(tag, "Task %s: %u wake ups, %u overruns, %u bytes of stack used", stats.name,
+         (unsigned int)stats.wakeups, (unsigned int)stats.overruns, (unsigned int)stats.stack_used);
+    assert(strcmp(stats.name, "test1") == 0);
+    assert(stats.wakeups == TEST_SIM_DAYS*48 + 1);
+    assert(stats.overruns == 0);
+
+    // The flight plan ran every hour, waking up only a few times per entry
+    int fpl_last = dat_get_system_var(dat_fpl_last);
+    for(i=0; osTaskGetStats(i, &stats); i++)
+        if(strcmp(stats.name, "flightplan") == 0)
+            break;
+    LOGI(tag, "Flight plan: last entry %d, %u wake ups", fpl_last - TEST_SIM_START,
+         (unsigned int)stats.wakeups);
+    assert(fpl_last == TEST_SIM_START + 60 + 3600*(TEST_SIM_DAYS*24 - 1));
+    assert(stats.wakeups <= TEST_SIM_DAYS*24*8);
+    exit(0);
+}
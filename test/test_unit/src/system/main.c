@@ -24,10 +24,12 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <pthread.h>
 #include "CUnit/Basic.h"
 #include "cmdFP.h"
 #include "cmdOBC.h"
 #include "repoCommand.h"
+#include "osEvent.h"
 
 /* The suite initialization function.
  * Resets the flight plan
@@ -35,8 +37,9 @@
  */
 int init_suite1(void)
 {
+    cmd_args_t args = {0};
     dat_repo_init();
-    fp_reset("", "", 1);
+    fp_reset("", "", 0, &args);
     return 0;
 }
 
@@ -70,9 +73,12 @@ int clean_suite2(void)
  */
 int init_suite3(void)
 {
+    char params[] = "1010";
+    cmd_args_t args;
     dat_repo_init();
     cmd_repo_init();
-    drp_execute_before_flight("%d", "1010", 1);
+    cmd_parse_args("%d", params, &args);
+    drp_execute_before_flight("%d", params, 1, &args);
     srand(time(NULL));
     return 0;
 }
@@ -97,7 +103,7 @@ void testParseCommands(void)
     name = cmd_get_name(cmd->id);
     CU_ASSERT_STRING_EQUAL("get_mem", name)
     CU_ASSERT_PTR_NULL(cmd->params);
-    free(cmd); free(name);
+    cmd_free(cmd); free(name);
 
     // Case 2: command with parameters; command do not req. parameters.
     cmd = cmd_parse_from_str("get_mem foo");
@@ -105,7 +111,7 @@ void testParseCommands(void)
     name = cmd_get_name(cmd->id);
     CU_ASSERT_STRING_EQUAL("get_mem", name)
     CU_ASSERT_STRING_EQUAL("foo", cmd->params);
-    free(cmd); free(name);
+    cmd_free(cmd); free(name);
 
     // Case 3: command with parameters; command require parameters.
     cmd = cmd_parse_from_str("debug_obc 1");
@@ -113,7 +119,7 @@ void testParseCommands(void)
     name = cmd_get_name(cmd->id);
     CU_ASSERT_STRING_EQUAL("debug_obc", name)
     CU_ASSERT_STRING_EQUAL("1", cmd->params);
-    free(cmd); free(name);
+    cmd_free(cmd); free(name);
 
     // Case 4: command without parameters; command require parameters.
     cmd = cmd_parse_from_str("debug_obc");
@@ -121,51 +127,264 @@ void testParseCommands(void)
     name = cmd_get_name(cmd->id);
     CU_ASSERT_STRING_EQUAL("debug_obc", name)
     CU_ASSERT_PTR_NULL(cmd->params);
-    free(cmd); free(name);
+    cmd_free(cmd); free(name);
 
     // Case 5: not valid command
     cmd = cmd_parse_from_str("invalid_command");
     CU_ASSERT_PTR_NULL(cmd);
-    free(cmd);
+    cmd_free(cmd);
 
     // Case 6: empty command
     cmd = cmd_parse_from_str("\0");
     CU_ASSERT_PTR_NULL(cmd);
-    free(cmd);
+    cmd_free(cmd);
 
     // Case 7: \n or \cr command
     cmd = cmd_parse_from_str("\r\n");
     CU_ASSERT_PTR_NULL(cmd);
-    free(cmd);
+    cmd_free(cmd);
+
+    // Case 8: unknown command, the NULL command is ignored
+    cmd = cmd_get_str("not_a_command");
+    CU_ASSERT_PTR_NULL(cmd);
+    cmd_add_params_str(cmd, "1 2");
+    CU_ASSERT_EQUAL(cmd_send_lane(cmd, CMD_LANE_FP), 0);
+}
+
+// Test of coalescible commands. The dispatcher is not running, so the commands
+// sent stay pending in the housekeeping lane.
+void testCoalesceCommands(void)
+{
+    cmd_send_stats_t before, after;
+    cmd_t *cmd;
+    int i, sent;
+
+    cmd_get_send_stats(&before);
+
+    // Case 1: fill the lane with different commands, all are sent
+    for(i=0; i<SCH_CMD_LANE_HK_DEPTH; i++)
+    {
+        cmd = cmd_get_str("debug_obc");
+        cmd_add_params_var(cmd, i);
+        cmd_set_coalesce(cmd, 1);
+        sent = cmd_send_lane(cmd, CMD_LANE_HK);
+        CU_ASSERT_EQUAL(sent, pdPASS);
+    }
+    cmd_get_send_stats(&after);
+    CU_ASSERT_EQUAL(after.coalesced, before.coalesced);
+    CU_ASSERT_EQUAL(after.dropped, before.dropped);
+
+    // Case 2: an identical command is merged with the pending one
+    cmd = cmd_get_str("debug_obc");
+    cmd_add_params_var(cmd, 0);
+    cmd_set_coalesce(cmd, 1);
+    sent = cmd_send_lane(cmd, CMD_LANE_HK);
+    CU_ASSERT_EQUAL(sent, pdPASS);
+    cmd_get_send_stats(&after);
+    CU_ASSERT_EQUAL(after.coalesced, before.coalesced + 1);
+
+    // Case 3: a different command is dropped because the lane is full
+    cmd = cmd_get_str("debug_obc");
+    cmd_add_params_var(cmd, 100);
+    cmd_set_coalesce(cmd, 1);
+    sent = cmd_send_lane(cmd, CMD_LANE_HK);
+    CU_ASSERT_EQUAL(sent, 0);
+    cmd_get_send_stats(&after);
+    CU_ASSERT_EQUAL(after.dropped, before.dropped + 1);
+
+    // Case 3b: a regular command sent without blocking is dropped too
+    cmd = cmd_get_str("update_hours_alive");
+    cmd_add_params_var(cmd, 1);
+    sent = cmd_try_send_lane(cmd, CMD_LANE_HK);
+    CU_ASSERT_EQUAL(sent, 0);
+    cmd_get_send_stats(&after);
+    CU_ASSERT_EQUAL(after.dropped, before.dropped + 2);
+
+    // Case 4: after the pending command starts, a new one is not merged
+    cmd = cmd_lane_receive(CMD_LANE_HK);
+    CU_ASSERT_PTR_NOT_NULL(cmd);
+    cmd_coalesce_remove(cmd);
+    cmd_free(cmd);
+    cmd = cmd_get_str("debug_obc");
+    cmd_add_params_var(cmd, 0);
+    cmd_set_coalesce(cmd, 1);
+    sent = cmd_send_lane(cmd, CMD_LANE_HK);
+    CU_ASSERT_EQUAL(sent, pdPASS);
+    cmd_get_send_stats(&after);
+    CU_ASSERT_EQUAL(after.coalesced, before.coalesced + 1);
+
+    // Clean the lane and the dispatcher notifications
+    while((cmd = cmd_lane_receive(CMD_LANE_HK)) != NULL)
+        cmd_free(cmd);
+    while(osQueueReceive(dispatcher_queue, &i, 0) == pdPASS);
+}
+
+// Sends items to a queue after a short delay, runs in another thread
+static void *queue_sender(void *queue)
+{
+    int values[3] = {7, 8, 9};
+    osDelay(20);
+    osQueueSendBatch((osQueue)queue, values, 3, 0);
+    return NULL;
+}
+
+// Test of the osQueue batch, size and peek functions
+void testQueueBatch(void)
+{
+    osQueue queue = osQueueCreate(4, sizeof(int));
+    int values[6] = {1, 2, 3, 4, 5, 6};
+    int buf[6] = {0};
+    int n, item;
+
+    // Case 1: an empty queue does not block with timeout 0
+    CU_ASSERT_EQUAL(osQueueSize(queue), 0);
+    CU_ASSERT_EQUAL(osQueueReceiveBatch(queue, buf, 6, 0), 0);
+    CU_ASSERT_NOT_EQUAL(osQueuePeek(queue, &item, 0), pdPASS);
+
+    // Case 2: only the items that fit are sent
+    n = osQueueSendBatch(queue, values, 6, 0);
+    CU_ASSERT_EQUAL(n, 4);
+    CU_ASSERT_EQUAL(osQueueSize(queue), 4);
+
+    // Case 3: peek does not remove the item
+    CU_ASSERT_EQUAL(osQueuePeek(queue, &item, 0), pdPASS);
+    CU_ASSERT_EQUAL(item, 1);
+    CU_ASSERT_EQUAL(osQueueSize(queue), 4);
+
+    // Case 4: receive up to n items, in order
+    n = osQueueReceiveBatch(queue, buf, 3, 0);
+    CU_ASSERT_EQUAL(n, 3);
+    CU_ASSERT_EQUAL(buf[0], 1);
+    CU_ASSERT_EQUAL(buf[2], 3);
+    CU_ASSERT_EQUAL(osQueueSize(queue), 1);
+
+    // Case 5: receive less items than requested, the queue wraps around
+    CU_ASSERT_EQUAL(osQueueSendBatch(queue, values+4, 2, 0), 2);
+    n = osQueueReceiveBatch(queue, buf, 6, 0);
+    CU_ASSERT_EQUAL(n, 3);
+    CU_ASSERT_EQUAL(buf[0], 4);
+    CU_ASSERT_EQUAL(buf[1], 5);
+    CU_ASSERT_EQUAL(buf[2], 6);
+    CU_ASSERT_EQUAL(osQueueSize(queue), 0);
+
+    // Case 6: a blocked receiver takes all the items sent meanwhile
+    pthread_t sender;
+    pthread_create(&sender, NULL, queue_sender, queue);
+    n = osQueueReceiveBatch(queue, buf, 6, 5000);
+    pthread_join(sender, NULL);
+    CU_ASSERT(n >= 1);
+    n += osQueueReceiveBatch(queue, buf+n, 6-n, 0);
+    CU_ASSERT_EQUAL(n, 3);
+    CU_ASSERT_EQUAL(buf[0], 7);
+    CU_ASSERT_EQUAL(buf[2], 9);
+}
+
+// Sets the event bits after a short delay, runs in another thread
+static void *event_setter(void *event)
+{
+    osDelay(20);
+    osEventSet((osEvent)event, 0x4);
+    return NULL;
+}
+
+// Test of the osEvent set, clear and wait functions
+void testEvent(void)
+{
+    osEvent event = osEventCreate();
+    pthread_t setter;
+    uint32_t bits;
+
+    CU_ASSERT_PTR_NOT_NULL_FATAL(event);
+
+    // Case 1: timeout 0 only tests the bits
+    CU_ASSERT_EQUAL(osEventWait(event, 0x1, 0, 1, 0), 0);
+
+    // Case 2: wait any, only the waited bits are cleared
+    CU_ASSERT_EQUAL(osEventSet(event, 0x3), 0x3);
+    bits = osEventWait(event, 0x1, 0, 1, 0);
+    CU_ASSERT_EQUAL(bits, 0x3);
+    CU_ASSERT_EQUAL(osEventGet(event), 0x2);
+
+    // Case 3: wait all times out if a bit is missing, nothing is cleared
+    bits = osEventWait(event, 0x6, 1, 1, 10);
+    CU_ASSERT_EQUAL(bits, 0x2);
+    CU_ASSERT_EQUAL(osEventGet(event), 0x2);
+
+    // Case 4: another task sets the missing bit
+    pthread_create(&setter, NULL, event_setter, event);
+    bits = osEventWait(event, 0x6, 1, 1, 5000);
+    pthread_join(setter, NULL);
+    CU_ASSERT_EQUAL(bits, 0x6);
+    CU_ASSERT_EQUAL(osEventGet(event), 0);
+
+    // Case 5: clear returns the previous bits
+    osEventSet(event, 0x9);
+    CU_ASSERT_EQUAL(osEventClear(event, 0x1), 0x9);
+    CU_ASSERT_EQUAL(osEventGet(event), 0x8);
 }
 
 // Test of fp_set.
 void testFPSET(void)
 {
     char* fmt = "%d %d %d %d %d %d %s %s %d %d";
-    char* params = "26 01 2018 12 35 00 helloworld 1,2,3,3,4 1 0";
+    char params[] = "26 01 2018 12 35 00 helloworld 1,2,3,3,4 1 0";
     int nparams = 10;
     int result;
-    result = fp_set(fmt, params, nparams);
+    cmd_args_t args;
+    cmd_parse_args(fmt, params, &args);
+    result = fp_set(fmt, params, nparams, &args);
     CU_ASSERT(CMD_OK == result);
+
+    // Args that do not fit the flight plan buffers are rejected
+    char long_args[SCH_CMD_MAX_STR_PARAMS+1];
+    memset(long_args, '1', SCH_CMD_MAX_STR_PARAMS);
+    long_args[SCH_CMD_MAX_STR_PARAMS] = '\0';
+    CU_ASSERT_NOT_EQUAL(dat_set_fp(1000, "helloworld", long_args, 1, 0), 0);
+    long_args[SCH_CMD_MAX_STR_PARAMS-1] = '\0';
+    CU_ASSERT_EQUAL(dat_set_fp(1000, "helloworld", long_args, 1, 0), 0);
+    CU_ASSERT_EQUAL(dat_del_fp(1000), 0);
 }
 
 //Test of fp_delete
 void testFPDELETE(void)
 {
     char* fmt = "%d %d %d %d %d %d";
-    char* params = "26 01 2018 12 35 00";
+    char params[] = "26 01 2018 12 35 00";
     int nparams = 6;
     int result;
-    result = fp_delete(fmt, params, nparams);
+    cmd_args_t args;
+    cmd_parse_args(fmt, params, &args);
+    result = fp_delete(fmt, params, nparams, &args);
     CU_ASSERT_EQUAL(CMD_OK, result);
 }
 
+//Test of dat_get_fp_next, the flight plan is empty
+void testFPNEXT(void)
+{
+    CU_ASSERT_EQUAL(dat_get_fp_next(0), -1);
+
+    dat_set_fp(2000, "test", "b", 1, 0);
+    dat_set_fp(1000, "test", "a", 1, 0);
+    CU_ASSERT_EQUAL(dat_get_fp_next(0), 1000);
+    CU_ASSERT_EQUAL(dat_get_fp_next(1000), 1000);
+    CU_ASSERT_EQUAL(dat_get_fp_next(1001), 2000);
+    CU_ASSERT_EQUAL(dat_get_fp_next(2001), -1);
+
+    // Changes are notified to the flight plan task
+    CU_ASSERT_EQUAL(dat_wait_events(DAT_EVENT_FP, 0), DAT_EVENT_FP);
+    CU_ASSERT_EQUAL(dat_wait_events(DAT_EVENT_FP, 0), 0);
+
+    dat_del_fp(1000);
+    dat_del_fp(2000);
+    CU_ASSERT_EQUAL(dat_get_fp_next(0), -1);
+}
+
 //Test of drp_test_system_vars
 void testSYSVARS(void)
 {
     int result;
-    result = drp_test_system_vars("", "", 0);
+    cmd_args_t args = {0};
+    result = drp_test_system_vars("", "", 0, &args);
     CU_ASSERT(CMD_OK == result);
 }
 
@@ -190,6 +409,14 @@ void testDATSET_SYSVAR(void)
 
     for (int i = dat_obc_opmode; i < dat_system_last_var; i++)
     {
+#if SCH_STORAGE_MODE == 1 && SCH_STORAGE_CACHE == 1
+        // Volatile variables are not written to the storage
+        if (dat_get_system_var_tier(i) == DAT_TIER_VOLATILE)
+        {
+            CU_ASSERT_EQUAL(dat_get_system_var(i), i == rand_ind ? rand_val : i + 5);
+            continue;
+        }
+#endif
         val_1 = _dat_get_system_var(i);
         val_2 = _dat_get_system_var(i + dat_system_last_var);
         val_3 = _dat_get_system_var(i + dat_system_last_var * 2);
@@ -248,6 +475,142 @@ void testDATGET_SYSVAR(void)
 }
 
 
+//Test of dat_flush, repeated writes are committed once
+void testDATFLUSH(void)
+{
+    dat_flush_stats_t stats;
+    int i;
+
+    dat_flush();
+    dat_get_flush_stats(&stats, 1);
+    for (i = 0; i < 10; i++)
+        dat_set_system_var(dat_com_count_tm, i);
+    CU_ASSERT_EQUAL(dat_flush(), 0);
+    dat_get_flush_stats(&stats, 1);
+
+    CU_ASSERT_EQUAL(stats.writes, 10);
+    CU_ASSERT(stats.rows <= stats.writes * 3);
+    // The stored copies have the last value
+    CU_ASSERT_EQUAL(_dat_get_system_var(dat_com_count_tm), 9);
+    CU_ASSERT_EQUAL(dat_get_system_var(dat_com_count_tm), 9);
+
+#if SCH_STORAGE_MODE == 1 && SCH_STORAGE_CACHE == 1 && SCH_STORAGE_FLUSH_MS > 0
+    // The flush timer does not wait while the repository is in use
+    dat_set_system_var(dat_com_count_tm, 10);
+    osSemaphoreTake(&repo_data_sem, portMAX_DELAY);
+    osDelay(SCH_STORAGE_FLUSH_MS + SCH_STORAGE_FLUSH_MS/2);
+    osSemaphoreGiven(&repo_data_sem);
+    dat_get_flush_stats(&stats, 1);
+    CU_ASSERT(stats.busy >= 1);
+    CU_ASSERT_EQUAL(dat_flush(), 0);
+    CU_ASSERT_EQUAL(_dat_get_system_var(dat_com_count_tm), 10);
+#endif
+}
+
+
+//Test of the persistence tiers, only with the storage cache
+void testDATTIER(void)
+{
+    dat_flush_stats_t stats;
+
+    CU_ASSERT_EQUAL(dat_get_system_var_tier(dat_obc_reset_counter), DAT_TIER_DURABLE);
+    CU_ASSERT_EQUAL(dat_get_system_var_tier(dat_obc_sw_wdt), DAT_TIER_VOLATILE);
+    CU_ASSERT_EQUAL(dat_get_system_var_tier(dat_com_count_tm), DAT_TIER_CHECKPOINT);
+
+#if SCH_STORAGE_MODE == 1 && SCH_STORAGE_CACHE == 1
+    dat_flush();
+    dat_get_flush_stats(&stats, 1);
+
+    // Volatile variables are not written to the storage
+    dat_set_system_var(dat_com_count_tc, 5);
+    dat_flush();
+    dat_get_flush_stats(&stats, 1);
+    CU_ASSERT_EQUAL(stats.skipped, 1);
+    CU_ASSERT_EQUAL(stats.rows, 0);
+    CU_ASSERT_EQUAL(dat_get_system_var(dat_com_count_tc), 5);
+
+    // Durable variables are committed and synced at once
+    dat_set_system_var(dat_dep_ant_deployed, 1);
+    dat_get_flush_stats(&stats, 1);
+    CU_ASSERT_EQUAL(stats.commits, 1);
+    CU_ASSERT_EQUAL(stats.synced, 1);
+    CU_ASSERT_EQUAL(_dat_get_system_var(dat_dep_ant_deployed), 1);
+#elif SCH_STORAGE_MODE == 1
+    dat_get_flush_stats(&stats, 1);
+
+    // Without the cache every write is committed, only durable ones synced
+    dat_set_system_var(dat_com_count_tm, 5);
+    dat_get_flush_stats(&stats, 1);
+    CU_ASSERT_EQUAL(stats.commits, 1);
+    CU_ASSERT_EQUAL(stats.synced, 0);
+
+    dat_set_system_var(dat_dep_ant_deployed, 1);
+    dat_get_flush_stats(&stats, 1);
+    CU_ASSERT_EQUAL(stats.commits, 1);
+    CU_ASSERT_EQUAL(stats.synced, 1);
+    CU_ASSERT_EQUAL(dat_get_system_var(dat_dep_ant_deployed), 1);
+#endif
+}
+
+//Test of dat_get_system_vars and dat_status_to_struct
+void testDATSNAPSHOT(void)
+{
+    int values[dat_system_last_var];
+    dat_status_t status;
+    fvalue_t temp;
+    int i;
+
+    temp.f = 21.3f;
+    for (i = 0; i < dat_system_last_var; i++)
+        dat_set_system_var(i, i == dat_obc_temp_1 ? temp.i : i + 7);
+
+    dat_get_system_vars(values);
+    for (i = 0; i < dat_system_last_var; i++)
+        CU_ASSERT_EQUAL(values[i], dat_get_system_var(i));
+
+    dat_status_to_struct(&status);
+    CU_ASSERT_EQUAL(status.dat_obc_opmode, dat_obc_opmode + 7);
+    CU_ASSERT_EQUAL(status.dat_com_count_tm, dat_com_count_tm + 7);
+    CU_ASSERT_EQUAL(status.dat_mem_ads, dat_mem_ads + 7);
+    CU_ASSERT_EQUAL(status.dat_obc_temp_1, temp.f);
+}
+
+#define TEST_ADD_THREADS 4
+#define TEST_ADD_LOOPS 200
+
+static void *test_add_task(void *param)
+{
+    int i;
+    for (i = 0; i < TEST_ADD_LOOPS; i++)
+        dat_add_system_var(dat_com_count_tc, 1);
+    return NULL;
+}
+
+//Test of dat_add_system_var and dat_cas_system_var
+void testDATADD_CAS(void)
+{
+    pthread_t threads[TEST_ADD_THREADS];
+    int i;
+
+    dat_set_system_var(dat_com_count_tc, 10);
+    CU_ASSERT_EQUAL(dat_add_system_var(dat_com_count_tc, 5), 15);
+    CU_ASSERT_EQUAL(dat_add_system_var(dat_com_count_tc, -3), 12);
+    CU_ASSERT_EQUAL(dat_get_system_var(dat_com_count_tc), 12);
+
+    // Only set if the current value is the expected one
+    CU_ASSERT_EQUAL(dat_cas_system_var(dat_com_count_tc, 11, 0), 0);
+    CU_ASSERT_EQUAL(dat_get_system_var(dat_com_count_tc), 12);
+    CU_ASSERT_EQUAL(dat_cas_system_var(dat_com_count_tc, 12, 0), 1);
+    CU_ASSERT_EQUAL(dat_get_system_var(dat_com_count_tc), 0);
+
+    // Concurrent increments are not lost
+    for (i = 0; i < TEST_ADD_THREADS; i++)
+        pthread_create(&threads[i], NULL, test_add_task, NULL);
+    for (i = 0; i < TEST_ADD_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    CU_ASSERT_EQUAL(dat_get_system_var(dat_com_count_tc), TEST_ADD_THREADS * TEST_ADD_LOOPS);
+}
+
 /* The main() function for setting up and running the tests.
  * Returns a CUE_SUCCESS on successful running, another
  * CUnit error code on failure.
@@ -271,7 +634,8 @@ int main()
 
     /* add the tests to the suite */
     if ((NULL == CU_add_test(pSuite, "test of fpset()", testFPSET))
-           || (NULL == CU_add_test(pSuite, "test of fpdelete()", testFPDELETE))){
+           || (NULL == CU_add_test(pSuite, "test of fpdelete()", testFPDELETE))
+           || (NULL == CU_add_test(pSuite, "test of dat_get_fp_next()", testFPNEXT))){
         CU_cleanup_registry();
         return CU_get_error();
     }
@@ -286,7 +650,10 @@ int main()
     }
 
     /* add the tests to the suite */
-    if ((NULL == CU_add_test(pSuite, "test of cmd_parse_from_str()", testParseCommands))){
+    if ((NULL == CU_add_test(pSuite, "test of cmd_parse_from_str()", testParseCommands)) ||
+            (NULL == CU_add_test(pSuite, "test of cmd_set_coalesce()", testCoalesceCommands)) ||
+            (NULL == CU_add_test(pSuite, "test of osQueueReceiveBatch()", testQueueBatch)) ||
+            (NULL == CU_add_test(pSuite, "test of osEventWait()", testEvent))){
         CU_cleanup_registry();
         return CU_get_error();
     }
@@ -303,7 +670,11 @@ int main()
     /* add the tests to the suite */
     if ((NULL == CU_add_test(pSuite, "test of drp_test_system_vars", testSYSVARS)) ||
             (NULL == CU_add_test(pSuite, "test of dat_set_system_var", testDATSET_SYSVAR)) ||
-            (NULL == CU_add_test(pSuite, "test of dat_get_system_var", testDATGET_SYSVAR))){
+            (NULL == CU_add_test(pSuite, "test of dat_get_system_var", testDATGET_SYSVAR)) ||
+            (NULL == CU_add_test(pSuite, "test of dat_flush", testDATFLUSH)) ||
+            (NULL == CU_add_test(pSuite, "test of dat_get_system_var_tier", testDATTIER)) ||
+            (NULL == CU_add_test(pSuite, "test of dat_get_system_vars", testDATSNAPSHOT)) ||
+            (NULL == CU_add_test(pSuite, "test of dat_add_system_var", testDATADD_CAS))){
         CU_cleanup_registry();
         return CU_get_error();
     }